@@ -3,12 +3,23 @@
 
 #include "AssetActions/QuickAssetAction.h"
 
-#include "AssetToolsModule.h"
 #include "DebugHeader.h"
 #include "EditorUtilityLibrary.h"
 #include "EditorAssetLibrary.h"
 #include "ObjectTools.h"
+#include "SuperManager.h"
 #include "AssetRegistry/AssetRegistryModule.h"
+#include "References/StringReferenceScanner.h"
+#include "Settings/SuperManagerSettings.h"
+
+namespace QuickAssetAction
+{
+	FSuperManagerTaskScheduler& GetTaskScheduler()
+	{
+		const FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+		return *SuperManagerModule.GetTaskScheduler();
+	}
+}
 
 void UQuickAssetAction::DuplicateAssets(int32 NumOfDuplicates)
 {
@@ -19,7 +30,11 @@ void UQuickAssetAction::DuplicateAssets(int32 NumOfDuplicates)
 	}
 
 	TArray<FAssetData> SelectedAssetDataArray = UEditorUtilityLibrary::GetSelectedAssetData();
-	uint32 Counter = 0;
+
+	// 每次复制+保存作为一个游戏线程阶段，选中大量资产时编辑器不会卡住
+	FSuperManagerTaskScheduler& TaskScheduler = QuickAssetAction::GetTaskScheduler();
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	const TSharedRef<uint32> Counter = MakeShared<uint32>(0);
 
 	for (const FAssetData& SelectedAssetData : SelectedAssetDataArray)
 	{
@@ -29,24 +44,36 @@ void UQuickAssetAction::DuplicateAssets(int32 NumOfDuplicates)
 			const FString NewDuplicatedAssetName = SelectedAssetData.AssetName.ToString() + "_" + FString::FromInt(i + 1);
 			const FString NewPathName = FPaths::Combine(SelectedAssetData.PackagePath.ToString(), NewDuplicatedAssetName);
 
-			if (UEditorAssetLibrary::DuplicateAsset(SourceAssetPath, NewPathName))
+			TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.DuplicateAsset"), [SourceAssetPath, NewPathName, Counter]()
 			{
-				UEditorAssetLibrary::SaveAsset(NewPathName, false);
-				++Counter;
-			}
+				if (UEditorAssetLibrary::DuplicateAsset(SourceAssetPath, NewPathName))
+				{
+					UEditorAssetLibrary::SaveAsset(NewPathName, false);
+					++*Counter;
+				}
+				return true;
+			}, Token);
 		}
 	}
 
-	if (Counter > 0)
+	TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.DuplicateAssetsDone"), [Counter]()
 	{
-		DebugHeader::ShowNotifyInfo("Successfully duplicated " + FString::FromInt(Counter) + " files");
-	}
+		if (*Counter > 0)
+		{
+			DebugHeader::ShowNotifyInfo("Successfully duplicated " + FString::FromInt(*Counter) + " files");
+		}
+		return true;
+	}, Token);
 }
 
 void UQuickAssetAction::AddPrefixes()
 {
 	TArray<UObject*> SelectedObjectArray = UEditorUtilityLibrary::GetSelectedAssets();
-	uint32 Counter = 0;
+
+	// 新名字在这里算好，重命名逐个作为游戏线程阶段执行
+	FSuperManagerTaskScheduler& TaskScheduler = QuickAssetAction::GetTaskScheduler();
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	const TSharedRef<uint32> Counter = MakeShared<uint32>(0);
 
 	for (UObject* SelectedObject : SelectedObjectArray)
 	{
@@ -55,7 +82,7 @@ void UQuickAssetAction::AddPrefixes()
 			continue;
 		}
 
-		FString* Prefix = PrefixMap.Find(SelectedObject->GetClass());
+		const FString* Prefix = FindPrefixForClass(SelectedObject->GetClass());
 		if (!Prefix || Prefix->IsEmpty())
 		{
 			DebugHeader::Print(TEXT("查找class的前缀失败:") + SelectedObject->GetClass()->GetName());
@@ -74,70 +101,80 @@ void UQuickAssetAction::AddPrefixes()
 		}
 		FString NewName = *Prefix + OldName;
 
-		UEditorUtilityLibrary::RenameAsset(SelectedObject, NewName);
-		++Counter;
-	}
-	if (Counter > 0)
-	{
-		DebugHeader::ShowNotifyInfo(TEXT("成功修改 " + FString::FromInt(Counter) + TEXT(" 个文件前缀名")));
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.AddPrefix"),
+			[WeakObject = TWeakObjectPtr<UObject>(SelectedObject), NewName, Counter]()
+			{
+				if (UObject* ObjectToRename = WeakObject.Get())
+				{
+					UEditorUtilityLibrary::RenameAsset(ObjectToRename, NewName);
+					++*Counter;
+				}
+				return true;
+			}, Token);
 	}
-}
-
-void UQuickAssetAction::RemoveUnusedAssets()
-{
-	TArray<FAssetData> SelectedAssetDataArray = UEditorUtilityLibrary::GetSelectedAssetData();
-	TArray<FAssetData> UnusedAssetsDataArray;
 
-	FixUpRedirectors();
-	
-	for (FAssetData SelectedAssetData : SelectedAssetDataArray)
+	TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.AddPrefixesDone"), [Counter]()
 	{
-		TArray<FString> AssetReferencerArray =
-			UEditorAssetLibrary::FindPackageReferencersForAsset(SelectedAssetData.GetObjectPathString());
-
-		if (AssetReferencerArray.Num() == 0)
+		if (*Counter > 0)
 		{
-			UnusedAssetsDataArray.Add(SelectedAssetData);
+			DebugHeader::ShowNotifyInfo(TEXT("成功修改 " + FString::FromInt(*Counter) + TEXT(" 个文件前缀名")));
 		}
-	}
-	if (UnusedAssetsDataArray.Num() == 0)
-	{
-		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("在选中的资产中，没有无引用的资产"), true);
-		return;
-	}
-
-	int32 NumOfAssetsDeleted = ObjectTools::DeleteAssets(UnusedAssetsDataArray);
-	if (NumOfAssetsDeleted > 0)
-	{
-		DebugHeader::ShowNotifyInfo(TEXT("成功删除 ") + FString::FromInt(NumOfAssetsDeleted) + TEXT(" 个未被引用的资产"));
-	}
+		return true;
+	}, Token);
 }
 
-void UQuickAssetAction::FixUpRedirectors()
+void UQuickAssetAction::RemoveUnusedAssets()
 {
-	TArray<UObjectRedirector*> RedirectorToFixArray;
-
-	FAssetRegistryModule& AssetRegistryModule =
-		FModuleManager::Get().LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
-
-	FARFilter Filter;
-	Filter.bRecursivePaths = true;
-	Filter.PackagePaths.Emplace("/Game");
-	Filter.ClassPaths.Emplace("ObjectRedirector");
+	TArray<FAssetData> SelectedAssetDataArray = UEditorUtilityLibrary::GetSelectedAssetData();
 
-	TArray<FAssetData> OutRedirectorArray;
-	AssetRegistryModule.Get().GetAssets(Filter, OutRedirectorArray);
+	// 修复重定向器(按帧切片) -> 工作线程查引用 -> 游戏线程删除
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	FSuperManagerTaskScheduler& TaskScheduler = *SuperManagerModule.GetTaskScheduler();
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	// 工作线程不能初始化子系统，在这里先取好字符串引用扫描器
+	const TSharedRef<FSuperManagerStringReferenceScanner> StringReferenceScanner = SuperManagerModule.GetStringReferenceScanner().ToSharedRef();
 
-	for (const FAssetData& RedirectorData : OutRedirectorArray)
+	SuperManagerModule.EnqueueFixUpRedirectors(Token, [&TaskScheduler, SelectedAssetDataArray, StringReferenceScanner, Token]()
 	{
-		if (UObjectRedirector* RedirectorToFix = Cast<UObjectRedirector>(RedirectorData.GetAsset()))
-		{
-			RedirectorToFixArray.Add(RedirectorToFix);
-		}
-	}
-
-	FAssetToolsModule& AssetToolsModule =
-		FModuleManager::LoadModuleChecked<FAssetToolsModule>(TEXT("AssetTools"));
-
-	AssetToolsModule.Get().FixupReferencers(RedirectorToFixArray);
+		TaskScheduler.LaunchWorker(TEXT("SuperManager.FindUnusedSelectedAssets"),
+			[&TaskScheduler, SelectedAssetDataArray, StringReferenceScanner, Token](const FSuperManagerCancellationToken&)
+			{
+				const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+				TArray<FAssetData> UnusedAssetsDataArray;
+				for (const FAssetData& SelectedAssetData : SelectedAssetDataArray)
+				{
+					TArray<FName> AssetReferencerArray;
+					AssetRegistry.GetReferencers(SelectedAssetData.PackageName, AssetReferencerArray);
+
+					// 只被配置或代码里写死的路径引用的资产同样不能删
+					if (AssetReferencerArray.Num() == 0 && !StringReferenceScanner->IsReferenced(SelectedAssetData.PackageName))
+					{
+						UnusedAssetsDataArray.Add(SelectedAssetData);
+					}
+				}
+
+				TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.RemoveUnusedAssets"), [UnusedAssetsDataArray]()
+				{
+					if (UnusedAssetsDataArray.Num() == 0)
+					{
+						DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("在选中的资产中，没有无引用的资产"), true);
+						return true;
+					}
+
+					// 开启隔离区时移入隔离区，完成后由模块提示
+					if (USuperManagerSettings::Get()->bDeleteToQuarantine)
+					{
+						FModuleManager::GetModuleChecked<FSuperManagerModule>(TEXT("SuperManager")).DeleteMultipleAssetForAssetList(UnusedAssetsDataArray);
+						return true;
+					}
+
+					int32 NumOfAssetsDeleted = ObjectTools::DeleteAssets(UnusedAssetsDataArray);
+					if (NumOfAssetsDeleted > 0)
+					{
+						DebugHeader::ShowNotifyInfo(TEXT("成功删除 ") + FString::FromInt(NumOfAssetsDeleted) + TEXT(" 个未被引用的资产"));
+					}
+					return true;
+				}, Token, ESuperManagerTaskPriority::High);
+			}, Token, ESuperManagerTaskPriority::High);
+	});
 }
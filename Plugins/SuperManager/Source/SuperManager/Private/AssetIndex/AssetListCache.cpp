@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AssetIndex/AssetListCache.h"
+
+#include "AssetIndex/FolderTrie.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Settings/SuperManagerSettings.h"
+
+namespace SuperManagerAssetListCache
+{
+	const TCHAR* ConditionNames[] = {
+		TEXT("All"), TEXT("Unused"), TEXT("SameName"), TEXT("SimilarTextures"), TEXT("DuplicateMeshes"),
+		TEXT("DuplicateMaterialInstances"), TEXT("TextureBudget")
+	};
+	static_assert(UE_ARRAY_COUNT(ConditionNames) == static_cast<int32>(ESuperManagerListCondition::TextureBudget) + 1);
+}
+
+const TCHAR* LexToString(ESuperManagerListCondition Condition)
+{
+	return SuperManagerAssetListCache::ConditionNames[static_cast<int32>(Condition)];
+}
+
+bool LexTryParseString(ESuperManagerListCondition& OutCondition, const TCHAR* Buffer)
+{
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(SuperManagerAssetListCache::ConditionNames); ++Index)
+	{
+		if (FCString::Stricmp(Buffer, SuperManagerAssetListCache::ConditionNames[Index]) == 0)
+		{
+			OutCondition = static_cast<ESuperManagerListCondition>(Index);
+			return true;
+		}
+	}
+	return false;
+}
+
+void FSuperManagerAssetListCache::Initialize()
+{
+	IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	AssetAddedHandle = AssetRegistry.OnAssetAdded().AddSP(this, &FSuperManagerAssetListCache::OnAssetAdded);
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddSP(this, &FSuperManagerAssetListCache::OnAssetRemoved);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddSP(this, &FSuperManagerAssetListCache::OnAssetRenamed);
+	AssetUpdatedHandle = AssetRegistry.OnAssetUpdated().AddSP(this, &FSuperManagerAssetListCache::OnAssetUpdated);
+
+	// 排除规则变化后所有结果都可能不同
+	SettingsChangedHandle = GetMutableDefault<USuperManagerSettings>()->OnSettingChanged().AddSP(
+		this, &FSuperManagerAssetListCache::OnSettingsChanged);
+}
+
+void FSuperManagerAssetListCache::Shutdown()
+{
+	if (FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.OnAssetAdded().Remove(AssetAddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(AssetRenamedHandle);
+		AssetRegistry.OnAssetUpdated().Remove(AssetUpdatedHandle);
+	}
+	if (UObjectInitialized())
+	{
+		GetMutableDefault<USuperManagerSettings>()->OnSettingChanged().Remove(SettingsChangedHandle);
+	}
+	InvalidateAll();
+}
+
+TSharedPtr<const FSuperManagerAssetList> FSuperManagerAssetListCache::Find(const TArray<FString>& Roots, ESuperManagerListCondition Condition) const
+{
+	FScopeLock ScopeLock(&EntriesCS);
+	const FEntry* Entry = Entries.Find(MakeKey(Roots, Condition));
+	return Entry ? Entry->Result : nullptr;
+}
+
+void FSuperManagerAssetListCache::Add(const TArray<FString>& Roots, ESuperManagerListCondition Condition, const TSharedRef<const FSuperManagerAssetList>& Result)
+{
+	FEntry Entry;
+	Entry.Roots = Roots;
+	Entry.Condition = Condition;
+	Entry.Result = Result;
+
+	FScopeLock ScopeLock(&EntriesCS);
+	Entries.Add(MakeKey(Roots, Condition), MoveTemp(Entry));
+}
+
+void FSuperManagerAssetListCache::InvalidateAll()
+{
+	++Generation;
+	FScopeLock ScopeLock(&EntriesCS);
+	Entries.Empty();
+}
+
+void FSuperManagerAssetListCache::InvalidateCondition(ESuperManagerListCondition Condition)
+{
+	++Generation;
+	FScopeLock ScopeLock(&EntriesCS);
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Condition == Condition)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FString FSuperManagerAssetListCache::MakeKey(const TArray<FString>& Roots, ESuperManagerListCondition Condition)
+{
+	// 同一组根目录不论选择顺序都命中同一个条目
+	TArray<FString> SortedRoots = Roots;
+	SortedRoots.Sort();
+	return FString::Printf(TEXT("%d|%s"), static_cast<int32>(Condition), *FString::Join(SortedRoots, TEXT("|")));
+}
+
+void FSuperManagerAssetListCache::InvalidatePackages(TConstArrayView<FName> PackageNames, TConstArrayView<FName> Dependencies)
+{
+	auto IsUnderAnyRoot = [](const FEntry& Entry, FName PackageName)
+	{
+		TStringBuilder<256> PackageNameString;
+		PackageName.AppendString(PackageNameString);
+		for (const FString& Root : Entry.Roots)
+		{
+			if (FSuperManagerFolderTrie::IsPathUnderRoot(PackageNameString.ToView(), Root))
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	++Generation;
+	FScopeLock ScopeLock(&EntriesCS);
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		const FEntry& Entry = It.Value();
+
+		bool bAffected = false;
+		for (const FName PackageName : PackageNames)
+		{
+			// 根目录内的资产本身变化，所有条件都要重算
+			// 根目录外的包如果曾引用过根目录内的资产，它的变化会影响未使用的判定
+			if (IsUnderAnyRoot(Entry, PackageName) ||
+				(Entry.Condition == ESuperManagerListCondition::Unused && Entry.Result->ReferencerPackages.Contains(PackageName)))
+			{
+				bAffected = true;
+				break;
+			}
+		}
+		// 包新增了对根目录内资产的引用，原本未使用的资产可能变为被使用
+		if (!bAffected && Entry.Condition == ESuperManagerListCondition::Unused)
+		{
+			for (const FName Dependency : Dependencies)
+			{
+				if (IsUnderAnyRoot(Entry, Dependency))
+				{
+					bAffected = true;
+					break;
+				}
+			}
+		}
+
+		if (bAffected)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FSuperManagerAssetListCache::OnAssetAdded(const FAssetData& AssetData)
+{
+	TArray<FName> Dependencies;
+	IAssetRegistry::GetChecked().GetDependencies(AssetData.PackageName, Dependencies);
+	InvalidatePackages(MakeArrayView(&AssetData.PackageName, 1), Dependencies);
+}
+
+void FSuperManagerAssetListCache::OnAssetRemoved(const FAssetData& AssetData)
+{
+	InvalidatePackages(MakeArrayView(&AssetData.PackageName, 1), TConstArrayView<FName>());
+}
+
+void FSuperManagerAssetListCache::OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	TArray<FName> Dependencies;
+	IAssetRegistry::GetChecked().GetDependencies(AssetData.PackageName, Dependencies);
+
+	const FName ChangedPackages[] = {AssetData.PackageName, FName(FPackageName::ObjectPathToPackageName(OldObjectPath))};
+	InvalidatePackages(ChangedPackages, Dependencies);
+}
+
+void FSuperManagerAssetListCache::OnAssetUpdated(const FAssetData& AssetData)
+{
+	TArray<FName> Dependencies;
+	IAssetRegistry::GetChecked().GetDependencies(AssetData.PackageName, Dependencies);
+	InvalidatePackages(MakeArrayView(&AssetData.PackageName, 1), Dependencies);
+}
+
+void FSuperManagerAssetListCache::OnSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	InvalidateAll();
+}
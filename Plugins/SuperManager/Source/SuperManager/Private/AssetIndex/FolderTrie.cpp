@@ -0,0 +1,359 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AssetIndex/FolderTrie.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/ARFilter.h"
+#include "Settings/SuperManagerSettings.h"
+
+namespace SuperManagerFolderTrie
+{
+	// 按 '/' 拆分路径，跳过空段，Func 返回false时中止
+	template <typename FuncType>
+	bool ForEachSegment(FStringView Path, FuncType&& Func)
+	{
+		int32 Start = 0;
+		while (Start < Path.Len())
+		{
+			int32 End = Start;
+			while (End < Path.Len() && Path[End] != TEXT('/'))
+			{
+				++End;
+			}
+			if (End > Start && !Func(Path.Mid(Start, End - Start)))
+			{
+				return false;
+			}
+			Start = End + 1;
+		}
+		return true;
+	}
+}
+
+FSuperManagerFolderTrie::FSuperManagerFolderTrie()
+{
+	Nodes.AddDefaulted();
+}
+
+void FSuperManagerFolderTrie::Initialize()
+{
+	IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	TArray<FString> CachedPaths;
+	AssetRegistry.GetAllCachedPaths(CachedPaths);
+	{
+		FWriteScopeLock WriteLock(Lock);
+		for (const FString& CachedPath : CachedPaths)
+		{
+			Nodes[FindOrAddNode(CachedPath)].bExists = true;
+		}
+	}
+	RebuildRules();
+
+	// 注册表启动时还在扫描，后续发现的目录会通过事件补进来
+	PathAddedHandle = AssetRegistry.OnPathAdded().AddSP(this, &FSuperManagerFolderTrie::OnPathAdded);
+	PathRemovedHandle = AssetRegistry.OnPathRemoved().AddSP(this, &FSuperManagerFolderTrie::OnPathRemoved);
+	SettingsChangedHandle = GetMutableDefault<USuperManagerSettings>()->OnSettingChanged().AddSP(
+		this, &FSuperManagerFolderTrie::OnSettingsChanged);
+}
+
+void FSuperManagerFolderTrie::Shutdown()
+{
+	if (FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.OnPathAdded().Remove(PathAddedHandle);
+		AssetRegistry.OnPathRemoved().Remove(PathRemovedHandle);
+	}
+	if (UObjectInitialized())
+	{
+		GetMutableDefault<USuperManagerSettings>()->OnSettingChanged().Remove(SettingsChangedHandle);
+	}
+}
+
+void FSuperManagerFolderTrie::RebuildRules()
+{
+	const USuperManagerSettings* Settings = USuperManagerSettings::Get();
+
+	FWriteScopeLock WriteLock(Lock);
+	for (FNode& Node : Nodes)
+	{
+		Node.Rule = ERule::None;
+	}
+	// 清掉只为旧规则存在的占位节点
+	PruneNode(0);
+
+	for (const FString& ExcludedFolder : Settings->ExcludedFolders)
+	{
+		Nodes[FindOrAddNode(ExcludedFolder)].Rule = ERule::Exclude;
+	}
+	NumIncludeRules = 0;
+	for (const FString& IncludedFolder : Settings->IncludedFolders)
+	{
+		Nodes[FindOrAddNode(IncludedFolder)].Rule = ERule::Include;
+		++NumIncludeRules;
+	}
+	// 隔离区里的资产已经算删除，不再列为未使用；关闭隔离模式后已有的批次仍在这里
+	if (!Settings->QuarantineRoot.IsEmpty())
+	{
+		Nodes[FindOrAddNode(Settings->QuarantineRoot)].Rule = ERule::Exclude;
+	}
+}
+
+bool FSuperManagerFolderTrie::ContainsPath(FStringView Path) const
+{
+	FReadScopeLock ReadLock(Lock);
+	const int32 NodeIndex = FindNode(Path);
+	return NodeIndex != INDEX_NONE && Nodes[NodeIndex].bExists;
+}
+
+bool FSuperManagerFolderTrie::IsPathExcluded(FStringView Path) const
+{
+	FReadScopeLock ReadLock(Lock);
+
+	// 沿路径向下走，最深的一条规则生效；树中不存在的后续路径段继承最后一个已知节点的规则
+	ERule EffectiveRule = ERule::None;
+	int32 Current = 0;
+	SuperManagerFolderTrie::ForEachSegment(Path, [this, &Current, &EffectiveRule](FStringView Segment)
+	{
+		const FName SegmentName(Segment.Len(), Segment.GetData(), FNAME_Find);
+		const int32* Child = SegmentName.IsNone() ? nullptr : Nodes[Current].Children.Find(SegmentName);
+		if (!Child)
+		{
+			return false;
+		}
+		Current = *Child;
+		if (Nodes[Current].Rule != ERule::None)
+		{
+			EffectiveRule = Nodes[Current].Rule;
+		}
+		return true;
+	});
+	return EffectiveRule == ERule::Exclude;
+}
+
+bool FSuperManagerFolderTrie::IsPathUnderRoot(FStringView Path, FStringView Root)
+{
+	Root.RemoveSuffix(Root.EndsWith(TEXT('/')) ? 1 : 0);
+	if (Root.IsEmpty())
+	{
+		return true;
+	}
+	if (!Path.StartsWith(Root, ESearchCase::IgnoreCase))
+	{
+		return false;
+	}
+	return Path.Len() == Root.Len() || Path[Root.Len()] == TEXT('/');
+}
+
+void FSuperManagerFolderTrie::NormalizeRoots(const TArray<FString>& InRoots, TArray<FString>& OutRoots)
+{
+	TArray<FString> SortedRoots = InRoots;
+	for (FString& Root : SortedRoots)
+	{
+		Root.RemoveFromEnd(TEXT("/"));
+	}
+	// 短路径在前，父目录一定先于子目录被保留
+	SortedRoots.Sort([](const FString& A, const FString& B) { return A.Len() < B.Len(); });
+
+	OutRoots.Reset();
+	for (const FString& Root : SortedRoots)
+	{
+		const bool bCovered = OutRoots.ContainsByPredicate([&Root](const FString& KeptRoot)
+		{
+			return IsPathUnderRoot(Root, KeptRoot);
+		});
+		if (!bCovered)
+		{
+			OutRoots.Add(Root);
+		}
+	}
+}
+
+void FSuperManagerFolderTrie::EnumerateSubtree(FStringView Root, TArray<FName>& OutPaths, bool bIncludeExcluded) const
+{
+	FReadScopeLock ReadLock(Lock);
+
+	const int32 RootIndex = FindNode(Root);
+	if (RootIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	TStringBuilder<256> PathBuilder;
+	SuperManagerFolderTrie::ForEachSegment(Root, [&PathBuilder](FStringView Segment)
+	{
+		PathBuilder << TEXT('/') << Segment;
+		return true;
+	});
+
+	const int32 ParentIndex = Nodes[RootIndex].Parent;
+	const bool bParentExcluded = ParentIndex != INDEX_NONE && IsNodeExcluded(ParentIndex);
+	EnumerateRecursive(RootIndex, PathBuilder, bParentExcluded, bIncludeExcluded, OutPaths);
+}
+
+bool FSuperManagerFolderTrie::BuildSubtreeFilter(FStringView Root, FARFilter& OutFilter) const
+{
+	OutFilter.PackagePaths.Reset();
+	OutFilter.bRecursivePaths = false;
+	EnumerateSubtree(Root, OutFilter.PackagePaths);
+
+	// 空的PackagePaths会让过滤器匹配全部资产，调用方必须检查返回值
+	return OutFilter.PackagePaths.Num() > 0;
+}
+
+int32 FSuperManagerFolderTrie::FindNode(FStringView Path) const
+{
+	int32 Current = 0;
+	const bool bFound = SuperManagerFolderTrie::ForEachSegment(Path, [this, &Current](FStringView Segment)
+	{
+		// 用FNAME_Find查找，不会因为查询而往名字表里塞新名字
+		const FName SegmentName(Segment.Len(), Segment.GetData(), FNAME_Find);
+		const int32* Child = SegmentName.IsNone() ? nullptr : Nodes[Current].Children.Find(SegmentName);
+		if (!Child)
+		{
+			return false;
+		}
+		Current = *Child;
+		return true;
+	});
+	return bFound ? Current : INDEX_NONE;
+}
+
+int32 FSuperManagerFolderTrie::FindOrAddNode(FStringView Path)
+{
+	int32 Current = 0;
+	SuperManagerFolderTrie::ForEachSegment(Path, [this, &Current](FStringView Segment)
+	{
+		const FName SegmentName(Segment.Len(), Segment.GetData());
+		if (const int32* Child = Nodes[Current].Children.Find(SegmentName))
+		{
+			Current = *Child;
+		}
+		else
+		{
+			const int32 NewIndex = AllocNode(SegmentName, Current);
+			Nodes[Current].Children.Add(SegmentName, NewIndex);
+			Current = NewIndex;
+		}
+		return true;
+	});
+	return Current;
+}
+
+int32 FSuperManagerFolderTrie::AllocNode(FName Segment, int32 Parent)
+{
+	const int32 NodeIndex = FreeNodes.Num() > 0 ? FreeNodes.Pop(EAllowShrinking::No) : Nodes.AddDefaulted();
+	FNode& Node = Nodes[NodeIndex];
+	Node = FNode();
+	Node.Segment = Segment;
+	Node.Parent = Parent;
+	return NodeIndex;
+}
+
+void FSuperManagerFolderTrie::MarkSubtreeRemoved(int32 NodeIndex)
+{
+	Nodes[NodeIndex].bExists = false;
+	for (const TPair<FName, int32>& Child : Nodes[NodeIndex].Children)
+	{
+		MarkSubtreeRemoved(Child.Value);
+	}
+}
+
+void FSuperManagerFolderTrie::PruneNode(int32 NodeIndex)
+{
+	// 先处理子节点，再回收自身；根节点永远保留
+	TArray<int32> ChildIndices;
+	Nodes[NodeIndex].Children.GenerateValueArray(ChildIndices);
+	for (const int32 ChildIndex : ChildIndices)
+	{
+		PruneNode(ChildIndex);
+	}
+
+	FNode& Node = Nodes[NodeIndex];
+	if (NodeIndex == 0 || Node.bExists || Node.Rule != ERule::None || Node.Children.Num() > 0)
+	{
+		return;
+	}
+	Nodes[Node.Parent].Children.Remove(Node.Segment);
+	Node = FNode();
+	FreeNodes.Add(NodeIndex);
+}
+
+bool FSuperManagerFolderTrie::IsNodeExcluded(int32 NodeIndex) const
+{
+	for (int32 Current = NodeIndex; Current != INDEX_NONE; Current = Nodes[Current].Parent)
+	{
+		if (Nodes[Current].Rule != ERule::None)
+		{
+			return Nodes[Current].Rule == ERule::Exclude;
+		}
+	}
+	return false;
+}
+
+void FSuperManagerFolderTrie::EnumerateRecursive(int32 NodeIndex, TStringBuilder<256>& PathBuilder, bool bExcluded, bool bIncludeExcluded, TArray<FName>& OutPaths) const
+{
+	const FNode& Node = Nodes[NodeIndex];
+	if (Node.Rule != ERule::None)
+	{
+		bExcluded = Node.Rule == ERule::Exclude;
+	}
+	// 被排除的子树下没有包含规则时可以整棵跳过
+	if (bExcluded && !bIncludeExcluded && NumIncludeRules == 0)
+	{
+		return;
+	}
+	if (Node.bExists && (!bExcluded || bIncludeExcluded))
+	{
+		OutPaths.Add(FName(PathBuilder.ToString()));
+	}
+
+	for (const TPair<FName, int32>& Child : Node.Children)
+	{
+		const int32 PrefixLen = PathBuilder.Len();
+		PathBuilder << TEXT('/');
+		Child.Key.AppendString(PathBuilder);
+		EnumerateRecursive(Child.Value, PathBuilder, bExcluded, bIncludeExcluded, OutPaths);
+		PathBuilder.RemoveSuffix(PathBuilder.Len() - PrefixLen);
+	}
+}
+
+void FSuperManagerFolderTrie::OnPathAdded(const FString& Path)
+{
+	FWriteScopeLock WriteLock(Lock);
+	Nodes[FindOrAddNode(Path)].bExists = true;
+}
+
+void FSuperManagerFolderTrie::OnPathRemoved(const FString& Path)
+{
+	FWriteScopeLock WriteLock(Lock);
+	const int32 NodeIndex = FindNode(Path);
+	if (NodeIndex == INDEX_NONE || NodeIndex == 0)
+	{
+		return;
+	}
+
+	MarkSubtreeRemoved(NodeIndex);
+
+	// 从被删除的节点开始往上回收已经没有意义的节点
+	int32 Current = NodeIndex;
+	while (Current != 0)
+	{
+		const int32 Parent = Nodes[Current].Parent;
+		const int32 NumFreeBefore = FreeNodes.Num();
+		PruneNode(Current);
+		if (FreeNodes.Num() == NumFreeBefore || FreeNodes.Last() != Current)
+		{
+			break;
+		}
+		Current = Parent;
+	}
+}
+
+void FSuperManagerFolderTrie::OnSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	RebuildRules();
+}
@@ -0,0 +1,373 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AssetIndex/UnusedAssetTracker.h"
+
+#include "AssetIndex/FolderTrie.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/ARFilter.h"
+#include "Async/ParallelFor.h"
+#include "Misc/PathViews.h"
+#include "Settings/SuperManagerSettings.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+namespace SuperManagerUnusedAssetTracker
+{
+	// 计数只覆盖项目内容
+	const TCHAR* TrackedRoot = TEXT("/Game");
+}
+
+FSuperManagerUnusedAssetTracker::FSuperManagerUnusedAssetTracker(const TSharedRef<FSuperManagerFolderTrie>& InFolderTrie,
+                                                                 const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler,
+                                                                 FIsPackageUnused InIsPackageUnused)
+	: FolderTrie(InFolderTrie)
+	, TaskScheduler(InTaskScheduler)
+	, IsPackageUnused(MoveTemp(InIsPackageUnused))
+{
+}
+
+void FSuperManagerUnusedAssetTracker::Initialize()
+{
+	IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	AssetAddedHandle = AssetRegistry.OnAssetAdded().AddSP(this, &FSuperManagerUnusedAssetTracker::OnAssetAdded);
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddSP(this, &FSuperManagerUnusedAssetTracker::OnAssetRemoved);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddSP(this, &FSuperManagerUnusedAssetTracker::OnAssetRenamed);
+	AssetUpdatedHandle = AssetRegistry.OnAssetUpdated().AddSP(this, &FSuperManagerUnusedAssetTracker::OnAssetUpdated);
+	SettingsChangedHandle = GetMutableDefault<USuperManagerSettings>()->OnSettingChanged().AddSP(
+		this, &FSuperManagerUnusedAssetTracker::OnSettingsChanged);
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateSP(this, &FSuperManagerUnusedAssetTracker::Tick), 0.1f);
+
+	// 注册表扫描完成前的事件没有意义，等全部加载后做一次完整统计
+	if (AssetRegistry.IsLoadingAssets())
+	{
+		FilesLoadedHandle = AssetRegistry.OnFilesLoaded().AddSP(this, &FSuperManagerUnusedAssetTracker::OnFilesLoaded);
+	}
+	else
+	{
+		RebuildAll();
+	}
+}
+
+void FSuperManagerUnusedAssetTracker::Shutdown()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	if (FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.OnFilesLoaded().Remove(FilesLoadedHandle);
+		AssetRegistry.OnAssetAdded().Remove(AssetAddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(AssetRenamedHandle);
+		AssetRegistry.OnAssetUpdated().Remove(AssetUpdatedHandle);
+	}
+	if (UObjectInitialized())
+	{
+		GetMutableDefault<USuperManagerSettings>()->OnSettingChanged().Remove(SettingsChangedHandle);
+	}
+}
+
+FSuperManagerUnusedStats FSuperManagerUnusedAssetTracker::GetFolderStats(FStringView FolderPath) const
+{
+	FolderPath.RemoveSuffix(FolderPath.EndsWith(TEXT('/')) ? 1 : 0);
+	const FName FolderName(FolderPath.Len(), FolderPath.GetData(), FNAME_Find);
+	const FSuperManagerUnusedStats* Stats = FolderName.IsNone() ? nullptr : FolderStats.Find(FolderName);
+	return Stats ? *Stats : FSuperManagerUnusedStats();
+}
+
+void FSuperManagerUnusedAssetTracker::RebuildAll()
+{
+	// 从这一刻起的事件都要记录，重建完成后再增量应用
+	bAcceptEvents = true;
+	bBatchInFlight = true;
+	PendingPackages.Reset();
+	const int32 RebuildGeneration = ++Generation;
+
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	TWeakPtr<FSuperManagerUnusedAssetTracker> WeakThis = AsShared();
+	TaskScheduler->LaunchWorker(TEXT("SuperManager.RebuildUnusedStats"), [WeakThis, RebuildGeneration, Token](const FSuperManagerCancellationToken&)
+	{
+		const TSharedPtr<FSuperManagerUnusedAssetTracker> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			return;
+		}
+
+		FARFilter Filter;
+		TArray<FAssetData> AssetDataArray;
+		if (This->FolderTrie->BuildSubtreeFilter(SuperManagerUnusedAssetTracker::TrackedRoot, Filter))
+		{
+			IAssetRegistry::GetChecked().GetAssets(Filter, AssetDataArray);
+		}
+
+		TSet<FName> UniquePackages;
+		UniquePackages.Reserve(AssetDataArray.Num());
+		for (const FAssetData& AssetData : AssetDataArray)
+		{
+			UniquePackages.Add(AssetData.PackageName);
+		}
+		TArray<FName> PackageNames = UniquePackages.Array();
+
+		TArray<FPackageState> States;
+		States.SetNum(PackageNames.Num());
+		TArray<bool> Tracked;
+		Tracked.SetNumZeroed(PackageNames.Num());
+		ParallelFor(PackageNames.Num(), [&This, &PackageNames, &States, &Tracked](int32 Index)
+		{
+			Tracked[Index] = This->EvaluatePackage(PackageNames[Index], States[Index]);
+		});
+
+		This->TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.ApplyUnusedStats"),
+			[WeakThis, RebuildGeneration, PackageNames = MoveTemp(PackageNames), States = MoveTemp(States), Tracked = MoveTemp(Tracked)]()
+			{
+				const TSharedPtr<FSuperManagerUnusedAssetTracker> This = WeakThis.Pin();
+				if (This.IsValid() && This->Generation == RebuildGeneration)
+				{
+					This->Packages.Reset();
+					This->FolderStats.Reset();
+					This->ApplyEvaluatedStates(PackageNames, States, Tracked);
+					This->bInitialScanDone = true;
+					This->bBatchInFlight = false;
+				}
+				return true;
+			}, Token, ESuperManagerTaskPriority::Background);
+	}, Token, ESuperManagerTaskPriority::Background);
+}
+
+void FSuperManagerUnusedAssetTracker::ApplyEvaluatedStates(const TArray<FName>& PackageNames, const TArray<FPackageState>& States, const TArray<bool>& Tracked)
+{
+	for (int32 Index = 0; Index < PackageNames.Num(); ++Index)
+	{
+		SetPackageState(PackageNames[Index], Tracked[Index] ? &States[Index] : nullptr);
+	}
+
+	++NumUpdatePasses;
+	StatsChangedEvent.Broadcast();
+}
+
+void FSuperManagerUnusedAssetTracker::ApplyPendingBatch()
+{
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+
+	// 包本身、它原来依赖的包和现在依赖的包，被引用状态都可能变化
+	TSet<FName> AffectedPackages;
+	for (const FName PackageName : PendingPackages)
+	{
+		AffectedPackages.Add(PackageName);
+		if (const FPackageState* OldState = Packages.Find(PackageName))
+		{
+			AffectedPackages.Append(OldState->Dependencies);
+		}
+		TArray<FName> NewDependencies;
+		AssetRegistry.GetDependencies(PackageName, NewDependencies);
+		AffectedPackages.Append(NewDependencies);
+	}
+	PendingPackages.Reset();
+
+	bBatchInFlight = true;
+	const int32 BatchGeneration = Generation;
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	TWeakPtr<FSuperManagerUnusedAssetTracker> WeakThis = AsShared();
+	TaskScheduler->LaunchWorker(TEXT("SuperManager.UpdateUnusedStats"),
+		[WeakThis, BatchGeneration, Token, PackageNames = AffectedPackages.Array()](const FSuperManagerCancellationToken&) mutable
+		{
+			const TSharedPtr<FSuperManagerUnusedAssetTracker> This = WeakThis.Pin();
+			if (!This.IsValid())
+			{
+				return;
+			}
+
+			TArray<FPackageState> States;
+			States.SetNum(PackageNames.Num());
+			TArray<bool> Tracked;
+			Tracked.SetNumZeroed(PackageNames.Num());
+			ParallelFor(PackageNames.Num(), [&This, &PackageNames, &States, &Tracked](int32 Index)
+			{
+				Tracked[Index] = This->EvaluatePackage(PackageNames[Index], States[Index]);
+			});
+
+			This->TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.ApplyUnusedStats"),
+				[WeakThis, BatchGeneration, PackageNames = MoveTemp(PackageNames), States = MoveTemp(States), Tracked = MoveTemp(Tracked)]()
+				{
+					const TSharedPtr<FSuperManagerUnusedAssetTracker> This = WeakThis.Pin();
+					if (This.IsValid() && This->Generation == BatchGeneration)
+					{
+						This->ApplyEvaluatedStates(PackageNames, States, Tracked);
+						This->bBatchInFlight = false;
+					}
+					return true;
+				}, Token, ESuperManagerTaskPriority::Background);
+		}, Token, ESuperManagerTaskPriority::Background);
+}
+
+bool FSuperManagerUnusedAssetTracker::EvaluatePackage(FName PackageName, FPackageState& OutState) const
+{
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+
+	TStringBuilder<256> PackageNameString;
+	PackageName.AppendString(PackageNameString);
+	if (!FSuperManagerFolderTrie::IsPathUnderRoot(PackageNameString.ToView(), SuperManagerUnusedAssetTracker::TrackedRoot))
+	{
+		return false;
+	}
+
+	const FStringView FolderPath = FPathViews::GetPath(PackageNameString.ToView());
+	if (FolderTrie->IsPathExcluded(FolderPath))
+	{
+		return false;
+	}
+
+	TArray<FAssetData> AssetsInPackage;
+	AssetRegistry.GetAssetsByPackageName(PackageName, AssetsInPackage);
+	if (AssetsInPackage.Num() == 0)
+	{
+		return false;
+	}
+
+	OutState.FolderPath = FName(FolderPath);
+	OutState.bUnused = IsPackageUnused(PackageName);
+	if (const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(PackageName))
+	{
+		OutState.DiskSize = FMath::Max<int64>(PackageData->DiskSize, 0);
+	}
+
+	TArray<FName> Dependencies;
+	AssetRegistry.GetDependencies(PackageName, Dependencies);
+	OutState.Dependencies.Reset();
+	for (const FName Dependency : Dependencies)
+	{
+		TStringBuilder<256> DependencyString;
+		Dependency.AppendString(DependencyString);
+		if (FSuperManagerFolderTrie::IsPathUnderRoot(DependencyString.ToView(), SuperManagerUnusedAssetTracker::TrackedRoot))
+		{
+			OutState.Dependencies.Add(Dependency);
+		}
+	}
+	return true;
+}
+
+void FSuperManagerUnusedAssetTracker::SetPackageState(FName PackageName, const FPackageState* NewState)
+{
+	if (const FPackageState* OldState = Packages.Find(PackageName))
+	{
+		if (OldState->bUnused)
+		{
+			AddToFolderStats(OldState->FolderPath, -1, -OldState->DiskSize);
+		}
+	}
+
+	if (NewState)
+	{
+		if (NewState->bUnused)
+		{
+			AddToFolderStats(NewState->FolderPath, 1, NewState->DiskSize);
+		}
+		Packages.Add(PackageName, *NewState);
+	}
+	else
+	{
+		Packages.Remove(PackageName);
+	}
+}
+
+void FSuperManagerUnusedAssetTracker::AddToFolderStats(FName FolderPath, int32 CountDelta, int64 BytesDelta)
+{
+	// 沿着父目录一路累加，查询任意目录时不需要再遍历子树
+	TStringBuilder<256> FolderString;
+	FolderPath.AppendString(FolderString);
+	FStringView CurrentPath = FolderString.ToView();
+	while (!CurrentPath.IsEmpty())
+	{
+		FSuperManagerUnusedStats& Stats = FolderStats.FindOrAdd(FName(CurrentPath));
+		Stats.NumUnusedAssets += CountDelta;
+		Stats.UnusedBytes += BytesDelta;
+
+		int32 SlashIndex = INDEX_NONE;
+		if (!CurrentPath.FindLastChar(TEXT('/'), SlashIndex) || SlashIndex == 0)
+		{
+			break;
+		}
+		CurrentPath.LeftInline(SlashIndex);
+	}
+}
+
+void FSuperManagerUnusedAssetTracker::MarkPackagesDirty(TConstArrayView<FName> PackageNames)
+{
+	for (const FName PackageName : PackageNames)
+	{
+		MarkPackageDirty(PackageName);
+	}
+}
+
+void FSuperManagerUnusedAssetTracker::MarkPackageDirty(FName PackageName)
+{
+	if (!bAcceptEvents)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (PendingPackages.Num() == 0)
+	{
+		FirstPendingTime = Now;
+	}
+	LastEventTime = Now;
+	PendingPackages.Add(PackageName);
+}
+
+bool FSuperManagerUnusedAssetTracker::Tick(float DeltaTime)
+{
+	if (PendingPackages.Num() == 0 || bBatchInFlight)
+	{
+		return true;
+	}
+
+	// 批量导入时事件连续到达，等事件停下来(或者积攒太久)再统一处理
+	const USuperManagerSettings* Settings = USuperManagerSettings::Get();
+	const double Now = FPlatformTime::Seconds();
+	const bool bQuiet = Now - LastEventTime >= Settings->CounterDebounceSeconds;
+	const bool bWaitedTooLong = Now - FirstPendingTime >= Settings->CounterMaxBatchDelaySeconds;
+	if ((bQuiet || bWaitedTooLong) && !IAssetRegistry::GetChecked().IsLoadingAssets())
+	{
+		ApplyPendingBatch();
+	}
+	return true;
+}
+
+void FSuperManagerUnusedAssetTracker::OnFilesLoaded()
+{
+	RebuildAll();
+}
+
+void FSuperManagerUnusedAssetTracker::OnAssetAdded(const FAssetData& AssetData)
+{
+	MarkPackageDirty(AssetData.PackageName);
+}
+
+void FSuperManagerUnusedAssetTracker::OnAssetRemoved(const FAssetData& AssetData)
+{
+	MarkPackageDirty(AssetData.PackageName);
+}
+
+void FSuperManagerUnusedAssetTracker::OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	MarkPackageDirty(AssetData.PackageName);
+	MarkPackageDirty(FName(FPackageName::ObjectPathToPackageName(OldObjectPath)));
+}
+
+void FSuperManagerUnusedAssetTracker::OnAssetUpdated(const FAssetData& AssetData)
+{
+	MarkPackageDirty(AssetData.PackageName);
+}
+
+void FSuperManagerUnusedAssetTracker::OnSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (bAcceptEvents)
+	{
+		RebuildAll();
+	}
+}
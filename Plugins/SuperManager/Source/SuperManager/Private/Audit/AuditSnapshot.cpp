@@ -0,0 +1,517 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Audit/AuditSnapshot.h"
+
+#include "SuperManager.h"
+#include "AssetActions/QuickAssetAction.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "HAL/FileManager.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "References/StringReferenceScanner.h"
+#include "Settings/SuperManagerSettings.h"
+#include "Similarity/HammingBKTree.h"
+
+namespace SuperManagerAuditSnapshot
+{
+	// 快照格式或其中指纹的计算方式变化时修改，新旧指纹混在一起无法比较
+	constexpr uint32 SnapshotVersion = 3;
+
+	// FName 在普通文件归档里不会被序列化，按字符串存取
+	void SerializeName(FArchive& Ar, FName& Name)
+	{
+		FString NameString = Ar.IsLoading() ? FString() : Name.ToString();
+		Ar << NameString;
+		if (Ar.IsLoading())
+		{
+			Name = FName(*NameString);
+		}
+	}
+
+	void SerializeState(FArchive& Ar, FSuperManagerAuditPackageState& State)
+	{
+		Ar << State.SavedHash;
+		Ar << State.DiskSize;
+		int32 NumDependencies = State.Dependencies.Num();
+		Ar << NumDependencies;
+		if (Ar.IsLoading())
+		{
+			State.Dependencies.SetNum(FMath::Max(NumDependencies, 0));
+		}
+		for (FName& Dependency : State.Dependencies)
+		{
+			SerializeName(Ar, Dependency);
+		}
+		Ar << State.bUnused;
+		Ar << State.bStringReferenced;
+		Ar << State.MissingPrefix;
+	}
+
+	template <typename ValueType, typename SerializeValueType>
+	void SerializeMap(FArchive& Ar, TMap<FName, ValueType>& Map, SerializeValueType SerializeValue)
+	{
+		int32 NumEntries = Map.Num();
+		Ar << NumEntries;
+		if (Ar.IsLoading())
+		{
+			Map.Reset();
+			Map.Reserve(NumEntries);
+			for (int32 Index = 0; Index < NumEntries && !Ar.IsError(); ++Index)
+			{
+				FName Key;
+				ValueType Value;
+				SerializeName(Ar, Key);
+				SerializeValue(Ar, Value);
+				Map.Add(Key, MoveTemp(Value));
+			}
+			return;
+		}
+		for (TPair<FName, ValueType>& Pair : Map)
+		{
+			SerializeName(Ar, Pair.Key);
+			SerializeValue(Ar, Pair.Value);
+		}
+	}
+
+	void Serialize(FArchive& Ar, FSuperManagerAuditSnapshot& Snapshot)
+	{
+		Ar << Snapshot.Root;
+		Ar << Snapshot.Timestamp;
+		SerializeMap(Ar, Snapshot.Packages, &SerializeState);
+		SerializeMap(Ar, Snapshot.TextureHashes, [](FArchive& InAr, uint64& Hash) { InAr << Hash; });
+		SerializeMap(Ar, Snapshot.MeshFingerprints, [](FArchive& InAr, FSuperManagerMeshFingerprint& Fingerprint) { InAr << Fingerprint; });
+		SerializeMap(Ar, Snapshot.MaterialInstanceFingerprints,
+		             [](FArchive& InAr, FSuperManagerMaterialInstanceFingerprint& Fingerprint) { InAr << Fingerprint; });
+	}
+
+	bool NameLess(FName A, FName B)
+	{
+		return A.LexicalLess(B);
+	}
+
+	TArray<TSharedPtr<FJsonValue>> NamesToJson(const TArray<FName>& Names)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (const FName Name : Names)
+		{
+			Values.Add(MakeShared<FJsonValueString>(Name.ToString()));
+		}
+		return Values;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> DuplicatesToJson(const TArray<FSuperManagerAuditDuplicate>& Duplicates)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (const FSuperManagerAuditDuplicate& Duplicate : Duplicates)
+		{
+			TSharedRef<FJsonObject> DuplicateObject = MakeShared<FJsonObject>();
+			DuplicateObject->SetStringField(TEXT("package"), Duplicate.PackageName.ToString());
+			DuplicateObject->SetArrayField(TEXT("matches"), NamesToJson(Duplicate.Matches));
+			Values.Add(MakeShared<FJsonValueObject>(DuplicateObject));
+		}
+		return Values;
+	}
+
+	// 通过 CDO 复用快速资产操作里的前缀表，只查已加载的类，不加载资产本身
+	FString GetMissingPrefix(const FAssetData& AssetData)
+	{
+		UClass* AssetClass = AssetData.GetClass();
+		const FString* Prefix = AssetClass ? GetDefault<UQuickAssetAction>()->FindPrefixForClass(AssetClass) : nullptr;
+		if (!Prefix || Prefix->IsEmpty() || AssetData.AssetName.ToString().StartsWith(*Prefix))
+		{
+			return FString();
+		}
+		return *Prefix;
+	}
+
+	// 改动包的指纹与其他包相同时记为新出现的重复，指纹没变(只是重新保存)的不算
+	template <typename ValueType, typename KeyFuncType>
+	void FindNewExactDuplicates(const TMap<FName, ValueType>& OldValues, const TMap<FName, ValueType>& NewValues,
+	                            const TArray<FName>& ChangedPackages, KeyFuncType KeyFunc, TArray<FSuperManagerAuditDuplicate>& OutDuplicates)
+	{
+		TMultiMap<uint64, FName> PackagesByKey;
+		for (const TPair<FName, ValueType>& Pair : NewValues)
+		{
+			PackagesByKey.Add(KeyFunc(Pair.Value), Pair.Key);
+		}
+		for (const FName PackageName : ChangedPackages)
+		{
+			const ValueType* NewValue = NewValues.Find(PackageName);
+			const ValueType* OldValue = OldValues.Find(PackageName);
+			if (!NewValue || (OldValue && KeyFunc(*OldValue) == KeyFunc(*NewValue)))
+			{
+				continue;
+			}
+			FSuperManagerAuditDuplicate Duplicate;
+			Duplicate.PackageName = PackageName;
+			PackagesByKey.MultiFind(KeyFunc(*NewValue), Duplicate.Matches);
+			Duplicate.Matches.Remove(PackageName);
+			if (!Duplicate.Matches.IsEmpty())
+			{
+				Duplicate.Matches.Sort(&NameLess);
+				OutDuplicates.Add(MoveTemp(Duplicate));
+			}
+		}
+	}
+}
+
+FString FSuperManagerAuditSnapshot::GetDefaultFilePath(const FString& Root)
+{
+	FString FileName = Root;
+	FileName.ReplaceCharInline(TEXT('/'), TEXT('_'));
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SuperManager"), FString::Printf(TEXT("AuditSnapshot%s.bin"), *FileName));
+}
+
+bool FSuperManagerAuditSnapshot::Load(const FString& FilePath)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Reader.IsValid())
+	{
+		return false;
+	}
+	uint32 FileVersion = 0;
+	*Reader << FileVersion;
+	if (FileVersion != SuperManagerAuditSnapshot::SnapshotVersion)
+	{
+		return false;
+	}
+	SuperManagerAuditSnapshot::Serialize(*Reader, *this);
+	if (Reader->IsError())
+	{
+		*this = FSuperManagerAuditSnapshot();
+		return false;
+	}
+	return true;
+}
+
+bool FSuperManagerAuditSnapshot::Save(const FString& FilePath) const
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer.IsValid())
+	{
+		return false;
+	}
+	uint32 FileVersion = SuperManagerAuditSnapshot::SnapshotVersion;
+	*Writer << FileVersion;
+	// 序列化函数读写共用，写入时不会修改快照
+	SuperManagerAuditSnapshot::Serialize(*Writer, const_cast<FSuperManagerAuditSnapshot&>(*this));
+	return Writer->Close();
+}
+
+TSharedRef<FJsonObject> FSuperManagerAuditDelta::ToJson() const
+{
+	using namespace SuperManagerAuditSnapshot;
+	TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+	JsonObject->SetStringField(TEXT("root"), Root);
+	JsonObject->SetStringField(TEXT("baseline"), BaselineTimestamp == FDateTime() ? FString() : BaselineTimestamp.ToIso8601());
+	JsonObject->SetArrayField(TEXT("added"), NamesToJson(AddedPackages));
+	JsonObject->SetArrayField(TEXT("modified"), NamesToJson(ModifiedPackages));
+	JsonObject->SetArrayField(TEXT("removed"), NamesToJson(RemovedPackages));
+	JsonObject->SetNumberField(TEXT("reevaluated"), NumReevaluated);
+
+	JsonObject->SetArrayField(TEXT("newlyUnused"), NamesToJson(NewlyUnused));
+	JsonObject->SetArrayField(TEXT("noLongerUnused"), NamesToJson(NoLongerUnused));
+	JsonObject->SetArrayField(TEXT("newlySimilarTextures"), DuplicatesToJson(NewlySimilarTextures));
+	JsonObject->SetArrayField(TEXT("newlyDuplicateMeshes"), DuplicatesToJson(NewlyDuplicateMeshes));
+	JsonObject->SetArrayField(TEXT("newlyDuplicateMaterialInstances"), DuplicatesToJson(NewlyDuplicateMaterialInstances));
+
+	TArray<TSharedPtr<FJsonValue>> NamingValues;
+	for (const TPair<FName, FString>& Violation : NewNamingViolations)
+	{
+		TSharedRef<FJsonObject> ViolationObject = MakeShared<FJsonObject>();
+		ViolationObject->SetStringField(TEXT("package"), Violation.Key.ToString());
+		ViolationObject->SetStringField(TEXT("expectedPrefix"), Violation.Value);
+		NamingValues.Add(MakeShared<FJsonValueObject>(ViolationObject));
+	}
+	JsonObject->SetArrayField(TEXT("newNamingViolations"), NamingValues);
+
+	JsonObject->SetStringField(TEXT("bytesDelta"), LexToString(BytesDelta));
+	TArray<FString> Folders;
+	FolderBytesDelta.GetKeys(Folders);
+	Folders.Sort();
+	TSharedRef<FJsonObject> FoldersObject = MakeShared<FJsonObject>();
+	for (const FString& Folder : Folders)
+	{
+		FoldersObject->SetStringField(Folder, LexToString(FolderBytesDelta[Folder]));
+	}
+	JsonObject->SetObjectField(TEXT("folderBytesDelta"), FoldersObject);
+	return JsonObject;
+}
+
+void SuperManagerAuditSnapshot::Update(FSuperManagerAuditSnapshot& Snapshot, FSuperManagerAuditDelta& OutDelta)
+{
+	check(IsInGameThread());
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+	const TSharedPtr<FSuperManagerStringReferenceScanner> StringReferenceScanner = SuperManagerModule.GetStringReferenceScanner();
+
+	OutDelta = FSuperManagerAuditDelta();
+	OutDelta.Root = Snapshot.Root;
+	OutDelta.BaselineTimestamp = Snapshot.Timestamp;
+
+#pragma region 找出改动的包
+	// 只读注册表内存数据，不访问磁盘
+	TArray<TSharedPtr<FAssetData>> AllAssets;
+	TMap<FSoftObjectPath, FString> AssetRoots;
+	SuperManagerModule.GatherAssetsUnderFolders({Snapshot.Root}, AllAssets, AssetRoots);
+
+	TMap<FName, TArray<TSharedPtr<FAssetData>>> CurrentPackages;
+	for (const TSharedPtr<FAssetData>& AssetData : AllAssets)
+	{
+		CurrentPackages.FindOrAdd(AssetData->PackageName).Add(AssetData);
+	}
+
+	TMap<FName, FSuperManagerAuditPackageState> OldStates;
+	TArray<FName> ChangedPackages;
+	for (const TPair<FName, TArray<TSharedPtr<FAssetData>>>& Pair : CurrentPackages)
+	{
+		const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(Pair.Key);
+		const FIoHash SavedHash = PackageData.IsSet() ? PackageData->GetPackageSavedHash() : FIoHash();
+		const FSuperManagerAuditPackageState* OldState = Snapshot.Packages.Find(Pair.Key);
+		// 拿不到保存哈希时保守地当作改动
+		if (OldState && OldState->SavedHash == SavedHash && !SavedHash.IsZero())
+		{
+			continue;
+		}
+
+		(OldState ? OutDelta.ModifiedPackages : OutDelta.AddedPackages).Add(Pair.Key);
+		ChangedPackages.Add(Pair.Key);
+		if (OldState)
+		{
+			OldStates.Add(Pair.Key, *OldState);
+		}
+
+		FSuperManagerAuditPackageState NewState;
+		NewState.SavedHash = SavedHash;
+		NewState.DiskSize = PackageData.IsSet() ? FMath::Max<int64>(PackageData->DiskSize, 0) : 0;
+		AssetRegistry.GetDependencies(Pair.Key, NewState.Dependencies);
+		for (const TSharedPtr<FAssetData>& AssetData : Pair.Value)
+		{
+			NewState.MissingPrefix = SuperManagerAuditSnapshot::GetMissingPrefix(*AssetData);
+			if (!NewState.MissingPrefix.IsEmpty())
+			{
+				break;
+			}
+		}
+		Snapshot.Packages.Add(Pair.Key, MoveTemp(NewState));
+	}
+
+	for (auto It = Snapshot.Packages.CreateIterator(); It; ++It)
+	{
+		if (!CurrentPackages.Contains(It->Key))
+		{
+			OutDelta.RemovedPackages.Add(It->Key);
+			OldStates.Add(It->Key, MoveTemp(It->Value));
+			It.RemoveCurrent();
+		}
+	}
+#pragma endregion
+
+#pragma region 未使用资产
+	// 引用关系可能变化的包：改动包本身、它们改动前后的依赖、文本引用状态翻转的包
+	TSet<FName> AffectedPackages;
+	AffectedPackages.Append(ChangedPackages);
+	for (const TPair<FName, FSuperManagerAuditPackageState>& Pair : OldStates)
+	{
+		AffectedPackages.Append(Pair.Value.Dependencies);
+	}
+	for (const FName PackageName : ChangedPackages)
+	{
+		AffectedPackages.Append(Snapshot.Packages[PackageName].Dependencies);
+	}
+
+	StringReferenceScanner->ScanBlocking();
+	for (TPair<FName, FSuperManagerAuditPackageState>& Pair : Snapshot.Packages)
+	{
+		const bool bStringReferenced = StringReferenceScanner->IsReferenced(Pair.Key);
+		if (bStringReferenced != Pair.Value.bStringReferenced)
+		{
+			Pair.Value.bStringReferenced = bStringReferenced;
+			AffectedPackages.Add(Pair.Key);
+		}
+	}
+
+	TArray<TSharedPtr<FAssetData>> AssetsToReevaluate;
+	for (const FName PackageName : AffectedPackages)
+	{
+		// 根目录以外的依赖不在快照里
+		if (const TArray<TSharedPtr<FAssetData>>* PackageAssets = CurrentPackages.Find(PackageName))
+		{
+			AssetsToReevaluate.Add((*PackageAssets)[0]);
+		}
+	}
+	OutDelta.NumReevaluated = AssetsToReevaluate.Num();
+
+	TArray<TSharedPtr<FAssetData>> UnusedAssets;
+	SuperManagerModule.ListUnusedAssetsForAssetList(AssetsToReevaluate, UnusedAssets);
+	TSet<FName> UnusedPackages;
+	for (const TSharedPtr<FAssetData>& AssetData : UnusedAssets)
+	{
+		UnusedPackages.Add(AssetData->PackageName);
+	}
+	for (const TSharedPtr<FAssetData>& AssetData : AssetsToReevaluate)
+	{
+		FSuperManagerAuditPackageState& State = Snapshot.Packages[AssetData->PackageName];
+		const FSuperManagerAuditPackageState* OldState = OldStates.Find(AssetData->PackageName);
+		const bool bWasUnused = OldState ? OldState->bUnused : State.bUnused;
+		State.bUnused = UnusedPackages.Contains(AssetData->PackageName);
+		if (State.bUnused && !bWasUnused)
+		{
+			OutDelta.NewlyUnused.Add(AssetData->PackageName);
+		}
+		else if (!State.bUnused && bWasUnused)
+		{
+			OutDelta.NoLongerUnused.Add(AssetData->PackageName);
+		}
+	}
+	// 新增的包没有旧状态，上面按"原来被使用"处理，未使用的会记入 NewlyUnused
+#pragma endregion
+
+#pragma region 重复资产
+	TArray<TSharedPtr<FAssetData>> ChangedAssets;
+	for (const FName PackageName : ChangedPackages)
+	{
+		ChangedAssets.Append(CurrentPackages[PackageName]);
+	}
+
+	const TMap<FName, uint64> OldTextureHashes = Snapshot.TextureHashes;
+	const TMap<FName, FSuperManagerMeshFingerprint> OldMeshFingerprints = Snapshot.MeshFingerprints;
+	const TMap<FName, FSuperManagerMaterialInstanceFingerprint> OldMaterialInstanceFingerprints = Snapshot.MaterialInstanceFingerprints;
+	for (const TPair<FName, FSuperManagerAuditPackageState>& Pair : OldStates)
+	{
+		Snapshot.TextureHashes.Remove(Pair.Key);
+		Snapshot.MeshFingerprints.Remove(Pair.Key);
+		Snapshot.MaterialInstanceFingerprints.Remove(Pair.Key);
+	}
+
+	// 之前父材质下只有一个实例的没有指纹，改动的实例与它同父材质时要一起计算，否则比不出重复
+	const FTopLevelAssetPath MaterialInstanceClassPath = UMaterialInstanceConstant::StaticClass()->GetClassPathName();
+	TSet<FString> ChangedParents;
+	for (const TSharedPtr<FAssetData>& AssetData : ChangedAssets)
+	{
+		FString Parent;
+		if (AssetData->AssetClassPath == MaterialInstanceClassPath && AssetData->GetTagValue(TEXT("Parent"), Parent))
+		{
+			ChangedParents.Add(Parent);
+		}
+	}
+	TArray<TSharedPtr<FAssetData>> MaterialInstanceAssets = ChangedAssets;
+	const TSet<FName> ChangedPackageSet(ChangedPackages);
+	for (const TSharedPtr<FAssetData>& AssetData : AllAssets)
+	{
+		FString Parent;
+		if (!ChangedParents.IsEmpty() && AssetData->AssetClassPath == MaterialInstanceClassPath &&
+			!ChangedPackageSet.Contains(AssetData->PackageName) &&
+			!Snapshot.MaterialInstanceFingerprints.Contains(AssetData->PackageName) &&
+			AssetData->GetTagValue(TEXT("Parent"), Parent) && ChangedParents.Contains(Parent))
+		{
+			MaterialInstanceAssets.Add(AssetData);
+		}
+	}
+
+	// 指纹缓存按包时间戳命中，只有改动的包需要加载
+	FSuperManagerTextureSimilarity::FResults TextureHashes;
+	FSuperManagerMeshDuplicates::FResults MeshFingerprints;
+	FSuperManagerMaterialInstanceDuplicates::FResults MaterialInstanceFingerprints;
+	SuperManagerModule.GetTextureSimilarity()->ComputeBlocking(ChangedAssets, TextureHashes);
+	SuperManagerModule.GetMeshDuplicates()->ComputeBlocking(ChangedAssets, MeshFingerprints);
+	// 按父材质过滤时用整个注册表的实例数，不只看这次改动的实例
+	SuperManagerModule.GetMaterialInstanceDuplicates()->ComputeBlocking(MaterialInstanceAssets, MaterialInstanceFingerprints);
+	for (const TPair<FName, uint64>& Pair : TextureHashes)
+	{
+		Snapshot.TextureHashes.Add(Pair.Key, Pair.Value);
+	}
+	for (const TPair<FName, FSuperManagerMeshFingerprint>& Pair : MeshFingerprints)
+	{
+		Snapshot.MeshFingerprints.Add(Pair.Key, Pair.Value);
+	}
+	for (const TPair<FName, FSuperManagerMaterialInstanceFingerprint>& Pair : MaterialInstanceFingerprints)
+	{
+		Snapshot.MaterialInstanceFingerprints.Add(Pair.Key, Pair.Value);
+	}
+
+	SuperManagerAuditSnapshot::FindNewExactDuplicates(OldMeshFingerprints, Snapshot.MeshFingerprints, ChangedPackages,
+		[](const FSuperManagerMeshFingerprint& Fingerprint) { return Fingerprint.GeometryHash; }, OutDelta.NewlyDuplicateMeshes);
+	SuperManagerAuditSnapshot::FindNewExactDuplicates(OldMaterialInstanceFingerprints, Snapshot.MaterialInstanceFingerprints, ChangedPackages,
+		[](const FSuperManagerMaterialInstanceFingerprint& Fingerprint) { return Fingerprint.ParameterHash; }, OutDelta.NewlyDuplicateMaterialInstances);
+
+	// 近似贴图只报告与改动贴图直接相邻(距离不超过阈值)的贴图，不展开成连通分量
+	const int32 MaxDistance = USuperManagerSettings::Get()->SimilarTextureMaxDistance;
+	FSuperManagerHammingBKTree Tree;
+	TArray<TArray<FName>> PackagesPerNode;
+	for (const TPair<FName, uint64>& Pair : Snapshot.TextureHashes)
+	{
+		const int32 NodeIndex = Tree.Insert(Pair.Value);
+		if (NodeIndex >= PackagesPerNode.Num())
+		{
+			PackagesPerNode.SetNum(NodeIndex + 1);
+		}
+		PackagesPerNode[NodeIndex].Add(Pair.Key);
+	}
+	for (const TPair<FName, uint64>& Pair : TextureHashes)
+	{
+		const uint64* OldHash = OldTextureHashes.Find(Pair.Key);
+		if (OldHash && *OldHash == Pair.Value)
+		{
+			continue;
+		}
+		TArray<int32> Nodes;
+		Tree.Query(Pair.Value, MaxDistance, Nodes);
+		FSuperManagerAuditDuplicate Duplicate;
+		Duplicate.PackageName = Pair.Key;
+		for (const int32 NodeIndex : Nodes)
+		{
+			Duplicate.Matches.Append(PackagesPerNode[NodeIndex]);
+		}
+		Duplicate.Matches.Remove(Pair.Key);
+		if (!Duplicate.Matches.IsEmpty())
+		{
+			Duplicate.Matches.Sort(&SuperManagerAuditSnapshot::NameLess);
+			OutDelta.NewlySimilarTextures.Add(MoveTemp(Duplicate));
+		}
+	}
+#pragma endregion
+
+#pragma region 命名与大小
+	for (const FName PackageName : ChangedPackages)
+	{
+		const FSuperManagerAuditPackageState& State = Snapshot.Packages[PackageName];
+		const FSuperManagerAuditPackageState* OldState = OldStates.Find(PackageName);
+		if (!State.MissingPrefix.IsEmpty() && (!OldState || OldState->MissingPrefix.IsEmpty()))
+		{
+			OutDelta.NewNamingViolations.Emplace(PackageName, State.MissingPrefix);
+		}
+		const int64 SizeDelta = State.DiskSize - (OldState ? OldState->DiskSize : 0);
+		OutDelta.BytesDelta += SizeDelta;
+		OutDelta.FolderBytesDelta.FindOrAdd(FPackageName::GetLongPackagePath(PackageName.ToString())) += SizeDelta;
+	}
+	for (const FName PackageName : OutDelta.RemovedPackages)
+	{
+		const int64 SizeDelta = -OldStates[PackageName].DiskSize;
+		OutDelta.BytesDelta += SizeDelta;
+		OutDelta.FolderBytesDelta.FindOrAdd(FPackageName::GetLongPackagePath(PackageName.ToString())) += SizeDelta;
+	}
+#pragma endregion
+
+	// 输出按名字排序，便于评审时比对
+	OutDelta.AddedPackages.Sort(&SuperManagerAuditSnapshot::NameLess);
+	OutDelta.ModifiedPackages.Sort(&SuperManagerAuditSnapshot::NameLess);
+	OutDelta.RemovedPackages.Sort(&SuperManagerAuditSnapshot::NameLess);
+	OutDelta.NewlyUnused.Sort(&SuperManagerAuditSnapshot::NameLess);
+	OutDelta.NoLongerUnused.Sort(&SuperManagerAuditSnapshot::NameLess);
+	OutDelta.NewNamingViolations.Sort([](const TPair<FName, FString>& A, const TPair<FName, FString>& B)
+	{
+		return SuperManagerAuditSnapshot::NameLess(A.Key, B.Key);
+	});
+	for (TArray<FSuperManagerAuditDuplicate>* Duplicates : {&OutDelta.NewlySimilarTextures, &OutDelta.NewlyDuplicateMeshes, &OutDelta.NewlyDuplicateMaterialInstances})
+	{
+		Duplicates->Sort([](const FSuperManagerAuditDuplicate& A, const FSuperManagerAuditDuplicate& B)
+		{
+			return SuperManagerAuditSnapshot::NameLess(A.PackageName, B.PackageName);
+		});
+	}
+
+	Snapshot.Timestamp = FDateTime::UtcNow();
+}
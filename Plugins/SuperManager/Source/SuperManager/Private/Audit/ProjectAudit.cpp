@@ -0,0 +1,392 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Audit/ProjectAudit.h"
+
+#include "SuperManager.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "References/StringReferenceScanner.h"
+#include "Settings/SuperManagerSettings.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace SuperManagerProjectAudit
+{
+	// JSON 数字是双精度浮点，64位哈希按十六进制字符串存
+	FString HashToString(uint64 Hash)
+	{
+		return FString::Printf(TEXT("%016llx"), Hash);
+	}
+
+	uint64 StringToHash(const FString& HashString)
+	{
+		return FParse::HexNumber64(*HashString);
+	}
+
+	bool NameLess(FName A, FName B)
+	{
+		return A.LexicalLess(B);
+	}
+
+	template <typename ValueType>
+	void SortByPackageName(TArray<TPair<FName, ValueType>>& Pairs)
+	{
+		Pairs.Sort([](const TPair<FName, ValueType>& A, const TPair<FName, ValueType>& B)
+		{
+			return NameLess(A.Key, B.Key);
+		});
+	}
+
+	// 组内按名字排序，各组再按第一个成员排序
+	template <typename ValueType>
+	void CanonicalizeGroups(const TArray<TPair<FName, ValueType>>& Values, const TArray<TArray<int32>>& Groups, TArray<TArray<FName>>& OutGroups)
+	{
+		OutGroups.Reset(Groups.Num());
+		for (const TArray<int32>& Group : Groups)
+		{
+			TArray<FName>& Names = OutGroups.AddDefaulted_GetRef();
+			for (const int32 Index : Group)
+			{
+				Names.Add(Values[Index].Key);
+			}
+			Names.Sort(&NameLess);
+		}
+		OutGroups.Sort([](const TArray<FName>& A, const TArray<FName>& B)
+		{
+			return NameLess(A[0], B[0]);
+		});
+	}
+
+	TArray<TSharedPtr<FJsonValue>> GroupsToJson(const TArray<TArray<FName>>& Groups)
+	{
+		TArray<TSharedPtr<FJsonValue>> GroupValues;
+		for (const TArray<FName>& Group : Groups)
+		{
+			TArray<TSharedPtr<FJsonValue>> MemberValues;
+			for (const FName PackageName : Group)
+			{
+				MemberValues.Add(MakeShared<FJsonValueString>(PackageName.ToString()));
+			}
+			GroupValues.Add(MakeShared<FJsonValueArray>(MemberValues));
+		}
+		return GroupValues;
+	}
+
+	TSharedRef<FJsonObject> FolderSizeToJson(const FSuperManagerAuditFolderSize& FolderSize)
+	{
+		TSharedRef<FJsonObject> FolderObject = MakeShared<FJsonObject>();
+		FolderObject->SetNumberField(TEXT("packages"), FolderSize.NumPackages);
+		FolderObject->SetStringField(TEXT("bytes"), LexToString(FolderSize.Bytes));
+		return FolderObject;
+	}
+
+	TSharedRef<FJsonObject> FolderSizesToJson(const TMap<FString, FSuperManagerAuditFolderSize>& FolderSizes)
+	{
+		TArray<FString> Folders;
+		FolderSizes.GetKeys(Folders);
+		Folders.Sort();
+
+		TSharedRef<FJsonObject> FoldersObject = MakeShared<FJsonObject>();
+		for (const FString& Folder : Folders)
+		{
+			FoldersObject->SetObjectField(Folder, FolderSizeToJson(FolderSizes[Folder]));
+		}
+		return FoldersObject;
+	}
+
+	int64 ParseInt64(const FString& String)
+	{
+		int64 Value = 0;
+		LexFromString(Value, *String);
+		return Value;
+	}
+}
+
+TSharedRef<FJsonObject> FSuperManagerAuditPartial::ToJson() const
+{
+	using namespace SuperManagerProjectAudit;
+	TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+
+	TSharedRef<FJsonObject> UnusedObject = MakeShared<FJsonObject>();
+	for (const TPair<FName, int64>& Unused : UnusedPackages)
+	{
+		UnusedObject->SetStringField(Unused.Key.ToString(), LexToString(Unused.Value));
+	}
+	JsonObject->SetObjectField(TEXT("unused"), UnusedObject);
+
+	TSharedRef<FJsonObject> TextureObject = MakeShared<FJsonObject>();
+	for (const TPair<FName, uint64>& TextureHash : TextureHashes)
+	{
+		TextureObject->SetStringField(TextureHash.Key.ToString(), HashToString(TextureHash.Value));
+	}
+	JsonObject->SetObjectField(TEXT("textureHashes"), TextureObject);
+
+	TSharedRef<FJsonObject> MeshObject = MakeShared<FJsonObject>();
+	for (const TPair<FName, FSuperManagerMeshFingerprint>& Mesh : MeshFingerprints)
+	{
+		TSharedRef<FJsonObject> FingerprintObject = MakeShared<FJsonObject>();
+		FingerprintObject->SetStringField(TEXT("hash"), HashToString(Mesh.Value.GeometryHash));
+		FingerprintObject->SetStringField(TEXT("setupHash"), HashToString(Mesh.Value.SetupHash));
+		FingerprintObject->SetNumberField(TEXT("vertices"), Mesh.Value.NumVertices);
+		FingerprintObject->SetNumberField(TEXT("triangles"), Mesh.Value.NumTriangles);
+		FingerprintObject->SetStringField(TEXT("bytes"), LexToString(Mesh.Value.DiskSize));
+		MeshObject->SetObjectField(Mesh.Key.ToString(), FingerprintObject);
+	}
+	JsonObject->SetObjectField(TEXT("meshFingerprints"), MeshObject);
+
+	TSharedRef<FJsonObject> MaterialInstanceObject = MakeShared<FJsonObject>();
+	for (const TPair<FName, FSuperManagerMaterialInstanceFingerprint>& MaterialInstance : MaterialInstanceFingerprints)
+	{
+		TSharedRef<FJsonObject> FingerprintObject = MakeShared<FJsonObject>();
+		FingerprintObject->SetStringField(TEXT("hash"), HashToString(MaterialInstance.Value.ParameterHash));
+		FingerprintObject->SetBoolField(TEXT("ownPermutations"), MaterialInstance.Value.bHasOwnPermutations);
+		MaterialInstanceObject->SetObjectField(MaterialInstance.Key.ToString(), FingerprintObject);
+	}
+	JsonObject->SetObjectField(TEXT("materialInstanceFingerprints"), MaterialInstanceObject);
+
+	JsonObject->SetObjectField(TEXT("folders"), FolderSizesToJson(FolderSizes));
+	return JsonObject;
+}
+
+bool FSuperManagerAuditPartial::FromJson(const TSharedPtr<FJsonObject>& JsonObject)
+{
+	using namespace SuperManagerProjectAudit;
+
+	const TSharedPtr<FJsonObject>* UnusedObject = nullptr;
+	const TSharedPtr<FJsonObject>* TextureObject = nullptr;
+	const TSharedPtr<FJsonObject>* MeshObject = nullptr;
+	const TSharedPtr<FJsonObject>* MaterialInstanceObject = nullptr;
+	const TSharedPtr<FJsonObject>* FoldersObject = nullptr;
+	if (!JsonObject.IsValid() ||
+		!JsonObject->TryGetObjectField(TEXT("unused"), UnusedObject) ||
+		!JsonObject->TryGetObjectField(TEXT("textureHashes"), TextureObject) ||
+		!JsonObject->TryGetObjectField(TEXT("meshFingerprints"), MeshObject) ||
+		!JsonObject->TryGetObjectField(TEXT("materialInstanceFingerprints"), MaterialInstanceObject) ||
+		!JsonObject->TryGetObjectField(TEXT("folders"), FoldersObject))
+	{
+		return false;
+	}
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*UnusedObject)->Values)
+	{
+		UnusedPackages.Emplace(FName(*Pair.Key), ParseInt64(Pair.Value->AsString()));
+	}
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*TextureObject)->Values)
+	{
+		TextureHashes.Emplace(FName(*Pair.Key), StringToHash(Pair.Value->AsString()));
+	}
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*MeshObject)->Values)
+	{
+		const TSharedPtr<FJsonObject>& FingerprintObject = Pair.Value->AsObject();
+		FSuperManagerMeshFingerprint Fingerprint;
+		Fingerprint.GeometryHash = StringToHash(FingerprintObject->GetStringField(TEXT("hash")));
+		Fingerprint.SetupHash = StringToHash(FingerprintObject->GetStringField(TEXT("setupHash")));
+		Fingerprint.NumVertices = static_cast<int32>(FingerprintObject->GetNumberField(TEXT("vertices")));
+		Fingerprint.NumTriangles = static_cast<int32>(FingerprintObject->GetNumberField(TEXT("triangles")));
+		Fingerprint.DiskSize = ParseInt64(FingerprintObject->GetStringField(TEXT("bytes")));
+		MeshFingerprints.Emplace(FName(*Pair.Key), Fingerprint);
+	}
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*MaterialInstanceObject)->Values)
+	{
+		const TSharedPtr<FJsonObject>& FingerprintObject = Pair.Value->AsObject();
+		FSuperManagerMaterialInstanceFingerprint Fingerprint;
+		Fingerprint.ParameterHash = StringToHash(FingerprintObject->GetStringField(TEXT("hash")));
+		Fingerprint.bHasOwnPermutations = FingerprintObject->GetBoolField(TEXT("ownPermutations"));
+		MaterialInstanceFingerprints.Emplace(FName(*Pair.Key), Fingerprint);
+	}
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*FoldersObject)->Values)
+	{
+		const TSharedPtr<FJsonObject>& FolderObject = Pair.Value->AsObject();
+		FSuperManagerAuditFolderSize& FolderSize = FolderSizes.Add(Pair.Key);
+		FolderSize.NumPackages = static_cast<int32>(FolderObject->GetNumberField(TEXT("packages")));
+		FolderSize.Bytes = ParseInt64(FolderObject->GetStringField(TEXT("bytes")));
+	}
+	return true;
+}
+
+TSharedRef<FJsonObject> FSuperManagerAuditReport::ToJson() const
+{
+	using namespace SuperManagerProjectAudit;
+	TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+	JsonObject->SetStringField(TEXT("root"), Root);
+	JsonObject->SetNumberField(TEXT("packages"), NumPackages);
+	JsonObject->SetStringField(TEXT("bytes"), LexToString(TotalBytes));
+
+	TArray<TSharedPtr<FJsonValue>> UnusedValues;
+	for (const TPair<FName, int64>& Unused : UnusedPackages)
+	{
+		TSharedRef<FJsonObject> UnusedObject = MakeShared<FJsonObject>();
+		UnusedObject->SetStringField(TEXT("package"), Unused.Key.ToString());
+		UnusedObject->SetStringField(TEXT("bytes"), LexToString(Unused.Value));
+		UnusedValues.Add(MakeShared<FJsonValueObject>(UnusedObject));
+	}
+	JsonObject->SetArrayField(TEXT("unused"), UnusedValues);
+	JsonObject->SetStringField(TEXT("unusedBytes"), LexToString(UnusedBytes));
+
+	JsonObject->SetArrayField(TEXT("similarTextureGroups"), GroupsToJson(SimilarTextureGroups));
+	JsonObject->SetArrayField(TEXT("duplicateMeshGroups"), GroupsToJson(DuplicateMeshGroups));
+	JsonObject->SetArrayField(TEXT("duplicateMaterialInstanceGroups"), GroupsToJson(DuplicateMaterialInstanceGroups));
+	JsonObject->SetObjectField(TEXT("folders"), FolderSizesToJson(FolderSizes));
+	return JsonObject;
+}
+
+bool SuperManagerProjectAudit::IsInShard(FName PackageName, int32 ShardIndex, int32 NumShards)
+{
+	if (NumShards <= 1)
+	{
+		return true;
+	}
+	const FString PackageNameString = PackageName.ToString().ToLower();
+	return static_cast<int32>(FCrc::StrCrc32(*PackageNameString) % static_cast<uint32>(NumShards)) == ShardIndex;
+}
+
+void SuperManagerProjectAudit::GatherPartial(const FString& Root, int32 ShardIndex, int32 NumShards, FSuperManagerAuditPartial& OutPartial)
+{
+	check(IsInGameThread());
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+
+	// 不走带缓存的列举入口，那里会修复并保存重定向器，多个进程同时写包会冲突
+	TArray<TSharedPtr<FAssetData>> AllAssets;
+	TMap<FSoftObjectPath, FString> AssetRoots;
+	SuperManagerModule.GatherAssetsUnderFolders({Root}, AllAssets, AssetRoots);
+
+	TArray<TSharedPtr<FAssetData>> ShardAssets;
+	TMap<FName, int64> PackageSizes;
+	for (const TSharedPtr<FAssetData>& AssetData : AllAssets)
+	{
+		if (!IsInShard(AssetData->PackageName, ShardIndex, NumShards))
+		{
+			continue;
+		}
+		ShardAssets.Add(AssetData);
+		if (!PackageSizes.Contains(AssetData->PackageName))
+		{
+			const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(AssetData->PackageName);
+			const int64 DiskSize = PackageData.IsSet() ? FMath::Max<int64>(PackageData->DiskSize, 0) : 0;
+			PackageSizes.Add(AssetData->PackageName, DiskSize);
+
+			FSuperManagerAuditFolderSize& FolderSize = OutPartial.FolderSizes.FindOrAdd(FPackageName::GetLongPackagePath(AssetData->PackageName.ToString()));
+			++FolderSize.NumPackages;
+			FolderSize.Bytes += DiskSize;
+		}
+	}
+
+	SuperManagerModule.GetStringReferenceScanner()->ScanBlocking();
+	TArray<TSharedPtr<FAssetData>> UnusedAssets;
+	SuperManagerModule.ListUnusedAssetsForAssetList(ShardAssets, UnusedAssets);
+	TSet<FName> UnusedPackageNames;
+	for (const TSharedPtr<FAssetData>& AssetData : UnusedAssets)
+	{
+		bool bAlreadyAdded = false;
+		UnusedPackageNames.Add(AssetData->PackageName, &bAlreadyAdded);
+		if (!bAlreadyAdded)
+		{
+			OutPartial.UnusedPackages.Emplace(AssetData->PackageName, PackageSizes.FindRef(AssetData->PackageName));
+		}
+	}
+
+	SuperManagerModule.GetTextureSimilarity()->ComputeBlocking(ShardAssets, OutPartial.TextureHashes);
+	SuperManagerModule.GetMeshDuplicates()->ComputeBlocking(ShardAssets, OutPartial.MeshFingerprints);
+	// 同一父材质的实例会被分到不同分片，按父材质跳过单个实例时必须看整个注册表的计数，不能只看本分片
+	SuperManagerModule.GetMaterialInstanceDuplicates()->ComputeBlocking(ShardAssets, OutPartial.MaterialInstanceFingerprints);
+}
+
+void SuperManagerProjectAudit::Merge(const FString& Root, const TArray<FSuperManagerAuditPartial>& Partials, FSuperManagerAuditReport& OutReport)
+{
+	OutReport = FSuperManagerAuditReport();
+	OutReport.Root = Root;
+
+	FSuperManagerTextureSimilarity::FResults TextureHashes;
+	FSuperManagerMeshDuplicates::FResults MeshFingerprints;
+	FSuperManagerMaterialInstanceDuplicates::FResults MaterialInstanceFingerprints;
+	TMap<FString, FSuperManagerAuditFolderSize> DirectFolderSizes;
+	for (const FSuperManagerAuditPartial& Partial : Partials)
+	{
+		OutReport.UnusedPackages.Append(Partial.UnusedPackages);
+		TextureHashes.Append(Partial.TextureHashes);
+		MeshFingerprints.Append(Partial.MeshFingerprints);
+		MaterialInstanceFingerprints.Append(Partial.MaterialInstanceFingerprints);
+		for (const TPair<FString, FSuperManagerAuditFolderSize>& Pair : Partial.FolderSizes)
+		{
+			FSuperManagerAuditFolderSize& FolderSize = DirectFolderSizes.FindOrAdd(Pair.Key);
+			FolderSize.NumPackages += Pair.Value.NumPackages;
+			FolderSize.Bytes += Pair.Value.Bytes;
+		}
+	}
+
+	// 输入顺序与分片方式无关之后再分组
+	SortByPackageName(OutReport.UnusedPackages);
+	SortByPackageName(TextureHashes);
+	SortByPackageName(MeshFingerprints);
+	SortByPackageName(MaterialInstanceFingerprints);
+
+	for (const TPair<FName, int64>& Unused : OutReport.UnusedPackages)
+	{
+		OutReport.UnusedBytes += Unused.Value;
+	}
+
+	TArray<TArray<int32>> Groups;
+	FSuperManagerTextureSimilarity::GroupNearDuplicates(TextureHashes, USuperManagerSettings::Get()->SimilarTextureMaxDistance, Groups);
+	CanonicalizeGroups(TextureHashes, Groups, OutReport.SimilarTextureGroups);
+	Groups.Reset();
+	FSuperManagerMeshDuplicates::GroupDuplicates(MeshFingerprints, Groups);
+	CanonicalizeGroups(MeshFingerprints, Groups, OutReport.DuplicateMeshGroups);
+	Groups.Reset();
+	FSuperManagerMaterialInstanceDuplicates::GroupDuplicates(MaterialInstanceFingerprints, Groups);
+	CanonicalizeGroups(MaterialInstanceFingerprints, Groups, OutReport.DuplicateMaterialInstanceGroups);
+
+	// 每个目录的大小沿父目录向上累加到根目录为止
+	for (const TPair<FString, FSuperManagerAuditFolderSize>& Pair : DirectFolderSizes)
+	{
+		OutReport.NumPackages += Pair.Value.NumPackages;
+		OutReport.TotalBytes += Pair.Value.Bytes;
+
+		FString Folder = Pair.Key;
+		while (true)
+		{
+			FSuperManagerAuditFolderSize& FolderSize = OutReport.FolderSizes.FindOrAdd(Folder);
+			FolderSize.NumPackages += Pair.Value.NumPackages;
+			FolderSize.Bytes += Pair.Value.Bytes;
+
+			int32 SlashIndex = INDEX_NONE;
+			if (Folder.Equals(Root, ESearchCase::IgnoreCase) || !Folder.FindLastChar(TEXT('/'), SlashIndex) || SlashIndex == 0)
+			{
+				break;
+			}
+			Folder.LeftInline(SlashIndex);
+		}
+	}
+}
+
+FString SuperManagerProjectAudit::ToJsonString(const TSharedRef<FJsonObject>& JsonObject)
+{
+	FString JsonString;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	FJsonSerializer::Serialize(JsonObject, Writer);
+	return JsonString;
+}
+
+bool SuperManagerProjectAudit::SaveJson(const TSharedRef<FJsonObject>& JsonObject, const FString& FilePath)
+{
+	return FFileHelper::SaveStringToFile(ToJsonString(JsonObject), *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+TSharedPtr<FJsonObject> SuperManagerProjectAudit::LoadJson(const FString& FilePath)
+{
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *FilePath))
+	{
+		return nullptr;
+	}
+	TSharedPtr<FJsonObject> JsonObject;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject))
+	{
+		return nullptr;
+	}
+	return JsonObject;
+}
@@ -0,0 +1,324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Audit/SuperManagerAuditCommandlet.h"
+
+#include "Audit/AuditSnapshot.h"
+#include "Audit/ProjectAudit.h"
+#include "SuperManager.h"
+#include "Operations/ListingExport.h"
+#include "Settings/SuperManagerSettings.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace SuperManagerAuditCommandlet
+{
+	FString GetOutputDir()
+	{
+		return FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SuperManager")));
+	}
+}
+
+USuperManagerAuditCommandlet::USuperManagerAuditCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USuperManagerAuditCommandlet::Main(const FString& Params)
+{
+	FString Root = TEXT("/Game");
+	FParse::Value(*Params, TEXT("Root="), Root);
+	Root.RemoveFromEnd(TEXT("/"));
+
+	FString ReportPath = FPaths::Combine(SuperManagerAuditCommandlet::GetOutputDir(), TEXT("AuditReport.json"));
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+
+	int32 NumShards = 0;
+	if (FParse::Value(*Params, TEXT("NumShards="), NumShards))
+	{
+		int32 ShardIndex = 0;
+		FString PartialPath;
+		FParse::Value(*Params, TEXT("Shard="), ShardIndex);
+		FParse::Value(*Params, TEXT("Partial="), PartialPath);
+		return RunWorker(Root, ShardIndex, NumShards, PartialPath);
+	}
+
+	float StartupBudgetMs = USuperManagerSettings::Get()->StartupBudgetMs;
+	if (FParse::Value(*Params, TEXT("CheckStartup="), StartupBudgetMs) || FParse::Param(*Params, TEXT("CheckStartup")))
+	{
+		return RunStartupCheck(StartupBudgetMs);
+	}
+
+	FString ExportPath;
+	if (FParse::Param(*Params, TEXT("Export")) || FParse::Value(*Params, TEXT("Export="), ExportPath))
+	{
+		return RunExport(Root, Params);
+	}
+
+	if (FParse::Param(*Params, TEXT("Diff")))
+	{
+		FString SnapshotPath = FSuperManagerAuditSnapshot::GetDefaultFilePath(Root);
+		FParse::Value(*Params, TEXT("Snapshot="), SnapshotPath);
+		FString DeltaPath = FPaths::Combine(SuperManagerAuditCommandlet::GetOutputDir(), TEXT("AuditDelta.json"));
+		FParse::Value(*Params, TEXT("Report="), DeltaPath);
+		return RunDiff(Root, SnapshotPath, DeltaPath);
+	}
+
+	int32 MaxWorkers = 0;
+	if (FParse::Value(*Params, TEXT("Benchmark="), MaxWorkers))
+	{
+		return RunBenchmark(Root, FMath::Max(MaxWorkers, 1), ReportPath);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	FSuperManagerAuditReport Report;
+	int32 NumWorkers = 0;
+	if (FParse::Value(*Params, TEXT("Workers="), NumWorkers) && NumWorkers > 0)
+	{
+		if (!RunCoordinator(Root, NumWorkers, Report))
+		{
+			return 1;
+		}
+	}
+	else
+	{
+		IAssetRegistry::GetChecked().SearchAllAssets(true);
+		TArray<FSuperManagerAuditPartial> Partials;
+		SuperManagerProjectAudit::GatherPartial(Root, 0, 1, Partials.AddDefaulted_GetRef());
+		SuperManagerProjectAudit::Merge(Root, Partials, Report);
+	}
+
+	if (!SuperManagerProjectAudit::SaveJson(Report.ToJson(), ReportPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SuperManager audit: failed to write %s"), *ReportPath);
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("SuperManager audit: %d packages (%lld bytes), %d unused (%lld bytes), %d/%d/%d duplicate groups in %.1f s -> %s"),
+	       Report.NumPackages, Report.TotalBytes, Report.UnusedPackages.Num(), Report.UnusedBytes, Report.SimilarTextureGroups.Num(),
+	       Report.DuplicateMeshGroups.Num(), Report.DuplicateMaterialInstanceGroups.Num(), FPlatformTime::Seconds() - StartTime, *ReportPath);
+	return 0;
+}
+
+int32 USuperManagerAuditCommandlet::RunStartupCheck(float BudgetMs)
+{
+	// 预算包括 StartupModule 和推迟到内容浏览器加载时注册的菜单扩展，子系统的初始化不计入预算，只打印出来
+	// 命令行默认不加载内容浏览器等编辑器模块，这时菜单扩展测不到，只有带着编辑器模块运行时结果才有意义
+	const FSuperManagerModule& SuperManagerModule = FModuleManager::GetModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	const FSuperManagerStartupStats& Stats = SuperManagerModule.GetStartupStats();
+	for (int32 Index = 0; Index < FSuperManagerStartupStats::NumSubsystems; ++Index)
+	{
+		if (Stats.bSubsystemInitialized[Index])
+		{
+			UE_LOG(LogTemp, Display, TEXT("SuperManager startup check: %s initialized in %.2f ms"),
+			       LexToString(static_cast<ESuperManagerSubsystem>(Index)), Stats.SubsystemMs[Index]);
+		}
+	}
+	if (Stats.bMenuExtensionInitialized)
+	{
+		UE_LOG(LogTemp, Display, TEXT("SuperManager startup check: menu extension %s in %.2f ms"),
+		       Stats.bMenuExtensionDeferred ? TEXT("registered late") : TEXT("registered during StartupModule"), Stats.MenuExtensionMs);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SuperManager startup check: ContentBrowser is not loaded, the menu extension was not measured; run with the editor modules loaded for a meaningful result"));
+	}
+
+	const double BudgetedMs = Stats.GetBudgetedMs();
+	if (BudgetMs > 0.f && BudgetedMs > BudgetMs)
+	{
+		UE_LOG(LogTemp, Error, TEXT("SuperManager startup check: startup took %.2f ms, over the %.2f ms budget"), BudgetedMs, BudgetMs);
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("SuperManager startup check: startup took %.2f ms (budget %.2f ms)"), BudgetedMs, BudgetMs);
+	return 0;
+}
+
+int32 USuperManagerAuditCommandlet::RunWorker(const FString& Root, int32 ShardIndex, int32 NumShards, const FString& PartialPath)
+{
+	IAssetRegistry::GetChecked().SearchAllAssets(true);
+
+	FSuperManagerAuditPartial Partial;
+	SuperManagerProjectAudit::GatherPartial(Root, ShardIndex, NumShards, Partial);
+	if (!SuperManagerProjectAudit::SaveJson(Partial.ToJson(), PartialPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SuperManager audit shard %d/%d: failed to write %s"), ShardIndex, NumShards, *PartialPath);
+		return 1;
+	}
+	return 0;
+}
+
+bool USuperManagerAuditCommandlet::RunCoordinator(const FString& Root, int32 NumWorkers, FSuperManagerAuditReport& OutReport)
+{
+	const FString ShardDir = FPaths::Combine(SuperManagerAuditCommandlet::GetOutputDir(), TEXT("AuditShards"));
+	IFileManager::Get().MakeDirectory(*ShardDir, true);
+
+	// 工作进程与当前进程使用同一个可执行文件和项目，缓存只读，避免多个进程同时写同一个文件
+	const FString ExecutablePath = FPlatformProcess::ExecutablePath();
+	const FString ProjectPath = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+
+	TArray<FProcHandle> Processes;
+	TArray<FString> PartialPaths;
+	for (int32 ShardIndex = 0; ShardIndex < NumWorkers; ++ShardIndex)
+	{
+		const FString PartialPath = FPaths::Combine(ShardDir, FString::Printf(TEXT("Shard_%d_of_%d.json"), ShardIndex, NumWorkers));
+		IFileManager::Get().Delete(*PartialPath, false, true, true);
+		PartialPaths.Add(PartialPath);
+
+		const FString Arguments = FString::Printf(
+			TEXT("\"%s\" -run=SuperManagerAudit -Root=%s -Shard=%d -NumShards=%d -Partial=\"%s\" -SuperManagerReadOnlyCache -unattended -nullrhi -nosplash -nopause -stdout"),
+			*ProjectPath, *Root, ShardIndex, NumWorkers, *PartialPath);
+		FProcHandle Process = FPlatformProcess::CreateProc(*ExecutablePath, *Arguments, false, true, true, nullptr, 0, nullptr, nullptr);
+		if (!Process.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("SuperManager audit: failed to launch worker %d"), ShardIndex);
+		}
+		Processes.Add(Process);
+	}
+
+	bool bAllSucceeded = true;
+	for (int32 ShardIndex = 0; ShardIndex < Processes.Num(); ++ShardIndex)
+	{
+		FProcHandle& Process = Processes[ShardIndex];
+		if (!Process.IsValid())
+		{
+			bAllSucceeded = false;
+			continue;
+		}
+		FPlatformProcess::WaitForProc(Process);
+		int32 ReturnCode = 0;
+		FPlatformProcess::GetProcReturnCode(Process, &ReturnCode);
+		FPlatformProcess::CloseProc(Process);
+		if (ReturnCode != 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("SuperManager audit: worker %d exited with %d"), ShardIndex, ReturnCode);
+			bAllSucceeded = false;
+		}
+	}
+	if (!bAllSucceeded)
+	{
+		return false;
+	}
+
+	TArray<FSuperManagerAuditPartial> Partials;
+	Partials.SetNum(PartialPaths.Num());
+	for (int32 ShardIndex = 0; ShardIndex < PartialPaths.Num(); ++ShardIndex)
+	{
+		if (!Partials[ShardIndex].FromJson(SuperManagerProjectAudit::LoadJson(PartialPaths[ShardIndex])))
+		{
+			UE_LOG(LogTemp, Error, TEXT("SuperManager audit: invalid partial result %s"), *PartialPaths[ShardIndex]);
+			return false;
+		}
+	}
+	SuperManagerProjectAudit::Merge(Root, Partials, OutReport);
+	return true;
+}
+
+int32 USuperManagerAuditCommandlet::RunExport(const FString& Root, const FString& Params)
+{
+	IAssetRegistry::GetChecked().SearchAllAssets(true);
+
+	ESuperManagerListCondition Condition = ESuperManagerListCondition::All;
+	FString ConditionString;
+	if (FParse::Value(*Params, TEXT("Condition="), ConditionString) && !LexTryParseString(Condition, *ConditionString))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SuperManager export: unknown condition %s"), *ConditionString);
+		return 1;
+	}
+	FString FormatString;
+	FParse::Value(*Params, TEXT("Format="), FormatString);
+	const ESuperManagerExportFormat Format = FormatString.Equals(TEXT("Json"), ESearchCase::IgnoreCase)
+		                                         ? ESuperManagerExportFormat::Json
+		                                         : ESuperManagerExportFormat::Csv;
+
+	// 与 Advance Deletion 面板的列举规则相同，但不走带缓存的入口：那里会修复并保存重定向器
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	const TSharedRef<const FSuperManagerAssetList> AssetList = SuperManagerModule.BuildAssetListForFoldersBlocking({Root}, Condition);
+
+	FSuperManagerListingExportRequest Request;
+	Request.FilePath = FPaths::Combine(SuperManagerAuditCommandlet::GetOutputDir(), TEXT("Exports"),
+	                                   FString::Printf(TEXT("%s.%s"), LexToString(Condition), Format == ESuperManagerExportFormat::Json ? TEXT("json") : TEXT("csv")));
+	FParse::Value(*Params, TEXT("Export="), Request.FilePath);
+	Request.Format = Format;
+	Request.Assets = AssetList->Assets;
+	Request.AssetGroups = AssetList->AssetGroups;
+	Request.bGroupBySameName = Condition == ESuperManagerListCondition::SameName;
+	Request.bResume = !FParse::Param(*Params, TEXT("Restart"));
+
+	const FSuperManagerListingExportResult Result = SuperManagerListingExport::RunBlocking(Request);
+	UE_LOG(LogTemp, Display, TEXT("SuperManager export: %s"), *Result.ToString());
+	return Result.bSucceeded ? 0 : 1;
+}
+
+int32 USuperManagerAuditCommandlet::RunDiff(const FString& Root, const FString& SnapshotPath, const FString& ReportPath)
+{
+	IAssetRegistry::GetChecked().SearchAllAssets(true);
+
+	// 没有快照(或根目录不同)时从空快照开始，相当于一次全量审计
+	const double StartTime = FPlatformTime::Seconds();
+	FSuperManagerAuditSnapshot Snapshot;
+	if (!Snapshot.Load(SnapshotPath) || !Snapshot.Root.Equals(Root, ESearchCase::IgnoreCase))
+	{
+		UE_LOG(LogTemp, Display, TEXT("SuperManager audit: no snapshot for %s, running a full audit"), *Root);
+		Snapshot = FSuperManagerAuditSnapshot();
+		Snapshot.Root = Root;
+	}
+
+	FSuperManagerAuditDelta Delta;
+	SuperManagerAuditSnapshot::Update(Snapshot, Delta);
+	if (!Snapshot.Save(SnapshotPath) || !SuperManagerProjectAudit::SaveJson(Delta.ToJson(), ReportPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("SuperManager audit: failed to write %s or %s"), *SnapshotPath, *ReportPath);
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("SuperManager audit: %d added, %d modified, %d removed, %d re-evaluated; %d newly unused, %d/%d/%d newly duplicated, %d naming violations in %.1f s -> %s"),
+	       Delta.AddedPackages.Num(), Delta.ModifiedPackages.Num(), Delta.RemovedPackages.Num(), Delta.NumReevaluated, Delta.NewlyUnused.Num(),
+	       Delta.NewlySimilarTextures.Num(), Delta.NewlyDuplicateMeshes.Num(), Delta.NewlyDuplicateMaterialInstances.Num(),
+	       Delta.NewNamingViolations.Num(), FPlatformTime::Seconds() - StartTime, *ReportPath);
+	return 0;
+}
+
+int32 USuperManagerAuditCommandlet::RunBenchmark(const FString& Root, int32 MaxWorkers, const FString& ReportPath)
+{
+	// 一个工作进程的结果就是单进程结果，其余每一档都要与它逐字节一致
+	FString BaselineJson;
+	double BaselineSeconds = 0.0;
+	TArray<FString> CsvLines;
+	CsvLines.Add(TEXT("Workers,Seconds,Speedup,MatchesSingleProcess"));
+
+	bool bAllMatched = true;
+	for (int32 NumWorkers = 1; NumWorkers <= MaxWorkers; ++NumWorkers)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		FSuperManagerAuditReport Report;
+		if (!RunCoordinator(Root, NumWorkers, Report))
+		{
+			return 1;
+		}
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		const FString ReportJson = SuperManagerProjectAudit::ToJsonString(Report.ToJson());
+		if (NumWorkers == 1)
+		{
+			BaselineJson = ReportJson;
+			BaselineSeconds = Seconds;
+			FFileHelper::SaveStringToFile(ReportJson, *ReportPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+		}
+
+		const bool bMatches = ReportJson == BaselineJson;
+		bAllMatched &= bMatches;
+		const double Speedup = Seconds > 0.0 ? BaselineSeconds / Seconds : 0.0;
+		CsvLines.Add(FString::Printf(TEXT("%d,%.2f,%.2f,%s"), NumWorkers, Seconds, Speedup, bMatches ? TEXT("true") : TEXT("false")));
+		UE_LOG(LogTemp, Display, TEXT("SuperManager audit benchmark: %2d workers %8.2f s  x%.2f  %s"),
+		       NumWorkers, Seconds, Speedup, bMatches ? TEXT("match") : TEXT("MISMATCH"));
+	}
+
+	const FString CsvPath = FPaths::Combine(SuperManagerAuditCommandlet::GetOutputDir(), TEXT("AuditBenchmark.csv"));
+	FFileHelper::SaveStringArrayToFile(CsvLines, *CsvPath);
+	UE_LOG(LogTemp, Display, TEXT("SuperManager audit benchmark written to %s"), *CsvPath);
+	return bAllMatched ? 0 : 1;
+}
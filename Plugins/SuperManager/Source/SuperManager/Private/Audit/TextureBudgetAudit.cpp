@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Audit/TextureBudgetAudit.h"
+
+#include "Async/ParallelFor.h"
+#include "AssetIndex/FolderTrie.h"
+#include "Engine/Texture2D.h"
+#include "Settings/SuperManagerSettings.h"
+
+namespace SuperManagerTextureBudgetAudit
+{
+	const FName DimensionsTag(TEXT("Dimensions"));
+	const FName HasAlphaChannelTag(TEXT("HasAlphaChannel"));
+	const FName CompressionSettingsTag(TEXT("CompressionSettings"));
+	const FName LODGroupTag(TEXT("LODGroup"));
+	const FName MipGenSettingsTag(TEXT("MipGenSettings"));
+
+	// 压缩设置对应的桌面平台格式，每像素字节数
+	struct FCompressionInfo
+	{
+		const TCHAR* Name;
+		float BytesPerPixel;
+		// 是否应当换成块压缩格式
+		bool bUncompressed;
+	};
+
+	const FCompressionInfo CompressionInfos[] = {
+		{TEXT("TC_Normalmap"), 1.f, false},
+		{TEXT("TC_Grayscale"), 1.f, true},
+		{TEXT("TC_Displacementmap"), 1.f, false},
+		{TEXT("TC_VectorDisplacementmap"), 4.f, true},
+		{TEXT("TC_HDR"), 8.f, true},
+		{TEXT("TC_EditorIcon"), 4.f, true},
+		{TEXT("TC_Alpha"), 0.5f, false},
+		{TEXT("TC_DistanceFieldFont"), 1.f, false},
+		{TEXT("TC_HDR_Compressed"), 1.f, false},
+		{TEXT("TC_BC7"), 1.f, false},
+		{TEXT("TC_HalfFloat"), 2.f, true},
+		{TEXT("TC_LQ"), 2.f, false},
+		{TEXT("TC_EncodedReflectionCapture"), 1.f, false},
+		{TEXT("TC_SingleFloat"), 4.f, true},
+		{TEXT("TC_HDR_F32"), 16.f, true},
+	};
+
+	// 改用块压缩后的大小：单通道用BC4，其余用BC7/BC6H
+	float GetCompressedBytesPerPixel(const FString& CompressionSettings)
+	{
+		return CompressionSettings == TEXT("TC_Grayscale") ? 0.5f : 1.f;
+	}
+
+	int64 EstimateBytes(int32 Width, int32 Height, float BytesPerPixel, bool bHasMips)
+	{
+		// 完整mip链约为最高一级的4/3
+		const double TopMipBytes = static_cast<double>(Width) * Height * BytesPerPixel;
+		return static_cast<int64>(bHasMips ? TopMipBytes * 4.0 / 3.0 : TopMipBytes);
+	}
+
+	bool ParseDimensions(const FString& Dimensions, int32& OutWidth, int32& OutHeight)
+	{
+		FString WidthString;
+		FString HeightString;
+		if (!Dimensions.Split(TEXT("x"), &WidthString, &HeightString))
+		{
+			return false;
+		}
+		OutWidth = FCString::Atoi(*WidthString);
+		OutHeight = FCString::Atoi(*HeightString);
+		return OutWidth > 0 && OutHeight > 0;
+	}
+}
+
+FSuperManagerTextureBudgetAudit::FSuperManagerTextureBudgetAudit()
+{
+	const USuperManagerSettings* Settings = USuperManagerSettings::Get();
+	DefaultMaxDimension = Settings->DefaultTextureMaxDimension;
+	for (const FSuperManagerTextureBudget& Budget : Settings->TextureBudgets)
+	{
+		FString Folder = Budget.Folder;
+		Folder.RemoveFromEnd(TEXT("/"));
+		if (!Folder.IsEmpty())
+		{
+			FolderBudgets.Emplace(MoveTemp(Folder), Budget.MaxDimension);
+		}
+	}
+	FolderBudgets.StableSort([](const TPair<FString, int32>& A, const TPair<FString, int32>& B)
+	{
+		return A.Key.Len() > B.Key.Len();
+	});
+}
+
+int32 FSuperManagerTextureBudgetAudit::GetMaxDimension(FName PackageName) const
+{
+	TStringBuilder<256> PackageNameString;
+	PackageName.AppendString(PackageNameString);
+	for (const TPair<FString, int32>& Budget : FolderBudgets)
+	{
+		if (FSuperManagerFolderTrie::IsPathUnderRoot(PackageNameString.ToView(), Budget.Key))
+		{
+			return Budget.Value;
+		}
+	}
+	return DefaultMaxDimension;
+}
+
+bool FSuperManagerTextureBudgetAudit::Evaluate(const FAssetData& AssetData, FSuperManagerTextureAuditEntry& OutEntry) const
+{
+	using namespace SuperManagerTextureBudgetAudit;
+
+	if (AssetData.AssetClassPath != UTexture2D::StaticClass()->GetClassPathName())
+	{
+		return false;
+	}
+	FString Dimensions;
+	if (!AssetData.GetTagValue(DimensionsTag, Dimensions) || !ParseDimensions(Dimensions, OutEntry.Width, OutEntry.Height))
+	{
+		return false;
+	}
+
+	FString LODGroup;
+	FString MipGenSettings;
+	bool bHasAlphaChannel = false;
+	AssetData.GetTagValue(CompressionSettingsTag, OutEntry.CompressionSettings);
+	AssetData.GetTagValue(LODGroupTag, LODGroup);
+	AssetData.GetTagValue(MipGenSettingsTag, MipGenSettings);
+	AssetData.GetTagValue(HasAlphaChannelTag, bHasAlphaChannel);
+
+	// UI贴图不流送也不需要mip，尺寸和未压缩都是有意为之
+	const bool bIsUI = LODGroup == TEXT("TEXTUREGROUP_UI");
+	const bool bPowerOfTwo = FMath::IsPowerOfTwo(OutEntry.Width) && FMath::IsPowerOfTwo(OutEntry.Height);
+	const bool bMipsDisabled = MipGenSettings == TEXT("TMGS_NoMipmaps");
+	const bool bHasMips = bPowerOfTwo && !bMipsDisabled;
+
+	// 未知设置(TC_Default、TC_Masks等)按DXT1/DXT5估算
+	float BytesPerPixel = bHasAlphaChannel ? 1.f : 0.5f;
+	bool bUncompressed = false;
+	for (const FCompressionInfo& Info : CompressionInfos)
+	{
+		if (OutEntry.CompressionSettings == Info.Name)
+		{
+			BytesPerPixel = Info.BytesPerPixel;
+			bUncompressed = Info.bUncompressed;
+			break;
+		}
+	}
+
+	OutEntry.MaxDimension = GetMaxDimension(AssetData.PackageName);
+	OutEntry.Issues = ESuperManagerTextureIssues::None;
+	const int32 LongestEdge = FMath::Max(OutEntry.Width, OutEntry.Height);
+	if (LongestEdge > OutEntry.MaxDimension)
+	{
+		OutEntry.Issues |= ESuperManagerTextureIssues::OverBudget;
+	}
+	if (!bPowerOfTwo && !bIsUI)
+	{
+		OutEntry.Issues |= ESuperManagerTextureIssues::NonPowerOfTwo;
+	}
+	if (bMipsDisabled && !bIsUI)
+	{
+		OutEntry.Issues |= ESuperManagerTextureIssues::NoMips;
+	}
+	if (bUncompressed && !bIsUI)
+	{
+		OutEntry.Issues |= ESuperManagerTextureIssues::Uncompressed;
+	}
+
+	// 可节省的部分：每超出一倍就少一级mip，未压缩的换成块压缩
+	int32 TargetWidth = OutEntry.Width;
+	int32 TargetHeight = OutEntry.Height;
+	while (FMath::Max(TargetWidth, TargetHeight) > OutEntry.MaxDimension && FMath::Min(TargetWidth, TargetHeight) > 1)
+	{
+		TargetWidth = FMath::Max(TargetWidth / 2, 1);
+		TargetHeight = FMath::Max(TargetHeight / 2, 1);
+	}
+	const float TargetBytesPerPixel = EnumHasAnyFlags(OutEntry.Issues, ESuperManagerTextureIssues::Uncompressed)
+		                                  ? GetCompressedBytesPerPixel(OutEntry.CompressionSettings)
+		                                  : BytesPerPixel;
+	OutEntry.EstimatedBytes = EstimateBytes(OutEntry.Width, OutEntry.Height, BytesPerPixel, bHasMips);
+	OutEntry.SavableBytes = FMath::Max<int64>(
+		OutEntry.EstimatedBytes - EstimateBytes(TargetWidth, TargetHeight, TargetBytesPerPixel, bHasMips), 0);
+	return true;
+}
+
+void FSuperManagerTextureBudgetAudit::Run(const TArray<TSharedPtr<FAssetData>>& Assets, FResults& OutResults) const
+{
+	OutResults.Reset();
+
+	TArray<FSuperManagerTextureAuditEntry> Entries;
+	Entries.SetNum(Assets.Num());
+	TArray<bool> Flagged;
+	Flagged.SetNumZeroed(Assets.Num());
+	ParallelFor(Assets.Num(), [this, &Assets, &Entries, &Flagged](int32 Index)
+	{
+		Flagged[Index] = Evaluate(*Assets[Index], Entries[Index]) && Entries[Index].Issues != ESuperManagerTextureIssues::None;
+	});
+
+	for (int32 Index = 0; Index < Assets.Num(); ++Index)
+	{
+		if (Flagged[Index])
+		{
+			OutResults.Emplace(Assets[Index]->PackageName, MoveTemp(Entries[Index]));
+		}
+	}
+	OutResults.StableSort([](const TPair<FName, FSuperManagerTextureAuditEntry>& A, const TPair<FName, FSuperManagerTextureAuditEntry>& B)
+	{
+		return A.Value.SavableBytes > B.Value.SavableBytes;
+	});
+}
+
+FString FSuperManagerTextureBudgetAudit::Describe(const FSuperManagerTextureAuditEntry& Entry)
+{
+	TArray<FString> Parts;
+	Parts.Add(EnumHasAnyFlags(Entry.Issues, ESuperManagerTextureIssues::OverBudget)
+		          ? FString::Printf(TEXT("%dx%d > %d"), Entry.Width, Entry.Height, Entry.MaxDimension)
+		          : FString::Printf(TEXT("%dx%d"), Entry.Width, Entry.Height));
+	if (EnumHasAnyFlags(Entry.Issues, ESuperManagerTextureIssues::NonPowerOfTwo))
+	{
+		Parts.Add(TEXT("非2的幂(无法流送)"));
+	}
+	if (EnumHasAnyFlags(Entry.Issues, ESuperManagerTextureIssues::NoMips))
+	{
+		Parts.Add(TEXT("无Mip"));
+	}
+	if (EnumHasAnyFlags(Entry.Issues, ESuperManagerTextureIssues::Uncompressed))
+	{
+		Parts.Add(FString::Printf(TEXT("未压缩(%s)"), *Entry.CompressionSettings));
+	}
+	if (Entry.SavableBytes > 0)
+	{
+		Parts.Add(FString::Printf(TEXT("可节省 %s"), *FText::AsMemory(Entry.SavableBytes).ToString()));
+	}
+	return FString::Join(Parts, TEXT(", "));
+}
@@ -0,0 +1,304 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Operations/BatchConsolidation.h"
+
+#include "AssetToolsModule.h"
+#include "FileHelpers.h"
+#include "ObjectTools.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "References/StringReferenceScanner.h"
+#include "Serialization/ArchiveReplaceObjectRef.h"
+#include "Serialization/FindReferencersArchive.h"
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/UObjectHash.h"
+
+FString FSuperManagerConsolidationReport::ToString() const
+{
+	FString Result = FString::Printf(TEXT("合并 %d 组，改写 %d 个引用包(保存 %d 个)，删除 %d 个重复资产\n")
+	                                 TEXT("收集 %.2fs / 加载 %.2fs / 替换 %.2fs / 保存 %.2fs / 删除 %.2fs"),
+	                                 NumGroups, NumReferencerPackages, NumPackagesSaved, NumDuplicatesDeleted,
+	                                 GatherSeconds, LoadSeconds, ReplaceSeconds, SaveSeconds, DeleteSeconds);
+	if (FailedGroups.Num() > 0)
+	{
+		Result += FString::Printf(TEXT("\n%d 组有引用包加载或保存失败，没有删除重复资产："), FailedGroups.Num());
+		for (const FName Keeper : FailedGroups)
+		{
+			Result += TEXT("\n") + Keeper.ToString();
+		}
+	}
+	if (StringReferencedDuplicates.Num() > 0)
+	{
+		Result += FString::Printf(TEXT("\n%d 个重复资产被文本文件引用，已保留："), StringReferencedDuplicates.Num());
+		for (const FName Duplicate : StringReferencedDuplicates)
+		{
+			Result += TEXT("\n") + Duplicate.ToString();
+		}
+	}
+	return Result;
+}
+
+namespace SuperManagerBatchConsolidation
+{
+	struct FState
+	{
+		TArray<FSuperManagerConsolidationGroup> Groups;
+		TArray<FName> ReferencerPackageNames;
+		// 引用包 -> 它引用了哪些组的重复资产
+		TMap<FName, TArray<int32>> ReferencerGroups;
+		// 有引用包加载或保存失败的组，其重复资产不能删除，否则磁盘上的包会指向已删除的资产
+		TSet<int32> FailedGroups;
+		FOnConsolidationFinished OnFinished;
+		FSuperManagerConsolidationReport Report;
+		double PhaseStartTime = 0.0;
+
+		int32 NextGroup = 0;
+		int32 NextReferencer = 0;
+		int32 NextReplace = 0;
+
+		// 替换和删除完成之前，参与的对象不能被GC
+		TArray<TStrongObjectPtr<UObject>> PinnedObjects;
+		TArray<TStrongObjectPtr<UPackage>> ReferencerPackages;
+		TArray<UObject*> DuplicateObjects;
+		// 与 DuplicateObjects 一一对应
+		TArray<int32> DuplicateGroupIndices;
+		TMap<UObject*, UObject*> ReplacementMap;
+		TMap<FSoftObjectPath, FSoftObjectPath> SoftObjectRedirects;
+
+		void FailGroupsOf(FName ReferencerPackage)
+		{
+			if (const TArray<int32>* GroupIndices = ReferencerGroups.Find(ReferencerPackage))
+			{
+				FailedGroups.Append(*GroupIndices);
+			}
+		}
+
+		double EndPhase()
+		{
+			const double Now = FPlatformTime::Seconds();
+			const double Elapsed = Now - PhaseStartTime;
+			PhaseStartTime = Now;
+			return Elapsed;
+		}
+	};
+
+	// 一次只加载一组(保留项+重复项)，建立替换表
+	bool LoadGroupStage(FState& State)
+	{
+		if (State.NextGroup < State.Groups.Num())
+		{
+			const int32 GroupIndex = State.NextGroup++;
+			const FSuperManagerConsolidationGroup& Group = State.Groups[GroupIndex];
+			UObject* Keeper = Group.Keeper.GetAsset();
+			if (Keeper)
+			{
+				State.PinnedObjects.Emplace(Keeper);
+				for (const FAssetData& DuplicateData : Group.Duplicates)
+				{
+					UObject* Duplicate = DuplicateData.GetAsset();
+					if (!Duplicate || Duplicate == Keeper || Duplicate->GetClass() != Keeper->GetClass())
+					{
+						continue;
+					}
+					State.PinnedObjects.Emplace(Duplicate);
+					State.DuplicateObjects.Add(Duplicate);
+					State.DuplicateGroupIndices.Add(GroupIndex);
+					State.ReplacementMap.Add(Duplicate, Keeper);
+					State.SoftObjectRedirects.Add(FSoftObjectPath(Duplicate), FSoftObjectPath(Keeper));
+				}
+			}
+		}
+		return State.NextGroup >= State.Groups.Num();
+	}
+
+	// 一次只加载一个引用包
+	bool LoadReferencerStage(FState& State)
+	{
+		if (State.NextReferencer < State.ReferencerPackageNames.Num())
+		{
+			const FName PackageName = State.ReferencerPackageNames[State.NextReferencer++];
+			if (UPackage* Package = LoadPackage(nullptr, *PackageName.ToString(), LOAD_None))
+			{
+				State.ReferencerPackages.Emplace(Package);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("SuperManager consolidation failed to load referencer %s"), *PackageName.ToString());
+				State.FailGroupsOf(PackageName);
+			}
+		}
+		if (State.NextReferencer < State.ReferencerPackageNames.Num())
+		{
+			return false;
+		}
+		State.Report.LoadSeconds = State.EndPhase();
+		return true;
+	}
+
+	// 一次处理一个引用包里的所有对象
+	bool ReplaceStage(FState& State)
+	{
+		if (State.NextReplace < State.ReferencerPackages.Num())
+		{
+			UPackage* Package = State.ReferencerPackages[State.NextReplace++].Get();
+			bool bPackageChanged = false;
+			ForEachObjectWithPackage(Package, [&State, &bPackageChanged](UObject* Object)
+			{
+				// 先查找，真正引用了重复资产的对象才走编辑通知和替换
+				FFindReferencersArchive FindReferencesAr(Object, State.DuplicateObjects);
+				TMap<UObject*, int32> ReferenceCounts;
+				if (FindReferencesAr.GetReferenceCounts(ReferenceCounts) == 0)
+				{
+					return true;
+				}
+
+				Object->PreEditChange(nullptr);
+				FArchiveReplaceObjectRef<UObject> ReplaceAr(Object, State.ReplacementMap,
+					EArchiveReplaceObjectFlags::IgnoreOuterRef | EArchiveReplaceObjectFlags::IgnoreArchetypeRef);
+				Object->PostEditChange();
+				bPackageChanged = true;
+				return true;
+			});
+			if (bPackageChanged)
+			{
+				Package->MarkPackageDirty();
+			}
+		}
+		if (State.NextReplace < State.ReferencerPackages.Num())
+		{
+			return false;
+		}
+
+		// 软引用(配置、软指针)一次性重定向
+		TArray<UPackage*> PackagesToCheck;
+		for (const TStrongObjectPtr<UPackage>& Package : State.ReferencerPackages)
+		{
+			PackagesToCheck.Add(Package.Get());
+		}
+		FAssetToolsModule::GetModule().Get().RenameReferencingSoftObjectPaths(PackagesToCheck, State.SoftObjectRedirects);
+
+		State.Report.ReplaceSeconds = State.EndPhase();
+		return true;
+	}
+
+	bool SaveStage(FState& State)
+	{
+		TArray<UPackage*> PackagesToSave;
+		for (const TStrongObjectPtr<UPackage>& Package : State.ReferencerPackages)
+		{
+			if (Package->IsDirty())
+			{
+				PackagesToSave.Add(Package.Get());
+			}
+		}
+		if (PackagesToSave.Num() > 0)
+		{
+			UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, true);
+			// 保存成功的包会清掉脏标记，仍然是脏的就是没保存上
+			for (UPackage* Package : PackagesToSave)
+			{
+				if (Package->IsDirty())
+				{
+					UE_LOG(LogTemp, Warning, TEXT("SuperManager consolidation failed to save referencer %s"), *Package->GetName());
+					State.FailGroupsOf(Package->GetFName());
+				}
+				else
+				{
+					++State.Report.NumPackagesSaved;
+				}
+			}
+		}
+		State.Report.SaveSeconds = State.EndPhase();
+		return true;
+	}
+
+	bool DeleteStage(FState& State)
+	{
+		// 引用已经全部改掉，放开持有后直接删除，不再弹引用替换对话框
+		TArray<UObject*> ObjectsToDelete;
+		for (int32 Index = 0; Index < State.DuplicateObjects.Num(); ++Index)
+		{
+			if (!State.FailedGroups.Contains(State.DuplicateGroupIndices[Index]))
+			{
+				ObjectsToDelete.Add(State.DuplicateObjects[Index]);
+			}
+		}
+		for (const int32 GroupIndex : State.FailedGroups)
+		{
+			State.Report.FailedGroups.Add(State.Groups[GroupIndex].Keeper.PackageName);
+		}
+		State.DuplicateObjects.Empty();
+		State.ReplacementMap.Empty();
+		State.PinnedObjects.Empty();
+		State.ReferencerPackages.Empty();
+		if (ObjectsToDelete.Num() > 0)
+		{
+			State.Report.NumDuplicatesDeleted = ObjectTools::ForceDeleteObjects(ObjectsToDelete, false);
+		}
+		State.Report.DeleteSeconds = State.EndPhase();
+
+		UE_LOG(LogTemp, Display, TEXT("SuperManager batch consolidation: %s"), *State.Report.ToString());
+		State.OnFinished.ExecuteIfBound(State.Report);
+		return true;
+	}
+}
+
+void SuperManagerBatchConsolidation::Run(FSuperManagerTaskScheduler& TaskScheduler, const TArray<FSuperManagerConsolidationGroup>& Groups,
+                                         const TSharedRef<const FSuperManagerStringReferenceScanner>& StringReferenceScanner,
+                                         const FSuperManagerCancellationTokenRef& Token, FOnConsolidationFinished OnFinished)
+{
+	const TSharedRef<FState> State = MakeShared<FState>();
+	State->Groups = Groups;
+	State->OnFinished = MoveTemp(OnFinished);
+	State->Report.NumGroups = Groups.Num();
+	State->PhaseStartTime = FPlatformTime::Seconds();
+
+	// 收集：所有重复资产引用者的并集，重复资产自身不需要改写
+	TaskScheduler.LaunchWorker(TEXT("SuperManager.GatherConsolidationReferencers"), [&TaskScheduler, State, StringReferenceScanner, Token](const FSuperManagerCancellationToken&)
+	{
+		const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+		TMap<FName, int32> DuplicatePackages;
+		for (int32 GroupIndex = 0; GroupIndex < State->Groups.Num(); ++GroupIndex)
+		{
+			// 写死在配置或代码里的路径改不到，删掉后那里就指向不存在的资产
+			State->Groups[GroupIndex].Duplicates.RemoveAll([&State, &StringReferenceScanner](const FAssetData& DuplicateData)
+			{
+				if (StringReferenceScanner->IsReferenced(DuplicateData.PackageName))
+				{
+					State->Report.StringReferencedDuplicates.Add(DuplicateData.PackageName);
+					return true;
+				}
+				return false;
+			});
+			for (const FAssetData& DuplicateData : State->Groups[GroupIndex].Duplicates)
+			{
+				DuplicatePackages.Add(DuplicateData.PackageName, GroupIndex);
+			}
+		}
+
+		TSet<FName> ReferencerPackages;
+		TArray<FName> Referencers;
+		for (const TPair<FName, int32>& DuplicatePackage : DuplicatePackages)
+		{
+			Referencers.Reset();
+			AssetRegistry.GetReferencers(DuplicatePackage.Key, Referencers);
+			for (const FName Referencer : Referencers)
+			{
+				if (!DuplicatePackages.Contains(Referencer))
+				{
+					ReferencerPackages.Add(Referencer);
+					State->ReferencerGroups.FindOrAdd(Referencer).AddUnique(DuplicatePackage.Value);
+				}
+			}
+		}
+		State->ReferencerPackageNames = ReferencerPackages.Array();
+		State->Report.NumReferencerPackages = State->ReferencerPackageNames.Num();
+		State->Report.GatherSeconds = State->EndPhase();
+
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ConsolidationLoadGroups"), [State]() { return LoadGroupStage(*State); }, Token);
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ConsolidationLoadReferencers"), [State]() { return LoadReferencerStage(*State); }, Token);
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ConsolidationReplace"), [State]() { return ReplaceStage(*State); }, Token);
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ConsolidationSave"), [State]() { return SaveStage(*State); }, Token);
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ConsolidationDelete"), [State]() { return DeleteStage(*State); }, Token);
+	}, Token, ESuperManagerTaskPriority::High);
+}
@@ -0,0 +1,259 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Operations/ListingExport.h"
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace SuperManagerListingExport
+{
+	FString GetProgressFilePath(const FString& FilePath)
+	{
+		return FilePath + TEXT(".progress");
+	}
+
+	// 列表或格式变了之后旧的进度作废
+	uint32 ComputeListingFingerprint(const FSuperManagerListingExportRequest& Request)
+	{
+		uint32 Crc = FCrc::TypeCrc32(static_cast<uint8>(Request.Format));
+		Crc = FCrc::TypeCrc32(Request.Assets.Num(), Crc);
+		// FName 的哈希每次启动编辑器都不同，按字符串计算才能跨会话续传
+		for (const TSharedPtr<FAssetData>& AssetData : Request.Assets)
+		{
+			Crc = FCrc::StrCrc32(*WriteToString<256>(AssetData->PackageName, TEXT("."), AssetData->AssetName), Crc);
+		}
+		return Crc;
+	}
+
+	struct FProgress
+	{
+		uint32 Fingerprint = 0;
+		int32 NextRow = 0;
+		int64 FileSize = 0;
+	};
+
+	bool LoadProgress(const FString& FilePath, FProgress& OutProgress)
+	{
+		FString ProgressString;
+		if (!FFileHelper::LoadFileToString(ProgressString, *GetProgressFilePath(FilePath)))
+		{
+			return false;
+		}
+		TArray<FString> Fields;
+		ProgressString.TrimStartAndEnd().ParseIntoArray(Fields, TEXT(" "));
+		if (Fields.Num() != 3)
+		{
+			return false;
+		}
+		LexFromString(OutProgress.Fingerprint, *Fields[0]);
+		LexFromString(OutProgress.NextRow, *Fields[1]);
+		LexFromString(OutProgress.FileSize, *Fields[2]);
+		return true;
+	}
+
+	bool SaveProgress(const FString& FilePath, const FProgress& Progress)
+	{
+		const FString ProgressString = FString::Printf(TEXT("%u %d %lld"), Progress.Fingerprint, Progress.NextRow, Progress.FileSize);
+		return FFileHelper::SaveStringToFile(ProgressString, *GetProgressFilePath(FilePath));
+	}
+
+	void AppendCsvField(FString& Chunk, const FString& Field)
+	{
+		int32 Index = INDEX_NONE;
+		if (!Field.FindChar(TEXT(','), Index) && !Field.FindChar(TEXT('"'), Index) && !Field.FindChar(TEXT('\n'), Index))
+		{
+			Chunk += Field;
+			return;
+		}
+		Chunk += TEXT('"');
+		Chunk += Field.Replace(TEXT("\""), TEXT("\"\""));
+		Chunk += TEXT('"');
+	}
+
+	void AppendJsonString(FString& Chunk, const FString& Value)
+	{
+		Chunk += TEXT('"');
+		for (const TCHAR Char : Value)
+		{
+			switch (Char)
+			{
+			case TEXT('"'): Chunk += TEXT("\\\""); break;
+			case TEXT('\\'): Chunk += TEXT("\\\\"); break;
+			case TEXT('\n'): Chunk += TEXT("\\n"); break;
+			case TEXT('\r'): Chunk += TEXT("\\r"); break;
+			case TEXT('\t'): Chunk += TEXT("\\t"); break;
+			default: Chunk += Char; break;
+			}
+		}
+		Chunk += TEXT('"');
+	}
+
+	void WriteChunk(FArchive& Writer, const FString& Chunk)
+	{
+		const FTCHARToUTF8 Utf8(*Chunk, Chunk.Len());
+		Writer.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+FString FSuperManagerListingExportResult::ToString() const
+{
+	if (bCancelled)
+	{
+		return FString::Printf(TEXT("导出已暂停，已写入 %d 行，再次导出同一列表会从中断处继续\n%s"), NumRowsWritten, *FilePath);
+	}
+	if (!bSucceeded)
+	{
+		return FString::Printf(TEXT("导出失败: %s"), *Error);
+	}
+	return FirstRow > 0
+		       ? FString::Printf(TEXT("从第 %d 行继续导出，共 %d 行\n%s"), FirstRow + 1, NumRowsWritten, *FilePath)
+		       : FString::Printf(TEXT("已导出 %d 行\n%s"), NumRowsWritten, *FilePath);
+}
+
+void SuperManagerListingExport::Run(FSuperManagerTaskScheduler& TaskScheduler, FSuperManagerListingExportRequest&& Request,
+                                    const FSuperManagerCancellationTokenRef& Token, FOnListingExportFinished OnFinished)
+{
+	// 调度器会直接丢弃已取消的任务，这里用独立的令牌保证取消后也能回调(报告已写入的进度)
+	const FSuperManagerCancellationTokenRef TaskToken = FSuperManagerTaskScheduler::MakeToken();
+	TWeakPtr<FSuperManagerTaskScheduler> WeakScheduler = TaskScheduler.AsShared();
+	TaskScheduler.LaunchWorker(TEXT("SuperManager.ExportListing"),
+		[WeakScheduler, Request = MoveTemp(Request), Token, TaskToken, OnFinished](const FSuperManagerCancellationToken&)
+		{
+			FSuperManagerListingExportResult Result = RunBlocking(Request, &Token.Get());
+			if (const TSharedPtr<FSuperManagerTaskScheduler> Scheduler = WeakScheduler.Pin())
+			{
+				Scheduler->EnqueueGameThreadStage(TEXT("SuperManager.ExportListingFinished"), [Result = MoveTemp(Result), OnFinished]()
+				{
+					OnFinished.ExecuteIfBound(Result);
+					return true;
+				}, TaskToken, ESuperManagerTaskPriority::High);
+			}
+		}, TaskToken, ESuperManagerTaskPriority::Background);
+}
+
+FSuperManagerListingExportResult SuperManagerListingExport::RunBlocking(const FSuperManagerListingExportRequest& Request,
+                                                                        const FSuperManagerCancellationToken* Token)
+{
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+	FSuperManagerListingExportResult Result;
+	Result.FilePath = FPaths::ConvertRelativePathToFull(Request.FilePath);
+	const bool bJson = Request.Format == ESuperManagerExportFormat::Json;
+
+	// 只有上次的进度与列表相符、文件长度也正好停在记录的位置时才续传
+	FProgress Progress;
+	Progress.Fingerprint = ComputeListingFingerprint(Request);
+	FProgress SavedProgress;
+	const bool bResume = Request.bResume && LoadProgress(Request.FilePath, SavedProgress) &&
+		SavedProgress.Fingerprint == Progress.Fingerprint && SavedProgress.NextRow <= Request.Assets.Num() &&
+		IFileManager::Get().FileSize(*Request.FilePath) == SavedProgress.FileSize;
+	if (bResume)
+	{
+		Progress = SavedProgress;
+	}
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Request.FilePath, bResume ? FILEWRITE_Append : 0));
+	if (!Writer.IsValid())
+	{
+		Result.Error = FString::Printf(TEXT("无法写入 %s"), *Result.FilePath);
+		return Result;
+	}
+	Result.FirstRow = Progress.NextRow;
+
+	// 同名分组只需要知道每个名字的组号，续传时前面的名字按同样的顺序重新编号
+	TMap<FName, int32> SameNameGroups;
+	if (Request.bGroupBySameName)
+	{
+		for (int32 Index = 0; Index < Progress.NextRow; ++Index)
+		{
+			SameNameGroups.FindOrAdd(Request.Assets[Index]->AssetName, SameNameGroups.Num());
+		}
+	}
+
+	if (!bResume)
+	{
+		WriteChunk(*Writer, bJson ? TEXT("[\n") : TEXT("Path,Class,SizeBytes,Referencers,Group\n"));
+	}
+
+	// 同一个缓冲区反复使用，容量只取决于一块的行数
+	FString Chunk;
+
+	TArray<FName> Referencers;
+	while (Progress.NextRow < Request.Assets.Num())
+	{
+		if (Token && Token->IsCancelled())
+		{
+			Result.bCancelled = true;
+			break;
+		}
+
+		const int32 ChunkEnd = FMath::Min(Progress.NextRow + RowsPerChunk, Request.Assets.Num());
+		for (int32 Index = Progress.NextRow; Index < ChunkEnd; ++Index)
+		{
+			const FAssetData& AssetData = *Request.Assets[Index];
+			const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(AssetData.PackageName);
+			const int64 DiskSize = PackageData.IsSet() ? FMath::Max<int64>(PackageData->DiskSize, 0) : 0;
+			Referencers.Reset();
+			AssetRegistry.GetReferencers(AssetData.PackageName, Referencers);
+
+			// 组号与面板上显示的 [#n] 一致，从1开始，0表示不属于任何组
+			int32 Group = 0;
+			if (Request.bGroupBySameName)
+			{
+				Group = SameNameGroups.FindOrAdd(AssetData.AssetName, SameNameGroups.Num()) + 1;
+			}
+			else if (const int32* AssetGroup = Request.AssetGroups.Find(AssetData.GetSoftObjectPath()))
+			{
+				Group = *AssetGroup + 1;
+			}
+
+			if (bJson)
+			{
+				Chunk += Index > 0 ? TEXT(",\n{\"path\":") : TEXT("{\"path\":");
+				AppendJsonString(Chunk, AssetData.GetObjectPathString());
+				Chunk += TEXT(",\"class\":");
+				AppendJsonString(Chunk, AssetData.AssetClassPath.GetAssetName().ToString());
+				Chunk += FString::Printf(TEXT(",\"sizeBytes\":%lld,\"referencers\":%d,\"group\":%d}"), DiskSize, Referencers.Num(), Group);
+			}
+			else
+			{
+				AppendCsvField(Chunk, AssetData.GetObjectPathString());
+				Chunk += TEXT(',');
+				AppendCsvField(Chunk, AssetData.AssetClassPath.GetAssetName().ToString());
+				Chunk += FString::Printf(TEXT(",%lld,%d,%d\n"), DiskSize, Referencers.Num(), Group);
+			}
+		}
+
+		// 先把这一块落盘，再记录进度，中途退出时文件长度和进度不一致就从头导出
+		WriteChunk(*Writer, Chunk);
+		Writer->Flush();
+		Chunk.Reset();
+		Progress.NextRow = ChunkEnd;
+		Progress.FileSize = Writer->Tell();
+		SaveProgress(Request.FilePath, Progress);
+	}
+
+	Result.NumRowsWritten = Progress.NextRow;
+	if (!Result.bCancelled)
+	{
+		if (bJson)
+		{
+			WriteChunk(*Writer, TEXT("\n]\n"));
+		}
+		IFileManager::Get().Delete(*GetProgressFilePath(Request.FilePath), false, true, true);
+	}
+	Result.bSucceeded = Writer->Close() && !Result.bCancelled;
+	if (!Result.bSucceeded && !Result.bCancelled)
+	{
+		Result.Error = FString::Printf(TEXT("写入 %s 时出错"), *Result.FilePath);
+	}
+	return Result;
+}
+
+bool SuperManagerListingExport::HasResumableProgress(const FString& FilePath)
+{
+	FProgress Progress;
+	return LoadProgress(FilePath, Progress) && IFileManager::Get().FileSize(*FilePath) == Progress.FileSize;
+}
@@ -0,0 +1,861 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Operations/Quarantine.h"
+
+#include "AssetToolsModule.h"
+#include "FileHelpers.h"
+#include "ISourceControlModule.h"
+#include "ObjectTools.h"
+#include "SuperManager.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Audit/ProjectAudit.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+#include "References/StringReferenceScanner.h"
+#include "Settings/SuperManagerSettings.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace SuperManagerQuarantine
+{
+	// 定期检查是否有批次超过保留期
+	constexpr float PurgeIntervalSeconds = 600.f;
+	// 每次交给注册表重新扫描的文件数
+	constexpr int32 FilesPerRegistryRefresh = 64;
+	// 报告里最多列出的跳过项
+	constexpr int32 MaxListedSkipped = 10;
+	// 主文件(.uasset/.umap)之外可能存在的文件
+	const TCHAR* const SidecarExtensions[] = {TEXT(".uexp"), TEXT(".ubulk"), TEXT(".uptnl"), TEXT(".m.ubulk")};
+	const TCHAR* const OperationLogNames[] = {TEXT("quarantined"), TEXT("restored"), TEXT("purged")};
+
+	TSharedPtr<FSuperManagerQuarantine> GetQuarantine()
+	{
+		if (!FModuleManager::Get().IsModuleLoaded(TEXT("SuperManager")))
+		{
+			return nullptr;
+		}
+		return FModuleManager::GetModuleChecked<FSuperManagerModule>(TEXT("SuperManager")).GetQuarantine();
+	}
+
+	FAutoConsoleCommand DumpStatsCommand(
+		TEXT("SuperManager.QuarantineStats"),
+		TEXT("打印SuperManager隔离区中的批次，以及移入、恢复、清理的吞吐"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			const TSharedPtr<FSuperManagerQuarantine> Quarantine = GetQuarantine();
+			if (!Quarantine.IsValid())
+			{
+				return;
+			}
+			const TArray<FSuperManagerQuarantineBatch> Batches = Quarantine->GetBatches();
+			UE_LOG(LogTemp, Display, TEXT("SuperManager quarantine: %d batches under %s"), Batches.Num(), *FSuperManagerQuarantine::GetRoot());
+			for (const FSuperManagerQuarantineBatch& Batch : Batches)
+			{
+				UE_LOG(LogTemp, Display, TEXT("  %s: %d packages, created %s UTC"), *Batch.Id, Batch.Entries.Num(), *Batch.CreatedUtc.ToString());
+			}
+			const FSuperManagerQuarantineStats& Stats = Quarantine->GetStats();
+			for (int32 Index = 0; Index < static_cast<int32>(UE_ARRAY_COUNT(OperationLogNames)); ++Index)
+			{
+				const double Seconds = Stats.Seconds[Index];
+				const double MegaBytes = Stats.Bytes[Index] / (1024.0 * 1024.0);
+				UE_LOG(LogTemp, Display, TEXT("  %s: %lld packages, %.1f MB in %.2f s (%.1f packages/s, %.1f MB/s)"),
+				       OperationLogNames[Index], Stats.NumPackages[Index], MegaBytes, Seconds,
+				       Seconds > 0.0 ? Stats.NumPackages[Index] / Seconds : 0.0, Seconds > 0.0 ? MegaBytes / Seconds : 0.0);
+			}
+		}));
+
+	FAutoConsoleCommand RestoreCommand(
+		TEXT("SuperManager.RestoreQuarantine"),
+		TEXT("把一个隔离批次整体移回原位置，参数为批次Id"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const TSharedPtr<FSuperManagerQuarantine> Quarantine = GetQuarantine();
+			if (Quarantine.IsValid() && (Args.Num() != 1 || !Quarantine->RestoreBatch(Args[0])))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Usage: SuperManager.RestoreQuarantine <BatchId>, the batch must exist and not be in use"));
+			}
+		}));
+
+	FAutoConsoleCommand PurgeCommand(
+		TEXT("SuperManager.PurgeQuarantine"),
+		TEXT("清理超过保留期的隔离批次，加参数 all 时清理全部"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (const TSharedPtr<FSuperManagerQuarantine> Quarantine = GetQuarantine())
+			{
+				Quarantine->PurgeExpired(Args.Num() > 0 && Args[0] == TEXT("all"));
+			}
+		}));
+
+	const TCHAR* GetOperationName(ESuperManagerQuarantineOperation Operation)
+	{
+		switch (Operation)
+		{
+		case ESuperManagerQuarantineOperation::Quarantine: return TEXT("移入隔离区");
+		case ESuperManagerQuarantineOperation::Restore: return TEXT("恢复");
+		case ESuperManagerQuarantineOperation::Purge: return TEXT("清理");
+		default: return TEXT("");
+		}
+	}
+
+	FString GetManifestDir()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SuperManager"), TEXT("Quarantine"));
+	}
+
+	int64 ParseInt64(const FString& String)
+	{
+		int64 Value = 0;
+		LexFromString(Value, *String);
+		return Value;
+	}
+
+	// 主文件移动失败时返回false，调用方改为加载后重命名；附属文件跟着主文件移动
+	bool MovePackageFiles(const FString& FromFilename, const FString& ToBaseFilename, TArray<FString>& OutChangedFiles)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+		const FString ToFilename = ToBaseFilename + FPaths::GetExtension(FromFilename, true);
+		if (FileManager.FileExists(*ToFilename) || !FileManager.Move(*ToFilename, *FromFilename, false, true))
+		{
+			return false;
+		}
+		OutChangedFiles.Add(FromFilename);
+		OutChangedFiles.Add(ToFilename);
+
+		const FString FromBaseFilename = FPaths::ChangeExtension(FromFilename, FString());
+		for (const TCHAR* Extension : SidecarExtensions)
+		{
+			const FString FromSidecar = FromBaseFilename + Extension;
+			if (FileManager.FileExists(*FromSidecar) && !FileManager.Move(*(ToBaseFilename + Extension), *FromSidecar, false, true))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("SuperManager quarantine failed to move %s"), *FromSidecar);
+			}
+		}
+		return true;
+	}
+
+	bool DeletePackageFiles(const FString& Filename, TArray<FString>& OutChangedFiles)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+		if (!FileManager.Delete(*Filename, false, true))
+		{
+			return false;
+		}
+		OutChangedFiles.Add(Filename);
+
+		const FString BaseFilename = FPaths::ChangeExtension(Filename, FString());
+		for (const TCHAR* Extension : SidecarExtensions)
+		{
+			FileManager.Delete(*(BaseFilename + Extension), false, true, true);
+		}
+		return true;
+	}
+
+	// 批次全部恢复或清理后，目录里不再有任何文件时连同注册表中的路径一起删除
+	void DeleteFolderIfEmpty(const FString& Folder)
+	{
+		FString Directory;
+		if (!FPackageName::TryConvertLongPackageNameToFilename(Folder + TEXT("/"), Directory))
+		{
+			return;
+		}
+		TArray<FString> Files;
+		IFileManager::Get().FindFilesRecursive(Files, *Directory, TEXT("*"), true, false);
+		if (Files.Num() == 0)
+		{
+			IFileManager::Get().DeleteDirectory(*Directory, false, true);
+			IAssetRegistry::GetChecked().RemovePath(Folder);
+		}
+	}
+}
+
+#pragma region 批次清单
+
+FString FSuperManagerQuarantineBatch::GetFolder() const
+{
+	return FSuperManagerQuarantine::GetRoot() / Id;
+}
+
+FString FSuperManagerQuarantineBatch::GetManifestPath() const
+{
+	return SuperManagerQuarantine::GetManifestDir() / Id + TEXT(".json");
+}
+
+TSharedRef<FJsonObject> FSuperManagerQuarantineBatch::ToJson() const
+{
+	TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+	JsonObject->SetStringField(TEXT("id"), Id);
+	JsonObject->SetStringField(TEXT("created"), CreatedUtc.ToIso8601());
+
+	TArray<TSharedPtr<FJsonValue>> EntryValues;
+	EntryValues.Reserve(Entries.Num());
+	for (const FSuperManagerQuarantineEntry& Entry : Entries)
+	{
+		TSharedRef<FJsonObject> EntryObject = MakeShared<FJsonObject>();
+		EntryObject->SetStringField(TEXT("original"), Entry.OriginalPackage.ToString());
+		EntryObject->SetStringField(TEXT("quarantined"), Entry.QuarantinedPackage.ToString());
+		EntryObject->SetStringField(TEXT("bytes"), LexToString(Entry.DiskSize));
+		EntryValues.Add(MakeShared<FJsonValueObject>(EntryObject));
+	}
+	JsonObject->SetArrayField(TEXT("entries"), EntryValues);
+	return JsonObject;
+}
+
+bool FSuperManagerQuarantineBatch::FromJson(const TSharedPtr<FJsonObject>& JsonObject)
+{
+	FString CreatedString;
+	const TArray<TSharedPtr<FJsonValue>>* EntryValues = nullptr;
+	if (!JsonObject.IsValid() ||
+		!JsonObject->TryGetStringField(TEXT("id"), Id) ||
+		!JsonObject->TryGetStringField(TEXT("created"), CreatedString) ||
+		!FDateTime::ParseIso8601(*CreatedString, CreatedUtc) ||
+		!JsonObject->TryGetArrayField(TEXT("entries"), EntryValues))
+	{
+		return false;
+	}
+
+	Entries.Reset(EntryValues->Num());
+	for (const TSharedPtr<FJsonValue>& EntryValue : *EntryValues)
+	{
+		const TSharedPtr<FJsonObject>& EntryObject = EntryValue->AsObject();
+		if (!EntryObject.IsValid())
+		{
+			return false;
+		}
+		FSuperManagerQuarantineEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.OriginalPackage = FName(*EntryObject->GetStringField(TEXT("original")));
+		Entry.QuarantinedPackage = FName(*EntryObject->GetStringField(TEXT("quarantined")));
+		Entry.DiskSize = SuperManagerQuarantine::ParseInt64(EntryObject->GetStringField(TEXT("bytes")));
+	}
+	return true;
+}
+
+FString FSuperManagerQuarantineReport::ToString() const
+{
+	using namespace SuperManagerQuarantine;
+	const double PackagesPerSecond = Seconds > 0.0 ? NumPackages / Seconds : 0.0;
+	const int64 BytesPerSecond = Seconds > 0.0 ? static_cast<int64>(Bytes / Seconds) : 0;
+	FString Result = FString::Printf(TEXT("批次 %s：%s %d 个包(%s)，其中 %d 个直接%s文件，跳过 %d 个\n用时 %.2fs，%.1f 个/秒，%s/秒"),
+	                                 *BatchId, GetOperationName(Operation), NumPackages, *FText::AsMemory(Bytes).ToString(),
+	                                 NumFileOperations, Operation == ESuperManagerQuarantineOperation::Purge ? TEXT("删除") : TEXT("移动"),
+	                                 Skipped.Num(), Seconds, PackagesPerSecond, *FText::AsMemory(BytesPerSecond).ToString());
+	for (int32 Index = 0; Index < FMath::Min(Skipped.Num(), MaxListedSkipped); ++Index)
+	{
+		Result += FString::Printf(TEXT("\n%s：%s"), *Skipped[Index].Key.ToString(), *Skipped[Index].Value);
+	}
+	if (Skipped.Num() > MaxListedSkipped)
+	{
+		Result += FString::Printf(TEXT("\n……还有 %d 个"), Skipped.Num() - MaxListedSkipped);
+	}
+	return Result;
+}
+
+#pragma endregion
+
+#pragma region 移动与清理
+
+struct FSuperManagerQuarantine::FOperation
+{
+	struct FMove
+	{
+		FName From;
+		// 清理时为空
+		FName To;
+		bool bLoaded = false;
+		// 以下在工作线程上填写
+		FAssetData AssetData;
+		int64 DiskSize = 0;
+		bool bSkipped = false;
+		bool bFileOperation = false;
+		bool bDone = false;
+	};
+
+	ESuperManagerQuarantineOperation Kind = ESuperManagerQuarantineOperation::Quarantine;
+	// 移入时是新批次(还没有条目)，恢复和清理时是现有批次的副本
+	FSuperManagerQuarantineBatch Batch;
+	TArray<FMove> Moves;
+	ESuperManagerTaskPriority Priority = ESuperManagerTaskPriority::Normal;
+	// 直接移动文件不经过版本控制，开启版本控制时全部交给 AssetTools
+	bool bAllowFileOperations = true;
+	TSharedPtr<const FSuperManagerStringReferenceScanner> StringReferenceScanner;
+	FOnQuarantineFinished OnFinished;
+	FSuperManagerQuarantineReport Report;
+	double StartTime = 0.0;
+
+	TArray<FString> ChangedFiles;
+	int32 NextChangedFile = 0;
+	TArray<int32> LoadIndices;
+	int32 NextLoad = 0;
+	// 重命名或删除之前，加载的资产不能被GC
+	TArray<TPair<int32, TStrongObjectPtr<UObject>>> LoadedObjects;
+
+	void Skip(FMove& Move, const FString& Reason)
+	{
+		Move.bSkipped = true;
+		Report.Skipped.Emplace(Move.From, Reason);
+	}
+
+	void Plan(const FSuperManagerCancellationToken& CancellationToken);
+	bool RefreshRegistryStage();
+	bool LoadStage();
+	bool ApplyStage();
+};
+
+// 工作线程：检查引用、决定每个包走哪条路径，然后直接移动(删除)可以不加载的包的文件
+void FSuperManagerQuarantine::FOperation::Plan(const FSuperManagerCancellationToken& CancellationToken)
+{
+	using namespace SuperManagerQuarantine;
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+	const FTopLevelAssetPath WorldClassPath(TEXT("/Script/Engine"), TEXT("World"));
+
+	TSet<FName> BatchPackages;
+	for (const FMove& Move : Moves)
+	{
+		BatchPackages.Add(Move.From);
+	}
+
+	TArray<FAssetData> PackageAssets;
+	TArray<FName> Referencers;
+	TArray<FName> Dependencies;
+	for (FMove& Move : Moves)
+	{
+		PackageAssets.Reset();
+		AssetRegistry.GetAssetsByPackageName(Move.From, PackageAssets);
+		if (PackageAssets.Num() == 0)
+		{
+			// 隔离区里的包已经不在了(例如被手动删除)，恢复和清理时直接从清单中去掉
+			// 注册表可能只是还没扫描到，磁盘上文件还在时保留条目，否则这些文件再也无法恢复或清理
+			if (Kind == ESuperManagerQuarantineOperation::Quarantine)
+			{
+				Skip(Move, TEXT("注册表中没有这个包"));
+			}
+			else if (FPackageName::DoesPackageExist(Move.From.ToString()))
+			{
+				Skip(Move, TEXT("注册表中还没有这个包，请等扫描完成后再试"));
+			}
+			else
+			{
+				Move.bDone = true;
+			}
+			continue;
+		}
+		const FName ShortName = FPackageName::GetShortFName(Move.From);
+		const FAssetData* PrimaryAsset = PackageAssets.FindByPredicate([ShortName](const FAssetData& AssetData)
+		{
+			return AssetData.AssetName == ShortName;
+		});
+		Move.AssetData = PrimaryAsset ? *PrimaryAsset : PackageAssets[0];
+		if (const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(Move.From))
+		{
+			Move.DiskSize = FMath::Max<int64>(PackageData->DiskSize, 0);
+		}
+
+		Referencers.Reset();
+		AssetRegistry.GetReferencers(Move.From, Referencers);
+		Referencers.Remove(Move.From);
+		const bool bReferencedOutsideBatch = Referencers.ContainsByPredicate([&BatchPackages](FName Referencer)
+		{
+			return !BatchPackages.Contains(Referencer);
+		});
+		switch (Kind)
+		{
+		case ESuperManagerQuarantineOperation::Quarantine:
+			if (bReferencedOutsideBatch)
+			{
+				Skip(Move, TEXT("被批次之外的包引用"));
+				continue;
+			}
+			if (StringReferenceScanner.IsValid() && StringReferenceScanner->IsReferenced(Move.From))
+			{
+				Skip(Move, TEXT("被文本文件引用"));
+				continue;
+			}
+			break;
+		case ESuperManagerQuarantineOperation::Restore:
+			if (FPackageName::DoesPackageExist(Move.To.ToString()))
+			{
+				Skip(Move, TEXT("原位置已有同名的包"));
+				continue;
+			}
+			break;
+		case ESuperManagerQuarantineOperation::Purge:
+			if (bReferencedOutsideBatch)
+			{
+				Skip(Move, TEXT("仍被引用，保留在隔离区"));
+				continue;
+			}
+			break;
+		}
+
+		// 已加载的包内存里还是旧路径，关卡还有外部Actor包，这些都交给 AssetTools
+		if (!bAllowFileOperations || Move.bLoaded || Move.AssetData.AssetClassPath == WorldClassPath)
+		{
+			continue;
+		}
+		if (Kind == ESuperManagerQuarantineOperation::Purge)
+		{
+			Move.bFileOperation = true;
+			continue;
+		}
+		// 移动文件不会改写导入表：引用它的包、它引用的同批次的包都会失效
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(Move.From, Dependencies);
+		Move.bFileOperation = Referencers.Num() == 0 && !Dependencies.ContainsByPredicate([&BatchPackages, &Move](FName Dependency)
+		{
+			return Dependency != Move.From && BatchPackages.Contains(Dependency);
+		});
+	}
+
+	// 移动之前先写下计划，编辑器中途退出也能从清单找回文件；完成时按实际结果重写
+	if (Kind == ESuperManagerQuarantineOperation::Quarantine)
+	{
+		for (const FMove& Move : Moves)
+		{
+			if (!Move.bSkipped)
+			{
+				Batch.Entries.Add({Move.From, Move.To, Move.DiskSize});
+			}
+		}
+		if (Batch.Entries.Num() > 0)
+		{
+			SuperManagerProjectAudit::SaveJson(Batch.ToJson(), Batch.GetManifestPath());
+		}
+		Batch.Entries.Reset();
+	}
+
+	for (FMove& Move : Moves)
+	{
+		if (CancellationToken.IsCancelled())
+		{
+			return;
+		}
+		if (Move.bSkipped || !Move.bFileOperation)
+		{
+			continue;
+		}
+		FString FromFilename;
+		FString ToBaseFilename;
+		if (!FPackageName::DoesPackageExist(Move.From.ToString(), &FromFilename))
+		{
+			Move.bFileOperation = false;
+		}
+		else if (Kind == ESuperManagerQuarantineOperation::Purge)
+		{
+			Move.bFileOperation = DeletePackageFiles(FromFilename, ChangedFiles);
+		}
+		else
+		{
+			Move.bFileOperation = FPackageName::TryConvertLongPackageNameToFilename(Move.To.ToString(), ToBaseFilename) &&
+				MovePackageFiles(FromFilename, ToBaseFilename, ChangedFiles);
+		}
+		Move.bDone = Move.bFileOperation;
+	}
+
+	for (int32 Index = 0; Index < Moves.Num(); ++Index)
+	{
+		if (!Moves[Index].bSkipped && !Moves[Index].bDone)
+		{
+			LoadIndices.Add(Index);
+		}
+	}
+}
+
+// 直接移动(删除)的文件分批交给注册表重新扫描，旧路径的资产随之移除
+bool FSuperManagerQuarantine::FOperation::RefreshRegistryStage()
+{
+	if (NextChangedFile < ChangedFiles.Num())
+	{
+		const int32 NumFiles = FMath::Min(SuperManagerQuarantine::FilesPerRegistryRefresh, ChangedFiles.Num() - NextChangedFile);
+		const TArray<FString> Files(ChangedFiles.GetData() + NextChangedFile, NumFiles);
+		NextChangedFile += NumFiles;
+		IAssetRegistry::GetChecked().ScanModifiedAssetFiles(Files);
+	}
+	return NextChangedFile >= ChangedFiles.Num();
+}
+
+// 一次只加载一个资产
+bool FSuperManagerQuarantine::FOperation::LoadStage()
+{
+	if (NextLoad < LoadIndices.Num())
+	{
+		const int32 Index = LoadIndices[NextLoad++];
+		if (UObject* Object = Moves[Index].AssetData.GetAsset())
+		{
+			LoadedObjects.Emplace(Index, TStrongObjectPtr<UObject>(Object));
+		}
+		else
+		{
+			Skip(Moves[Index], TEXT("加载失败"));
+		}
+	}
+	return NextLoad >= LoadIndices.Num();
+}
+
+// 加载的资产一次性处理：移动时交给 AssetTools 重命名(修复同批次之间的引用、不留重定向器)，清理时不弹对话框地删除
+bool FSuperManagerQuarantine::FOperation::ApplyStage()
+{
+	if (LoadedObjects.Num() == 0)
+	{
+		return true;
+	}
+
+	if (Kind == ESuperManagerQuarantineOperation::Purge)
+	{
+		TArray<UObject*> ObjectsToDelete;
+		for (const TPair<int32, TStrongObjectPtr<UObject>>& LoadedObject : LoadedObjects)
+		{
+			ObjectsToDelete.Add(LoadedObject.Value.Get());
+		}
+		TArray<TPair<int32, TStrongObjectPtr<UObject>>> DeletedObjects = MoveTemp(LoadedObjects);
+		// 放开持有后再删除，否则会被当作仍有引用
+		for (TPair<int32, TStrongObjectPtr<UObject>>& DeletedObject : DeletedObjects)
+		{
+			DeletedObject.Value.Reset();
+		}
+		ObjectTools::ForceDeleteObjects(ObjectsToDelete, false);
+		for (const TPair<int32, TStrongObjectPtr<UObject>>& DeletedObject : DeletedObjects)
+		{
+			FMove& Move = Moves[DeletedObject.Key];
+			if (FPackageName::DoesPackageExist(Move.From.ToString()))
+			{
+				Skip(Move, TEXT("删除失败"));
+			}
+			else
+			{
+				Move.bDone = true;
+			}
+		}
+		return true;
+	}
+
+	TArray<FAssetRenameData> RenameData;
+	RenameData.Reserve(LoadedObjects.Num());
+	for (const TPair<int32, TStrongObjectPtr<UObject>>& LoadedObject : LoadedObjects)
+	{
+		const FMove& Move = Moves[LoadedObject.Key];
+		const UObject* Object = LoadedObject.Value.Get();
+		RenameData.Emplace(FSoftObjectPath(Object), FSoftObjectPath(Move.To.ToString() + TEXT(".") + Object->GetName()), false, false);
+	}
+	FAssetToolsModule::GetModule().Get().RenameAssets(RenameData);
+
+	TArray<UPackage*> PackagesToSave;
+	TArray<int32> SavedMoveIndices;
+	for (const TPair<int32, TStrongObjectPtr<UObject>>& LoadedObject : LoadedObjects)
+	{
+		FMove& Move = Moves[LoadedObject.Key];
+		UPackage* Package = LoadedObject.Value->GetOutermost();
+		if (Package->GetFName() == Move.To)
+		{
+			PackagesToSave.Add(Package);
+			SavedMoveIndices.Add(LoadedObject.Key);
+		}
+		else
+		{
+			Skip(Move, TEXT("重命名失败"));
+		}
+	}
+	if (PackagesToSave.Num() > 0)
+	{
+		UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, false);
+	}
+	// 只有新包确实写到磁盘上才算移入，否则重启后清单里的条目找不到文件
+	for (int32 Index = 0; Index < PackagesToSave.Num(); ++Index)
+	{
+		FMove& Move = Moves[SavedMoveIndices[Index]];
+		if (!PackagesToSave[Index]->IsDirty() && FPackageName::DoesPackageExist(Move.To.ToString()))
+		{
+			Move.bDone = true;
+		}
+		else
+		{
+			Skip(Move, TEXT("重命名后保存失败"));
+		}
+	}
+	LoadedObjects.Empty();
+	return true;
+}
+
+#pragma endregion
+
+FSuperManagerQuarantine::FSuperManagerQuarantine(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler,
+                                                 const TSharedRef<const FSuperManagerStringReferenceScanner>& InStringReferenceScanner)
+	: TaskScheduler(InTaskScheduler)
+	, StringReferenceScanner(InStringReferenceScanner)
+{
+}
+
+void FSuperManagerQuarantine::Initialize()
+{
+	const FString ManifestDir = SuperManagerQuarantine::GetManifestDir();
+	TArray<FString> ManifestFiles;
+	IFileManager::Get().FindFiles(ManifestFiles, *(ManifestDir / TEXT("*.json")), true, false);
+	for (const FString& ManifestFile : ManifestFiles)
+	{
+		FSuperManagerQuarantineBatch Batch;
+		if (Batch.FromJson(SuperManagerProjectAudit::LoadJson(ManifestDir / ManifestFile)) && Batch.Entries.Num() > 0)
+		{
+			Batches.Add(Batch.Id, MoveTemp(Batch));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SuperManager quarantine ignored invalid manifest %s"), *ManifestFile);
+		}
+	}
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateSP(this, &FSuperManagerQuarantine::Tick), SuperManagerQuarantine::PurgeIntervalSeconds);
+	// 上次编辑器关闭期间过期的批次，清理本身是最低优先级
+	PurgeExpired();
+}
+
+void FSuperManagerQuarantine::Shutdown()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	Token->Cancel();
+}
+
+FString FSuperManagerQuarantine::GetRoot()
+{
+	FString Root = USuperManagerSettings::Get()->QuarantineRoot;
+	Root.RemoveFromEnd(TEXT("/"));
+	return Root;
+}
+
+void FSuperManagerQuarantine::QuarantineAssets(const TArray<FAssetData>& Assets, FOnQuarantineFinished OnFinished)
+{
+	const TSharedRef<FOperation> Operation = MakeShared<FOperation>();
+	Operation->Kind = ESuperManagerQuarantineOperation::Quarantine;
+	Operation->Batch.Id = MakeBatchId();
+	Operation->Batch.CreatedUtc = FDateTime::UtcNow();
+	Operation->OnFinished = MoveTemp(OnFinished);
+
+	// 原包名带挂载点挂在批次目录下，例如 /Game/_Quarantine/<Id>/Game/Props/Chair，恢复时不需要额外信息
+	const FString RootPrefix = GetRoot() + TEXT("/");
+	const FString BatchFolder = Operation->Batch.GetFolder();
+	TSet<FName> SeenPackages;
+	for (const FAssetData& AssetData : Assets)
+	{
+		bool bAlreadySeen = false;
+		SeenPackages.Add(AssetData.PackageName, &bAlreadySeen);
+		if (bAlreadySeen)
+		{
+			continue;
+		}
+		const FString PackageName = AssetData.PackageName.ToString();
+		if (PackageName.StartsWith(RootPrefix))
+		{
+			Operation->Report.Skipped.Emplace(AssetData.PackageName, TEXT("已经在隔离区"));
+			continue;
+		}
+		FOperation::FMove& Move = Operation->Moves.AddDefaulted_GetRef();
+		Move.From = AssetData.PackageName;
+		Move.To = FName(BatchFolder + PackageName);
+	}
+
+	// 批次先占位，Id 不会被同时进行的另一次隔离用到；条目在完成时写入
+	FSuperManagerQuarantineBatch& Batch = Batches.Add(Operation->Batch.Id);
+	Batch.Id = Operation->Batch.Id;
+	Batch.CreatedUtc = Operation->Batch.CreatedUtc;
+	Run(Operation);
+}
+
+bool FSuperManagerQuarantine::RestoreBatch(const FString& BatchId, FOnQuarantineFinished OnFinished)
+{
+	const FSuperManagerQuarantineBatch* Batch = Batches.Find(BatchId);
+	if (!Batch || BusyBatches.Contains(BatchId))
+	{
+		return false;
+	}
+
+	const TSharedRef<FOperation> Operation = MakeShared<FOperation>();
+	Operation->Kind = ESuperManagerQuarantineOperation::Restore;
+	Operation->Batch = *Batch;
+	Operation->OnFinished = MoveTemp(OnFinished);
+	for (const FSuperManagerQuarantineEntry& Entry : Batch->Entries)
+	{
+		FOperation::FMove& Move = Operation->Moves.AddDefaulted_GetRef();
+		Move.From = Entry.QuarantinedPackage;
+		Move.To = Entry.OriginalPackage;
+	}
+	Run(Operation);
+	return true;
+}
+
+void FSuperManagerQuarantine::PurgeExpired(bool bIgnoreRetention)
+{
+	const FDateTime Now = FDateTime::UtcNow();
+	const FTimespan Retention = FTimespan::FromDays(USuperManagerSettings::Get()->QuarantineRetentionDays);
+	for (const TPair<FString, FSuperManagerQuarantineBatch>& Pair : Batches)
+	{
+		if (BusyBatches.Contains(Pair.Key) || (!bIgnoreRetention && Pair.Value.CreatedUtc + Retention > Now))
+		{
+			continue;
+		}
+
+		const TSharedRef<FOperation> Operation = MakeShared<FOperation>();
+		Operation->Kind = ESuperManagerQuarantineOperation::Purge;
+		Operation->Batch = Pair.Value;
+		Operation->Priority = ESuperManagerTaskPriority::Background;
+		for (const FSuperManagerQuarantineEntry& Entry : Pair.Value.Entries)
+		{
+			Operation->Moves.AddDefaulted_GetRef().From = Entry.QuarantinedPackage;
+		}
+		Run(Operation);
+	}
+}
+
+TArray<FSuperManagerQuarantineBatch> FSuperManagerQuarantine::GetBatches() const
+{
+	TArray<FSuperManagerQuarantineBatch> Result;
+	for (const TPair<FString, FSuperManagerQuarantineBatch>& Pair : Batches)
+	{
+		if (Pair.Value.Entries.Num() > 0)
+		{
+			Result.Add(Pair.Value);
+		}
+	}
+	Result.Sort([](const FSuperManagerQuarantineBatch& A, const FSuperManagerQuarantineBatch& B)
+	{
+		return A.CreatedUtc < B.CreatedUtc;
+	});
+	return Result;
+}
+
+FString FSuperManagerQuarantine::FindBatchIdForPath(const FString& Path) const
+{
+	const FString RootPrefix = GetRoot() + TEXT("/");
+	if (!Path.StartsWith(RootPrefix))
+	{
+		return FString();
+	}
+	FString BatchId = Path.RightChop(RootPrefix.Len());
+	int32 SlashIndex = INDEX_NONE;
+	if (BatchId.FindChar(TEXT('/'), SlashIndex))
+	{
+		BatchId.LeftInline(SlashIndex);
+	}
+	return Batches.Contains(BatchId) ? BatchId : FString();
+}
+
+void FSuperManagerQuarantine::Run(const TSharedRef<FOperation>& Operation)
+{
+	check(IsInGameThread());
+	Operation->StartTime = FPlatformTime::Seconds();
+	Operation->Report.Operation = Operation->Kind;
+	Operation->Report.BatchId = Operation->Batch.Id;
+	Operation->StringReferenceScanner = StringReferenceScanner;
+	Operation->bAllowFileOperations = !ISourceControlModule::Get().IsEnabled();
+	for (FOperation::FMove& Move : Operation->Moves)
+	{
+		Move.bLoaded = FindPackage(nullptr, *Move.From.ToString()) != nullptr;
+	}
+	BusyBatches.Add(Operation->Batch.Id);
+
+	const ESuperManagerTaskPriority Priority = Operation->Priority;
+	TWeakPtr<FSuperManagerQuarantine> WeakThis = AsShared();
+	TaskScheduler->LaunchWorker(TEXT("SuperManager.QuarantinePlan"),
+		[WeakThis, Scheduler = TaskScheduler, Operation, OperationToken = Token, Priority](const FSuperManagerCancellationToken& CancellationToken)
+		{
+			Operation->Plan(CancellationToken);
+			if (CancellationToken.IsCancelled())
+			{
+				return;
+			}
+
+			Scheduler->EnqueueGameThreadStage(TEXT("SuperManager.QuarantineRefreshRegistry"), [Operation]() { return Operation->RefreshRegistryStage(); }, OperationToken, Priority);
+			Scheduler->EnqueueGameThreadStage(TEXT("SuperManager.QuarantineLoad"), [Operation]() { return Operation->LoadStage(); }, OperationToken, Priority);
+			Scheduler->EnqueueGameThreadStage(TEXT("SuperManager.QuarantineApply"), [Operation]() { return Operation->ApplyStage(); }, OperationToken, Priority);
+			Scheduler->EnqueueGameThreadStage(TEXT("SuperManager.QuarantineFinish"), [WeakThis, Operation]()
+			{
+				if (const TSharedPtr<FSuperManagerQuarantine> This = WeakThis.Pin())
+				{
+					This->Finish(*Operation);
+				}
+				return true;
+			}, OperationToken, Priority);
+		}, Token, Priority);
+}
+
+void FSuperManagerQuarantine::Finish(FOperation& Operation)
+{
+	FSuperManagerQuarantineReport& Report = Operation.Report;
+	TSet<FName> DonePackages;
+	TArray<FSuperManagerQuarantineEntry> NewEntries;
+	for (const FOperation::FMove& Move : Operation.Moves)
+	{
+		if (!Move.bDone)
+		{
+			continue;
+		}
+		DonePackages.Add(Move.From);
+		Report.Packages.Add(Move.From);
+		NewEntries.Add({Move.From, Move.To, Move.DiskSize});
+		++Report.NumPackages;
+		Report.Bytes += Move.DiskSize;
+		if (Move.bFileOperation)
+		{
+			++Report.NumFileOperations;
+		}
+	}
+	Report.Seconds = FPlatformTime::Seconds() - Operation.StartTime;
+
+	const FString BatchId = Operation.Batch.Id;
+	if (FSuperManagerQuarantineBatch* Batch = Batches.Find(BatchId))
+	{
+		if (Operation.Kind == ESuperManagerQuarantineOperation::Quarantine)
+		{
+			Batch->Entries.Append(NewEntries);
+		}
+		else
+		{
+			Batch->Entries.RemoveAll([&DonePackages](const FSuperManagerQuarantineEntry& Entry)
+			{
+				return DonePackages.Contains(Entry.QuarantinedPackage);
+			});
+		}
+
+		if (Batch->Entries.Num() > 0)
+		{
+			SuperManagerProjectAudit::SaveJson(Batch->ToJson(), Batch->GetManifestPath());
+		}
+		else
+		{
+			IFileManager::Get().Delete(*Batch->GetManifestPath(), false, true, true);
+			if (Operation.Kind != ESuperManagerQuarantineOperation::Quarantine)
+			{
+				SuperManagerQuarantine::DeleteFolderIfEmpty(Batch->GetFolder());
+			}
+			Batches.Remove(BatchId);
+		}
+	}
+	BusyBatches.Remove(BatchId);
+
+	const int32 OperationIndex = static_cast<int32>(Operation.Kind);
+	Stats.NumPackages[OperationIndex] += Report.NumPackages;
+	Stats.Bytes[OperationIndex] += Report.Bytes;
+	Stats.Seconds[OperationIndex] += Report.Seconds;
+
+	UE_LOG(LogTemp, Display, TEXT("SuperManager quarantine %s batch %s: %d packages (%d by file), %lld bytes, %d skipped in %.2f s"),
+	       SuperManagerQuarantine::OperationLogNames[OperationIndex], *BatchId, Report.NumPackages, Report.NumFileOperations,
+	       Report.Bytes, Report.Skipped.Num(), Report.Seconds);
+	Operation.OnFinished.ExecuteIfBound(Report);
+}
+
+FString FSuperManagerQuarantine::MakeBatchId() const
+{
+	const FString BaseId = FDateTime::UtcNow().ToString(TEXT("Batch_%Y%m%d_%H%M%S"));
+	FString BatchId = BaseId;
+	for (int32 Suffix = 2; Batches.Contains(BatchId); ++Suffix)
+	{
+		BatchId = FString::Printf(TEXT("%s_%d"), *BaseId, Suffix);
+	}
+	return BatchId;
+}
+
+bool FSuperManagerQuarantine::Tick(float DeltaTime)
+{
+	PurgeExpired();
+	return true;
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "References/AhoCorasickMatcher.h"
+
+int32 FSuperManagerAhoCorasickMatcher::AddPattern(FStringView Pattern)
+{
+	check(!bBuilt);
+	if (Pattern.IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+	if (Nodes.Num() == 0)
+	{
+		Nodes.AddDefaulted();
+		BuildChildren.AddDefaulted();
+	}
+
+	int32 NodeIndex = 0;
+	for (const TCHAR Char : Pattern)
+	{
+		const TCHAR Folded = FChar::ToLower(Char);
+		const TPair<TCHAR, int32>* Child = BuildChildren[NodeIndex].FindByPredicate([Folded](const TPair<TCHAR, int32>& Pair)
+		{
+			return Pair.Key == Folded;
+		});
+		if (Child)
+		{
+			NodeIndex = Child->Value;
+			continue;
+		}
+
+		const int32 NewIndex = Nodes.Num();
+		Nodes.AddDefaulted();
+		BuildChildren.AddDefaulted();
+		BuildChildren[NodeIndex].Emplace(Folded, NewIndex);
+		NodeIndex = NewIndex;
+	}
+
+	if (Nodes[NodeIndex].Pattern == INDEX_NONE)
+	{
+		Nodes[NodeIndex].Pattern = PatternCount++;
+	}
+	return Nodes[NodeIndex].Pattern;
+}
+
+void FSuperManagerAhoCorasickMatcher::Build()
+{
+	check(!bBuilt);
+	bBuilt = true;
+
+	// 子节点排序后拉平到一个数组，查找时二分
+	int32 NumEdges = 0;
+	for (const auto& Children : BuildChildren)
+	{
+		NumEdges += Children.Num();
+	}
+	Edges.Reserve(NumEdges);
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		auto& Children = BuildChildren[NodeIndex];
+		Children.Sort([](const TPair<TCHAR, int32>& A, const TPair<TCHAR, int32>& B) { return A.Key < B.Key; });
+		Nodes[NodeIndex].FirstEdge = Edges.Num();
+		Nodes[NodeIndex].NumEdges = Children.Num();
+		Edges.Append(Children);
+	}
+	BuildChildren.Empty();
+
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	// 按层次遍历，父节点的失败链接总是先于子节点算好
+	TArray<int32> Queue;
+	Queue.Reserve(Nodes.Num());
+	for (int32 EdgeIndex = Nodes[0].FirstEdge; EdgeIndex < Nodes[0].FirstEdge + Nodes[0].NumEdges; ++EdgeIndex)
+	{
+		Queue.Add(Edges[EdgeIndex].Value);
+	}
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
+	{
+		const FNode& Node = Nodes[Queue[Head]];
+		for (int32 EdgeIndex = Node.FirstEdge; EdgeIndex < Node.FirstEdge + Node.NumEdges; ++EdgeIndex)
+		{
+			const TCHAR Char = Edges[EdgeIndex].Key;
+			const int32 ChildIndex = Edges[EdgeIndex].Value;
+
+			int32 Fail = Node.Fail;
+			int32 Next = FindChild(Fail, Char);
+			while (Next == INDEX_NONE && Fail != 0)
+			{
+				Fail = Nodes[Fail].Fail;
+				Next = FindChild(Fail, Char);
+			}
+
+			FNode& Child = Nodes[ChildIndex];
+			Child.Fail = Next != INDEX_NONE ? Next : 0;
+			const FNode& FailNode = Nodes[Child.Fail];
+			Child.NextOutput = FailNode.Pattern != INDEX_NONE ? Child.Fail : FailNode.NextOutput;
+			Queue.Add(ChildIndex);
+		}
+	}
+}
+
+void FSuperManagerAhoCorasickMatcher::Scan(FStringView Text, TFunctionRef<void(int32 PatternIndex, int32 EndIndex)> OnMatch) const
+{
+	check(bBuilt);
+	if (PatternCount == 0)
+	{
+		return;
+	}
+
+	int32 State = 0;
+	for (int32 Index = 0; Index < Text.Len(); ++Index)
+	{
+		const TCHAR Char = FChar::ToLower(Text[Index]);
+		int32 Next = FindChild(State, Char);
+		while (Next == INDEX_NONE && State != 0)
+		{
+			State = Nodes[State].Fail;
+			Next = FindChild(State, Char);
+		}
+		State = Next != INDEX_NONE ? Next : 0;
+
+		const FNode& Node = Nodes[State];
+		for (int32 Output = Node.Pattern != INDEX_NONE ? State : Node.NextOutput; Output != INDEX_NONE; Output = Nodes[Output].NextOutput)
+		{
+			OnMatch(Nodes[Output].Pattern, Index + 1);
+		}
+	}
+}
+
+int32 FSuperManagerAhoCorasickMatcher::FindChild(int32 NodeIndex, TCHAR Char) const
+{
+	const FNode& Node = Nodes[NodeIndex];
+	int32 Low = Node.FirstEdge;
+	int32 High = Node.FirstEdge + Node.NumEdges;
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (Edges[Mid].Key < Char)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+	return Low < Node.FirstEdge + Node.NumEdges && Edges[Low].Key == Char ? Edges[Low].Value : INDEX_NONE;
+}
@@ -0,0 +1,253 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "References/LoadChainAnalyzer.h"
+
+#include "Algo/Reverse.h"
+#include "AssetRegistry/AssetData.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+TArray<FName> FSuperManagerLoadChainResult::GetDominatorChain(FName PackageName) const
+{
+	TArray<FName> Chain;
+	Chain.Add(PackageName);
+	while (const FName* Dominator = ImmediateDominators.Find(Chain.Last()))
+	{
+		Chain.Add(*Dominator);
+	}
+	Algo::Reverse(Chain);
+	return Chain;
+}
+
+TSharedRef<FSuperManagerLoadChainResult> FSuperManagerLoadChainAnalyzer::Analyze(FName RootPackage, int32 MaxEdges)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SuperManager_AnalyzeLoadChain);
+	const double StartTime = FPlatformTime::Seconds();
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+
+	TSharedRef<FSuperManagerLoadChainResult> Result = MakeShared<FSuperManagerLoadChainResult>();
+	Result->RootPackage = RootPackage;
+
+	// 1. 广度优先收集硬引用闭包，脚本包是代码不计入
+	TArray<FName> Names;
+	TArray<int64> Sizes;
+	TArray<TArray<int32>> Successors;
+	TMap<FName, int32> NodeIndices;
+	auto AddNode = [&](FName PackageName)
+	{
+		if (const int32* Existing = NodeIndices.Find(PackageName))
+		{
+			return *Existing;
+		}
+		const int32 NewIndex = Names.Add(PackageName);
+		NodeIndices.Add(PackageName, NewIndex);
+		Successors.AddDefaulted();
+		const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(PackageName);
+		Sizes.Add(PackageData.IsSet() ? FMath::Max<int64>(PackageData->DiskSize, 0) : 0);
+		return NewIndex;
+	};
+
+	AddNode(RootPackage);
+	TArray<FName> Dependencies;
+	for (int32 NodeIndex = 0; NodeIndex < Names.Num(); ++NodeIndex)
+	{
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(Names[NodeIndex], Dependencies, UE::AssetRegistry::EDependencyCategory::Package,
+		                              UE::AssetRegistry::EDependencyQuery::Hard);
+		for (const FName Dependency : Dependencies)
+		{
+			TStringBuilder<256> DependencyString;
+			Dependency.AppendString(DependencyString);
+			if (DependencyString.ToView().StartsWith(TEXT("/Script/")) || Dependency == Names[NodeIndex])
+			{
+				continue;
+			}
+			const int32 DependencyIndex = AddNode(Dependency);
+			Successors[NodeIndex].AddUnique(DependencyIndex);
+		}
+	}
+
+	const int32 NumNodes = Names.Num();
+	TArray<TArray<int32>> Predecessors;
+	Predecessors.SetNum(NumNodes);
+	for (int32 NodeIndex = 0; NodeIndex < NumNodes; ++NodeIndex)
+	{
+		for (const int32 Successor : Successors[NodeIndex])
+		{
+			Predecessors[Successor].Add(NodeIndex);
+		}
+	}
+
+	// 2. 逆后序编号，所有节点都从根可达
+	TArray<int32> PostOrder;
+	PostOrder.Reserve(NumNodes);
+	{
+		TArray<bool> Visited;
+		Visited.SetNumZeroed(NumNodes);
+		// (节点, 下一个要访问的后继下标)
+		TArray<TPair<int32, int32>> Stack;
+		Stack.Emplace(0, 0);
+		Visited[0] = true;
+		while (Stack.Num() > 0)
+		{
+			TPair<int32, int32>& Top = Stack.Last();
+			if (Top.Value < Successors[Top.Key].Num())
+			{
+				const int32 Successor = Successors[Top.Key][Top.Value++];
+				if (!Visited[Successor])
+				{
+					Visited[Successor] = true;
+					Stack.Emplace(Successor, 0);
+				}
+			}
+			else
+			{
+				PostOrder.Add(Top.Key);
+				Stack.Pop(EAllowShrinking::No);
+			}
+		}
+	}
+	TArray<int32> Order;
+	Order.SetNumUninitialized(NumNodes);
+	for (int32 Index = 0; Index < NumNodes; ++Index)
+	{
+		Order[PostOrder[Index]] = NumNodes - 1 - Index;
+	}
+	TArray<int32> ReversePostOrder = PostOrder;
+	Algo::Reverse(ReversePostOrder);
+
+	// 3. 迭代法求直接支配者(Cooper, Harvey, Kennedy)
+	TArray<int32> Dominators;
+	Dominators.Init(INDEX_NONE, NumNodes);
+	Dominators[0] = 0;
+	auto Intersect = [&Dominators, &Order](int32 A, int32 B)
+	{
+		while (A != B)
+		{
+			while (Order[A] > Order[B])
+			{
+				A = Dominators[A];
+			}
+			while (Order[B] > Order[A])
+			{
+				B = Dominators[B];
+			}
+		}
+		return A;
+	};
+	bool bChanged = true;
+	while (bChanged)
+	{
+		bChanged = false;
+		for (int32 Index = 1; Index < NumNodes; ++Index)
+		{
+			const int32 NodeIndex = ReversePostOrder[Index];
+			int32 NewDominator = INDEX_NONE;
+			for (const int32 Predecessor : Predecessors[NodeIndex])
+			{
+				if (Dominators[Predecessor] != INDEX_NONE)
+				{
+					NewDominator = NewDominator == INDEX_NONE ? Predecessor : Intersect(Predecessor, NewDominator);
+				}
+			}
+			if (Dominators[NodeIndex] != NewDominator)
+			{
+				Dominators[NodeIndex] = NewDominator;
+				bChanged = true;
+			}
+		}
+	}
+
+	// 4. 支配子树的大小：逆后序中支配者总在前面，倒着累加一遍即可
+	TArray<int64> RetainedBytes = Sizes;
+	TArray<int32> RetainedPackages;
+	RetainedPackages.Init(1, NumNodes);
+	for (int32 Index = NumNodes - 1; Index > 0; --Index)
+	{
+		const int32 NodeIndex = ReversePostOrder[Index];
+		RetainedBytes[Dominators[NodeIndex]] += RetainedBytes[NodeIndex];
+		RetainedPackages[Dominators[NodeIndex]] += RetainedPackages[NodeIndex];
+	}
+
+	// 支配树上的先序/后序区间，O(1) 判断支配关系
+	TArray<TArray<int32>> DominatorChildren;
+	DominatorChildren.SetNum(NumNodes);
+	for (int32 NodeIndex = 1; NodeIndex < NumNodes; ++NodeIndex)
+	{
+		DominatorChildren[Dominators[NodeIndex]].Add(NodeIndex);
+	}
+	TArray<int32> Enter;
+	TArray<int32> Exit;
+	Enter.SetNumZeroed(NumNodes);
+	Exit.SetNumZeroed(NumNodes);
+	{
+		int32 Clock = 0;
+		TArray<TPair<int32, int32>> Stack;
+		Stack.Emplace(0, 0);
+		Enter[0] = Clock++;
+		while (Stack.Num() > 0)
+		{
+			TPair<int32, int32>& Top = Stack.Last();
+			if (Top.Value < DominatorChildren[Top.Key].Num())
+			{
+				const int32 Child = DominatorChildren[Top.Key][Top.Value++];
+				Enter[Child] = Clock++;
+				Stack.Emplace(Child, 0);
+			}
+			else
+			{
+				Exit[Top.Key] = Clock++;
+				Stack.Pop(EAllowShrinking::No);
+			}
+		}
+	}
+	auto Dominates = [&Enter, &Exit](int32 A, int32 B)
+	{
+		return Enter[A] <= Enter[B] && Exit[B] <= Exit[A];
+	};
+
+	// 5. 给每条边打分，只有断开后目标不可达的边才能单独省下内容
+	for (int32 NodeIndex = 1; NodeIndex < NumNodes; ++NodeIndex)
+	{
+		const TArray<int32>& NodePredecessors = Predecessors[NodeIndex];
+		int32 NumOutsidePredecessors = 0;
+		int32 OutsidePredecessor = INDEX_NONE;
+		for (const int32 Predecessor : NodePredecessors)
+		{
+			if (!Dominates(NodeIndex, Predecessor))
+			{
+				++NumOutsidePredecessors;
+				OutsidePredecessor = Predecessor;
+			}
+		}
+		if (NumOutsidePredecessors != 1)
+		{
+			continue;
+		}
+
+		FSuperManagerLoadChainEdge& Edge = Result->Edges.AddDefaulted_GetRef();
+		Edge.Referencer = Names[OutsidePredecessor];
+		Edge.Dependency = Names[NodeIndex];
+		Edge.RetainedBytes = RetainedBytes[NodeIndex];
+		Edge.RetainedPackages = RetainedPackages[NodeIndex];
+	}
+	Result->Edges.Sort([](const FSuperManagerLoadChainEdge& A, const FSuperManagerLoadChainEdge& B)
+	{
+		return A.RetainedBytes > B.RetainedBytes;
+	});
+	if (Result->Edges.Num() > MaxEdges)
+	{
+		Result->Edges.SetNum(MaxEdges);
+	}
+
+	Result->ImmediateDominators.Reserve(NumNodes - 1);
+	for (int32 NodeIndex = 1; NodeIndex < NumNodes; ++NodeIndex)
+	{
+		Result->ImmediateDominators.Add(Names[NodeIndex], Names[Dominators[NodeIndex]]);
+	}
+	Result->NumPackages = NumNodes;
+	Result->TotalBytes = RetainedBytes[0];
+	Result->AnalysisSeconds = FPlatformTime::Seconds() - StartTime;
+	return Result;
+}
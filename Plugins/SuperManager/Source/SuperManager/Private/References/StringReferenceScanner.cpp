@@ -0,0 +1,452 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "References/StringReferenceScanner.h"
+
+#include "Algo/AnyOf.h"
+#include "Algo/Count.h"
+#include "Algo/Transform.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/ARFilter.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "References/AhoCorasickMatcher.h"
+#include "Settings/SuperManagerSettings.h"
+
+namespace SuperManagerStringReferenceScanner
+{
+	const TCHAR* CacheFileName = TEXT("StringReferences.bin");
+	constexpr uint32 CacheVersion = 1;
+
+	// 这些目录里只有生成文件或二进制文件，不往下遍历
+	const TCHAR* IgnoredDirectoryNames[] = {
+		TEXT("Binaries"), TEXT("Intermediate"), TEXT("Saved"), TEXT("DerivedDataCache"), TEXT("Content"), TEXT(".git")
+	};
+
+	bool IsPathChar(TCHAR Char)
+	{
+		return FChar::IsAlnum(Char) || Char == TEXT('_') || Char == TEXT('/');
+	}
+
+	FString GetCacheFilePath()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SuperManager"), CacheFileName);
+	}
+}
+
+FSuperManagerStringReferenceScanner::FSuperManagerStringReferenceScanner(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler)
+	: TaskScheduler(InTaskScheduler)
+{
+}
+
+void FSuperManagerStringReferenceScanner::Initialize()
+{
+	LoadCache();
+
+	// 注册表加载完之前拿到的包名不全，等加载完再做第一次扫描
+	IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	if (AssetRegistry.IsLoadingAssets())
+	{
+		FilesLoadedHandle = AssetRegistry.OnFilesLoaded().AddSP(this, &FSuperManagerStringReferenceScanner::ScanAfterFilesLoaded);
+	}
+	else
+	{
+		ScanAfterFilesLoaded();
+	}
+}
+
+void FSuperManagerStringReferenceScanner::Shutdown()
+{
+	if (FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.OnFilesLoaded().Remove(FilesLoadedHandle);
+	}
+
+	FScopeLock ScanLock(&ScanCS);
+	SaveCache();
+}
+
+bool FSuperManagerStringReferenceScanner::IsReferenced(FName PackageName, TArray<FString>* OutFiles) const
+{
+	FReadScopeLock ScopeLock(ReferencesLock);
+	const TArray<FString>* Files = References.Find(PackageName);
+	if (Files && OutFiles)
+	{
+		*OutFiles = *Files;
+	}
+	return Files != nullptr;
+}
+
+void FSuperManagerStringReferenceScanner::RequestScan(const FSuperManagerCancellationTokenRef& Token, TFunction<void()>&& OnFinished,
+                                                      ESuperManagerTaskPriority Priority)
+{
+	TWeakPtr<FSuperManagerStringReferenceScanner> WeakThis = AsShared();
+	TaskScheduler->LaunchWorker(TEXT("SuperManager.ScanStringReferences"),
+		[WeakThis, Options = MakeScanOptions(), Token, OnFinished = MoveTemp(OnFinished)](const FSuperManagerCancellationToken&) mutable
+		{
+			const TSharedPtr<FSuperManagerStringReferenceScanner> This = WeakThis.Pin();
+			if (!This.IsValid())
+			{
+				return;
+			}
+
+			TArray<FName> ChangedPackages = This->Scan(Options);
+			This->TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.StringReferencesReady"),
+				[WeakThis, ChangedPackages = MoveTemp(ChangedPackages), OnFinished = MoveTemp(OnFinished)]()
+				{
+					const TSharedPtr<FSuperManagerStringReferenceScanner> This = WeakThis.Pin();
+					if (This.IsValid() && ChangedPackages.Num() > 0)
+					{
+						This->ReferencesChangedEvent.Broadcast(ChangedPackages);
+					}
+					if (OnFinished)
+					{
+						OnFinished();
+					}
+					return true;
+				}, Token, ESuperManagerTaskPriority::High);
+		}, Token, Priority);
+}
+
+void FSuperManagerStringReferenceScanner::ScanBlocking()
+{
+	const TArray<FName> ChangedPackages = Scan(MakeScanOptions());
+	if (ChangedPackages.Num() > 0)
+	{
+		ReferencesChangedEvent.Broadcast(ChangedPackages);
+	}
+}
+
+void FSuperManagerStringReferenceScanner::ScanAfterFilesLoaded()
+{
+	RequestScan(FSuperManagerTaskScheduler::MakeToken(), nullptr, ESuperManagerTaskPriority::Background);
+}
+
+FSuperManagerStringReferenceScanner::FScanOptions FSuperManagerStringReferenceScanner::MakeScanOptions()
+{
+	FScanOptions Options;
+	const USuperManagerSettings* Settings = USuperManagerSettings::Get();
+	if (!Settings->bScanStringReferences)
+	{
+		return Options;
+	}
+
+	// 只匹配项目自己的内容，引擎和引擎插件的资产不会被删除
+	Options.ContentRoots.Add(TEXT("/Game"));
+	for (const TSharedRef<IPlugin>& Plugin : IPluginManager::Get().GetEnabledPluginsWithContent())
+	{
+		if (Plugin->GetLoadedFrom() == EPluginLoadedFrom::Project)
+		{
+			FString MountedPath = Plugin->GetMountedAssetPath();
+			MountedPath.RemoveFromEnd(TEXT("/"));
+			Options.ContentRoots.Add(MoveTemp(MountedPath));
+		}
+	}
+
+	Options.Directories.Add(FPaths::ConvertRelativePathToFull(FPaths::ProjectConfigDir()));
+	Options.Directories.Add(FPaths::ConvertRelativePathToFull(FPaths::GameSourceDir()));
+	Options.Directories.Add(FPaths::ConvertRelativePathToFull(FPaths::ProjectPluginsDir()));
+	for (const FString& Directory : Settings->AdditionalStringReferenceDirectories)
+	{
+		Options.Directories.Add(FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Directory));
+	}
+
+	for (const FString& Extension : Settings->StringReferenceExtensions)
+	{
+		FString CleanExtension = Extension;
+		CleanExtension.RemoveFromStart(TEXT("."));
+		Options.Extensions.Add(MoveTemp(CleanExtension));
+	}
+	return Options;
+}
+
+void FSuperManagerStringReferenceScanner::GatherFiles(const FScanOptions& Options, TArray<TPair<FString, FDateTime>>& OutFiles)
+{
+	IFileManager& FileManager = IFileManager::Get();
+	TSet<FString> VisitedFiles;
+	TArray<FString> PendingDirectories;
+	for (const FString& Directory : Options.Directories)
+	{
+		PendingDirectories.Add(Directory);
+		while (PendingDirectories.Num() > 0)
+		{
+			const FString CurrentDirectory = PendingDirectories.Pop(EAllowShrinking::No);
+			FileManager.IterateDirectoryStat(*CurrentDirectory, [&](const TCHAR* Path, const FFileStatData& StatData)
+			{
+				if (StatData.bIsDirectory)
+				{
+					const FString DirectoryName = FPaths::GetCleanFilename(Path);
+					const bool bIgnored = Algo::AnyOf(SuperManagerStringReferenceScanner::IgnoredDirectoryNames, [&DirectoryName](const TCHAR* Name)
+					{
+						return DirectoryName.Equals(Name, ESearchCase::IgnoreCase);
+					});
+					if (!bIgnored)
+					{
+						PendingDirectories.Add(Path);
+					}
+				}
+				else if (Options.Extensions.Contains(FPaths::GetExtension(Path)))
+				{
+					// 附加目录可能与默认目录重叠
+					FString FilePath(Path);
+					bool bAlreadyVisited = false;
+					VisitedFiles.Add(FilePath, &bAlreadyVisited);
+					if (!bAlreadyVisited)
+					{
+						OutFiles.Emplace(MoveTemp(FilePath), StatData.ModificationTime);
+					}
+				}
+				return true;
+			});
+		}
+	}
+}
+
+void FSuperManagerStringReferenceScanner::ScanFile(const FString& FilePath, const FSuperManagerAhoCorasickMatcher& Matcher,
+                                                   const TArray<FName>& PatternNames, TArray<FName>& OutPackages)
+{
+	FString Text;
+	if (!FFileHelper::LoadFileToString(Text, *FilePath))
+	{
+		return;
+	}
+
+	Matcher.Scan(Text, [&Text, &PatternNames, &OutPackages](int32 PatternIndex, int32 EndIndex)
+	{
+		// 两端紧挨着路径字符时是更长路径的一部分，例如 /Game/A 出现在 /Game/AB 或 /Game/A/B 里
+		const FName PackageName = PatternNames[PatternIndex];
+		const int32 StartIndex = EndIndex - static_cast<int32>(PackageName.GetStringLength());
+		if ((StartIndex > 0 && SuperManagerStringReferenceScanner::IsPathChar(Text[StartIndex - 1])) ||
+			(EndIndex < Text.Len() && SuperManagerStringReferenceScanner::IsPathChar(Text[EndIndex])))
+		{
+			return;
+		}
+		OutPackages.AddUnique(PackageName);
+	});
+}
+
+TArray<FName> FSuperManagerStringReferenceScanner::Scan(const FScanOptions& Options)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SuperManager_ScanStringReferences);
+	FScopeLock ScanLock(&ScanCS);
+	const double StartTime = FPlatformTime::Seconds();
+
+	TMap<FName, TArray<FString>> NewReferences;
+	if (Options.Directories.Num() > 0)
+	{
+		TSet<FName> CurrentPackages;
+		{
+			FARFilter Filter;
+			for (const FString& ContentRoot : Options.ContentRoots)
+			{
+				Filter.PackagePaths.Add(FName(*ContentRoot));
+			}
+			Filter.bRecursivePaths = true;
+			Filter.bIncludeOnlyOnDiskAssets = true;
+
+			TArray<FAssetData> Assets;
+			IAssetRegistry::GetChecked().GetAssets(Filter, Assets);
+			CurrentPackages.Reserve(Assets.Num());
+			for (const FAssetData& Asset : Assets)
+			{
+				CurrentPackages.Add(Asset.PackageName);
+			}
+		}
+
+		TArray<TPair<FString, FDateTime>> Files;
+		GatherFiles(Options, Files);
+
+		TArray<bool> NeedsFullScan;
+		NeedsFullScan.SetNumUninitialized(Files.Num());
+		bool bAnyFullScan = false;
+		for (int32 Index = 0; Index < Files.Num(); ++Index)
+		{
+			const FFileEntry* Entry = FileEntries.Find(Files[Index].Key);
+			NeedsFullScan[Index] = !Entry || Entry->Timestamp != Files[Index].Value;
+			bAnyFullScan |= NeedsFullScan[Index];
+		}
+
+		// 修改过的文件要对全部包名扫描，未修改的文件只需要对缓存之后新出现的包名补扫
+		FSuperManagerAhoCorasickMatcher AllMatcher;
+		FSuperManagerAhoCorasickMatcher NewMatcher;
+		TArray<FName> AllNames;
+		TArray<FName> NewNames;
+		TStringBuilder<256> PackageNameString;
+		for (const FName PackageName : CurrentPackages)
+		{
+			PackageNameString.Reset();
+			PackageName.AppendString(PackageNameString);
+			if (bAnyFullScan && AllMatcher.AddPattern(PackageNameString.ToView()) == AllNames.Num())
+			{
+				AllNames.Add(PackageName);
+			}
+			if (!ScannedPackages.Contains(PackageName) && NewMatcher.AddPattern(PackageNameString.ToView()) == NewNames.Num())
+			{
+				NewNames.Add(PackageName);
+			}
+		}
+		AllMatcher.Build();
+		NewMatcher.Build();
+
+		TArray<TArray<FName>> PackagesPerFile;
+		PackagesPerFile.SetNum(Files.Num());
+		ParallelFor(Files.Num(), [&](int32 Index)
+		{
+			const FString& FilePath = Files[Index].Key;
+			TArray<FName>& Packages = PackagesPerFile[Index];
+			if (NeedsFullScan[Index])
+			{
+				ScanFile(FilePath, AllMatcher, AllNames, Packages);
+				return;
+			}
+
+			for (const FName PackageName : FileEntries.FindChecked(FilePath).Packages)
+			{
+				if (CurrentPackages.Contains(PackageName))
+				{
+					Packages.Add(PackageName);
+				}
+			}
+			if (NewNames.Num() > 0)
+			{
+				ScanFile(FilePath, NewMatcher, NewNames, Packages);
+			}
+		});
+
+		const int32 NumFullScans = Algo::Count(NeedsFullScan, true);
+		bCacheDirty |= NumFullScans > 0 || NewNames.Num() > 0 || Files.Num() != FileEntries.Num() ||
+			CurrentPackages.Num() != ScannedPackages.Num();
+
+		TMap<FString, FFileEntry> NewEntries;
+		NewEntries.Reserve(Files.Num());
+		for (int32 Index = 0; Index < Files.Num(); ++Index)
+		{
+			for (const FName PackageName : PackagesPerFile[Index])
+			{
+				NewReferences.FindOrAdd(PackageName).Add(Files[Index].Key);
+			}
+
+			FFileEntry& Entry = NewEntries.Add(MoveTemp(Files[Index].Key));
+			Entry.Timestamp = Files[Index].Value;
+			Entry.Packages = MoveTemp(PackagesPerFile[Index]);
+		}
+		FileEntries = MoveTemp(NewEntries);
+		ScannedPackages = MoveTemp(CurrentPackages);
+
+		UE_LOG(LogTemp, Display, TEXT("SuperManager: scanned %d of %d text files for %d package names (%d new) in %.2f s, %d packages referenced by path"),
+		       NumFullScans, FileEntries.Num(), ScannedPackages.Num(), NewNames.Num(), FPlatformTime::Seconds() - StartTime,
+		       NewReferences.Num());
+	}
+
+	TArray<FName> ChangedPackages;
+	FWriteScopeLock ScopeLock(ReferencesLock);
+	for (const TPair<FName, TArray<FString>>& Pair : References)
+	{
+		if (!NewReferences.Contains(Pair.Key))
+		{
+			ChangedPackages.Add(Pair.Key);
+		}
+	}
+	for (const TPair<FName, TArray<FString>>& Pair : NewReferences)
+	{
+		if (!References.Contains(Pair.Key))
+		{
+			ChangedPackages.Add(Pair.Key);
+		}
+	}
+	References = MoveTemp(NewReferences);
+	return ChangedPackages;
+}
+
+void FSuperManagerStringReferenceScanner::LoadCache()
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*SuperManagerStringReferenceScanner::GetCacheFilePath()));
+	if (!Reader.IsValid())
+	{
+		return;
+	}
+
+	uint32 FileVersion = 0;
+	*Reader << FileVersion;
+	if (FileVersion != SuperManagerStringReferenceScanner::CacheVersion)
+	{
+		return;
+	}
+
+	// FName 在普通文件归档里不会被序列化，按字符串存取
+	TArray<FString> PackageNames;
+	*Reader << PackageNames;
+
+	int32 NumFiles = 0;
+	*Reader << NumFiles;
+	TMap<FString, FFileEntry> LoadedEntries;
+	LoadedEntries.Reserve(NumFiles);
+	for (int32 Index = 0; Index < NumFiles && !Reader->IsError(); ++Index)
+	{
+		FString FilePath;
+		TArray<FString> FilePackages;
+		FFileEntry Entry;
+		*Reader << FilePath;
+		*Reader << Entry.Timestamp;
+		*Reader << FilePackages;
+		Algo::Transform(FilePackages, Entry.Packages, [](const FString& PackageName) { return FName(*PackageName); });
+		LoadedEntries.Add(MoveTemp(FilePath), MoveTemp(Entry));
+	}
+	if (Reader->IsError())
+	{
+		return;
+	}
+
+	FScopeLock ScanLock(&ScanCS);
+	FileEntries = MoveTemp(LoadedEntries);
+	ScannedPackages.Reset();
+	for (const FString& PackageName : PackageNames)
+	{
+		ScannedPackages.Add(FName(*PackageName));
+	}
+	bCacheDirty = false;
+}
+
+void FSuperManagerStringReferenceScanner::SaveCache()
+{
+	// 与指纹缓存一样，分片审计的工作进程不写回
+	if (!bCacheDirty || FParse::Param(FCommandLine::Get(), TEXT("SuperManagerReadOnlyCache")))
+	{
+		return;
+	}
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*SuperManagerStringReferenceScanner::GetCacheFilePath()));
+	if (!Writer.IsValid())
+	{
+		return;
+	}
+
+	uint32 FileVersion = SuperManagerStringReferenceScanner::CacheVersion;
+	*Writer << FileVersion;
+
+	TArray<FString> PackageNames;
+	Algo::Transform(ScannedPackages, PackageNames, [](FName PackageName) { return PackageName.ToString(); });
+	*Writer << PackageNames;
+
+	int32 NumFiles = FileEntries.Num();
+	*Writer << NumFiles;
+	for (const TPair<FString, FFileEntry>& Pair : FileEntries)
+	{
+		FString FilePath = Pair.Key;
+		FDateTime Timestamp = Pair.Value.Timestamp;
+		TArray<FString> FilePackages;
+		Algo::Transform(Pair.Value.Packages, FilePackages, [](FName PackageName) { return PackageName.ToString(); });
+		*Writer << FilePath;
+		*Writer << Timestamp;
+		*Writer << FilePackages;
+	}
+	bCacheDirty = false;
+}
@@ -0,0 +1,802 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Scripting/SuperManagerScriptLibrary.h"
+
+#include "AssetToolsModule.h"
+#include "EditorAssetLibrary.h"
+#include "ObjectTools.h"
+#include "SuperManager.h"
+#include "AssetActions/QuickAssetAction.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Async/ParallelFor.h"
+#include "References/StringReferenceScanner.h"
+#include "Settings/SuperManagerSettings.h"
+#include "UObject/ObjectRedirector.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace SuperManagerScriptLibrary
+{
+	using FApplyFunction = void(*)(const TArray<UObject*>&, FSuperManagerScriptResult&);
+
+	FSuperManagerModule& GetModule()
+	{
+		return FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	}
+
+	void AddSkipped(FSuperManagerScriptResult& OutResult, const FString& PackagePath, const FString& Reason)
+	{
+		FSuperManagerScriptSkippedAsset& Skipped = OutResult.Skipped.AddDefaulted_GetRef();
+		Skipped.PackagePath = PackagePath;
+		Skipped.Reason = Reason;
+	}
+
+	// 输入统一转成包名后只查询一次注册表
+	// bAllAssets 为假时按包处理，一个包里有多个资产时取与包同名的那个；为真时返回包里的每个资产
+	TArray<TSharedPtr<FAssetData>> ResolvePackages(const TArray<FString>& PackagePaths, FSuperManagerScriptResult& OutResult, bool bAllAssets = false)
+	{
+		TArray<FName> PackageNames;
+		TSet<FName> SeenPackageNames;
+		for (const FString& PackagePath : PackagePaths)
+		{
+			FString PackageName = FPackageName::ObjectPathToPackageName(PackagePath);
+			PackageName.RemoveFromEnd(TEXT("/"));
+			if (!FPackageName::IsValidLongPackageName(PackageName))
+			{
+				AddSkipped(OutResult, PackagePath, TEXT("不是有效的包名"));
+				continue;
+			}
+			bool bAlreadyAdded = false;
+			SeenPackageNames.Add(FName(*PackageName), &bAlreadyAdded);
+			if (!bAlreadyAdded)
+			{
+				PackageNames.Emplace(*PackageName);
+			}
+		}
+
+		TArray<FAssetData> Assets;
+		if (PackageNames.Num() > 0)
+		{
+			FARFilter Filter;
+			Filter.PackageNames = PackageNames;
+			IAssetRegistry::GetChecked().GetAssets(Filter, Assets);
+		}
+
+		TMap<FName, TArray<TSharedPtr<FAssetData>>> AssetsByPackage;
+		AssetsByPackage.Reserve(Assets.Num());
+		for (FAssetData& AssetData : Assets)
+		{
+			TArray<TSharedPtr<FAssetData>>& PackageAssets = AssetsByPackage.FindOrAdd(AssetData.PackageName);
+			if (bAllAssets || PackageAssets.IsEmpty())
+			{
+				PackageAssets.Add(MakeShared<FAssetData>(MoveTemp(AssetData)));
+			}
+			else if (AssetData.AssetName == FName(FPackageName::GetShortName(AssetData.PackageName)))
+			{
+				PackageAssets[0] = MakeShared<FAssetData>(MoveTemp(AssetData));
+			}
+		}
+
+		TArray<TSharedPtr<FAssetData>> Resolved;
+		Resolved.Reserve(Assets.Num());
+		for (const FName PackageName : PackageNames)
+		{
+			if (const TArray<TSharedPtr<FAssetData>>* Found = AssetsByPackage.Find(PackageName))
+			{
+				Resolved.Append(*Found);
+			}
+			else
+			{
+				AddSkipped(OutResult, PackageName.ToString(), TEXT("注册表中不存在"));
+			}
+		}
+		return Resolved;
+	}
+
+	// 工作线程安全。bTransitive 为假时和面板的未使用条件一致：没有引用者，也没有被文本文件引用
+	// 为真时求这一批内的最大不动点：被批外的包或文本文件引用的包是使用中的，使用中的包引用的批内包也是使用中的
+	TArray<TSharedPtr<FAssetData>> ComputeUnused(const TArray<TSharedPtr<FAssetData>>& Assets, bool bTransitive,
+	                                             const FSuperManagerStringReferenceScanner& StringReferenceScanner)
+	{
+		const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+
+		TMap<FName, int32> IndexByPackage;
+		IndexByPackage.Reserve(Assets.Num());
+		for (int32 Index = 0; Index < Assets.Num(); ++Index)
+		{
+			IndexByPackage.Add(Assets[Index]->PackageName, Index);
+		}
+
+		TArray<TArray<FName>> ReferencersPerAsset;
+		ReferencersPerAsset.SetNum(Assets.Num());
+		TArray<bool> UsedFlags;
+		UsedFlags.SetNumZeroed(Assets.Num());
+		ParallelFor(Assets.Num(), [&Assets, bTransitive, &StringReferenceScanner, &AssetRegistry, &IndexByPackage, &ReferencersPerAsset, &UsedFlags](int32 Index)
+		{
+			const FName PackageName = Assets[Index]->PackageName;
+			TArray<FName>& Referencers = ReferencersPerAsset[Index];
+			AssetRegistry.GetReferencers(PackageName, Referencers);
+			Referencers.Remove(PackageName);
+
+			bool bUsed = StringReferenceScanner.IsReferenced(PackageName);
+			for (const FName Referencer : Referencers)
+			{
+				bUsed = bUsed || !bTransitive || !IndexByPackage.Contains(Referencer);
+			}
+			UsedFlags[Index] = bUsed;
+		});
+
+		if (bTransitive)
+		{
+			// 批内包 -> 它引用的批内包，从使用中的包出发把能到达的都标为使用中
+			TArray<TArray<int32>> ReferencedPerAsset;
+			ReferencedPerAsset.SetNum(Assets.Num());
+			TArray<int32> UsedStack;
+			for (int32 Index = 0; Index < Assets.Num(); ++Index)
+			{
+				for (const FName Referencer : ReferencersPerAsset[Index])
+				{
+					if (const int32* ReferencerIndex = IndexByPackage.Find(Referencer))
+					{
+						ReferencedPerAsset[*ReferencerIndex].Add(Index);
+					}
+				}
+				if (UsedFlags[Index])
+				{
+					UsedStack.Add(Index);
+				}
+			}
+			while (UsedStack.Num() > 0)
+			{
+				const int32 UsedIndex = UsedStack.Pop(EAllowShrinking::No);
+				for (const int32 ReferencedIndex : ReferencedPerAsset[UsedIndex])
+				{
+					if (!UsedFlags[ReferencedIndex])
+					{
+						UsedFlags[ReferencedIndex] = true;
+						UsedStack.Add(ReferencedIndex);
+					}
+				}
+			}
+		}
+
+		TArray<TSharedPtr<FAssetData>> UnusedAssets;
+		for (int32 Index = 0; Index < Assets.Num(); ++Index)
+		{
+			if (!UsedFlags[Index])
+			{
+				UnusedAssets.Add(Assets[Index]);
+			}
+		}
+		return UnusedAssets;
+	}
+
+	void AppendPackagePaths(const TArray<TSharedPtr<FAssetData>>& Assets, FSuperManagerScriptResult& OutResult)
+	{
+		for (const TSharedPtr<FAssetData>& AssetData : Assets)
+		{
+			OutResult.PackagePaths.Add(AssetData->PackageName.ToString());
+		}
+	}
+
+	// 工作线程安全：只保留被删除后不会留下断开引用的包
+	TArray<TSharedPtr<FAssetData>> FilterDeletable(const TArray<TSharedPtr<FAssetData>>& Assets,
+	                                               const FSuperManagerStringReferenceScanner& StringReferenceScanner,
+	                                               FSuperManagerScriptResult& OutResult)
+	{
+		TArray<TSharedPtr<FAssetData>> Deletable = ComputeUnused(Assets, true, StringReferenceScanner);
+		TSet<FName> DeletablePackages;
+		for (const TSharedPtr<FAssetData>& AssetData : Deletable)
+		{
+			DeletablePackages.Add(AssetData->PackageName);
+		}
+		// 一个包里的多个资产只记一次
+		TSet<FName> SkippedPackages;
+		for (const TSharedPtr<FAssetData>& AssetData : Assets)
+		{
+			bool bAlreadySkipped = false;
+			if (!DeletablePackages.Contains(AssetData->PackageName))
+			{
+				SkippedPackages.Add(AssetData->PackageName, &bAlreadySkipped);
+				if (!bAlreadySkipped)
+				{
+					AddSkipped(OutResult, AssetData->PackageName.ToString(), TEXT("仍被这一批之外的包或文本文件引用"));
+				}
+			}
+		}
+		return Deletable;
+	}
+
+	TArray<TSharedPtr<FAssetData>> FilterRedirectors(const TArray<TSharedPtr<FAssetData>>& Assets, FSuperManagerScriptResult& OutResult)
+	{
+		TArray<TSharedPtr<FAssetData>> Redirectors;
+		for (const TSharedPtr<FAssetData>& AssetData : Assets)
+		{
+			if (AssetData->IsRedirector())
+			{
+				Redirectors.Add(AssetData);
+			}
+			else
+			{
+				AddSkipped(OutResult, AssetData->PackageName.ToString(), TEXT("不是重定向器"));
+			}
+		}
+		return Redirectors;
+	}
+
+	template <typename ValueType>
+	void AppendGroups(const TArray<TPair<FName, ValueType>>& Fingerprints, const TArray<TArray<int32>>& Groups, FSuperManagerScriptResult& OutResult)
+	{
+		for (const TArray<int32>& Group : Groups)
+		{
+			FSuperManagerScriptAssetGroup& ScriptGroup = OutResult.Groups.AddDefaulted_GetRef();
+			for (const int32 Index : Group)
+			{
+				ScriptGroup.PackagePaths.Add(Fingerprints[Index].Key.ToString());
+			}
+			OutResult.PackagePaths.Append(ScriptGroup.PackagePaths);
+		}
+	}
+
+	void GroupSameName(const TArray<TSharedPtr<FAssetData>>& Assets, FSuperManagerScriptResult& OutResult)
+	{
+		TMap<FName, FSuperManagerScriptAssetGroup> GroupsByName;
+		for (const TSharedPtr<FAssetData>& AssetData : Assets)
+		{
+			GroupsByName.FindOrAdd(AssetData->AssetName).PackagePaths.Add(AssetData->PackageName.ToString());
+		}
+		for (TPair<FName, FSuperManagerScriptAssetGroup>& Pair : GroupsByName)
+		{
+			if (Pair.Value.PackagePaths.Num() > 1)
+			{
+				OutResult.PackagePaths.Append(Pair.Value.PackagePaths);
+				OutResult.Groups.Add(MoveTemp(Pair.Value));
+			}
+		}
+	}
+
+	void GroupTextureHashes(const FSuperManagerTextureSimilarity::FResults& TextureHashes, FSuperManagerScriptResult& OutResult)
+	{
+		TArray<TArray<int32>> Groups;
+		FSuperManagerTextureSimilarity::GroupNearDuplicates(TextureHashes, USuperManagerSettings::Get()->SimilarTextureMaxDistance, Groups);
+		AppendGroups(TextureHashes, Groups, OutResult);
+	}
+
+	void GroupMeshFingerprints(const FSuperManagerMeshDuplicates::FResults& MeshFingerprints, FSuperManagerScriptResult& OutResult)
+	{
+		TArray<TArray<int32>> Groups;
+		FSuperManagerMeshDuplicates::GroupDuplicates(MeshFingerprints, Groups);
+		AppendGroups(MeshFingerprints, Groups, OutResult);
+	}
+
+	void GroupMaterialInstanceFingerprints(const FSuperManagerMaterialInstanceDuplicates::FResults& MaterialInstanceFingerprints,
+	                                       FSuperManagerScriptResult& OutResult)
+	{
+		TArray<TArray<int32>> Groups;
+		FSuperManagerMaterialInstanceDuplicates::GroupDuplicates(MaterialInstanceFingerprints, Groups);
+		AppendGroups(MaterialInstanceFingerprints, Groups, OutResult);
+	}
+
+	// 和右键菜单的添加前缀规则相同，所有重命名交给 AssetTools 一次完成
+	void ApplyPrefixes(const TArray<UObject*>& Objects, FSuperManagerScriptResult& OutResult)
+	{
+		const UQuickAssetAction* QuickAssetAction = GetDefault<UQuickAssetAction>();
+
+		TArray<FAssetRenameData> RenameData;
+		TArray<FString> OldPackageNames;
+		TArray<FString> NewPackageNames;
+		for (UObject* Object : Objects)
+		{
+			const FString PackageName = Object->GetOutermost()->GetName();
+			const FString* Prefix = QuickAssetAction->FindPrefixForClass(Object->GetClass());
+			if (!Prefix || Prefix->IsEmpty())
+			{
+				AddSkipped(OutResult, PackageName, TEXT("查找class的前缀失败:") + Object->GetClass()->GetName());
+				continue;
+			}
+			FString OldName = Object->GetName();
+			if (OldName.StartsWith(*Prefix))
+			{
+				AddSkipped(OutResult, PackageName, TEXT("已经存在前缀名"));
+				continue;
+			}
+			if (Object->IsA<UMaterialInstanceConstant>())
+			{
+				OldName.RemoveFromStart(TEXT("M_"));
+				OldName.RemoveFromEnd(TEXT("_Inst"));
+			}
+			const FString NewName = *Prefix + OldName;
+			const FString PackagePath = FPackageName::GetLongPackagePath(PackageName);
+
+			RenameData.Emplace(Object, PackagePath, NewName);
+			OldPackageNames.Add(PackageName);
+			NewPackageNames.Add(PackagePath / NewName);
+		}
+		if (RenameData.Num() == 0)
+		{
+			return;
+		}
+
+		const FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>(TEXT("AssetTools"));
+		AssetToolsModule.Get().RenameAssets(RenameData);
+
+		for (int32 Index = 0; Index < RenameData.Num(); ++Index)
+		{
+			const UObject* RenamedObject = RenameData[Index].Asset.Get();
+			if (RenamedObject && RenamedObject->GetOutermost()->GetName() == NewPackageNames[Index])
+			{
+				OutResult.PackagePaths.Add(NewPackageNames[Index]);
+			}
+			else
+			{
+				AddSkipped(OutResult, OldPackageNames[Index], TEXT("重命名为 ") + NewPackageNames[Index] + TEXT(" 失败"));
+			}
+		}
+	}
+
+	// 引用已经在 FilterDeletable 里检查过，这里直接删除，不再弹出确认对话框
+	void ApplyDelete(const TArray<UObject*>& Objects, FSuperManagerScriptResult& OutResult)
+	{
+		TArray<FString> PackageNames;
+		for (const UObject* Object : Objects)
+		{
+			PackageNames.AddUnique(Object->GetOutermost()->GetName());
+		}
+		if (Objects.Num() > 0)
+		{
+			ObjectTools::ForceDeleteObjects(Objects, false);
+		}
+
+		for (const FString& PackageName : PackageNames)
+		{
+			if (!FPackageName::DoesPackageExist(PackageName))
+			{
+				OutResult.PackagePaths.Add(PackageName);
+			}
+			else
+			{
+				AddSkipped(OutResult, PackageName, TEXT("删除失败"));
+			}
+		}
+	}
+
+	void ApplyFixUpRedirectors(const TArray<UObject*>& Objects, FSuperManagerScriptResult& OutResult)
+	{
+		TArray<UObjectRedirector*> Redirectors;
+		TArray<FString> PackageNames;
+		for (UObject* Object : Objects)
+		{
+			if (UObjectRedirector* Redirector = Cast<UObjectRedirector>(Object))
+			{
+				Redirectors.Add(Redirector);
+				PackageNames.Add(Redirector->GetOutermost()->GetName());
+			}
+		}
+		if (Redirectors.Num() == 0)
+		{
+			return;
+		}
+
+		// 不弹签出对话框，修复完的重定向器会被删除
+		const FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>(TEXT("AssetTools"));
+		AssetToolsModule.Get().FixupReferencers(Redirectors, false);
+
+		for (const FString& PackageName : PackageNames)
+		{
+			if (!FPackageName::DoesPackageExist(PackageName))
+			{
+				OutResult.PackagePaths.Add(PackageName);
+			}
+			else
+			{
+				AddSkipped(OutResult, PackageName, TEXT("仍有引用未能修复"));
+			}
+		}
+	}
+
+	// 命名规则与右键菜单的复制相同：原名_序号，放在原资产所在目录
+	void DuplicateOne(const FAssetData& AssetData, int32 CopyIndex, FSuperManagerScriptResult& OutResult)
+	{
+		const FString NewDuplicatedAssetName = AssetData.AssetName.ToString() + "_" + FString::FromInt(CopyIndex + 1);
+		const FString NewPathName = FPaths::Combine(AssetData.PackagePath.ToString(), NewDuplicatedAssetName);
+		if (UEditorAssetLibrary::DuplicateAsset(AssetData.GetObjectPathString(), NewPathName) && UEditorAssetLibrary::SaveAsset(NewPathName, false))
+		{
+			OutResult.PackagePaths.Add(NewPathName);
+		}
+		else
+		{
+			AddSkipped(OutResult, AssetData.PackageName.ToString(), TEXT("复制为 ") + NewPathName + TEXT(" 失败"));
+		}
+	}
+
+	struct FLoadState
+	{
+		TArray<TSharedPtr<FAssetData>> Assets;
+		TArray<TStrongObjectPtr<UObject>> Objects;
+		int32 NextIndex = 0;
+	};
+
+#pragma region 异步句柄
+	// 还没完成的 Async 调用，只在游戏线程访问
+	TMap<int64, FSuperManagerCancellationTokenRef> PendingTokens;
+	int64 NextHandleId = 0;
+
+	FSuperManagerCancellationTokenRef BeginAsync(FSuperManagerScriptHandle& OutHandle)
+	{
+		check(IsInGameThread());
+		const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+		OutHandle.Id = ++NextHandleId;
+		PendingTokens.Add(OutHandle.Id, Token);
+		return Token;
+	}
+
+	// 游戏线程：句柄失效后再回调，回调里可以马上发起新的调用
+	void Finish(const FSuperManagerCancellationTokenRef& Token, const FOnSuperManagerScriptFinished& OnFinished, const FSuperManagerScriptResult& Result)
+	{
+		for (auto It = PendingTokens.CreateIterator(); It; ++It)
+		{
+			if (It->Value == Token)
+			{
+				It.RemoveCurrent();
+				break;
+			}
+		}
+		OnFinished.ExecuteIfBound(Result);
+	}
+#pragma endregion
+
+	// 每次只加载一个资产，全部加载完返回true
+	bool LoadNext(FLoadState& State, FSuperManagerScriptResult& OutResult)
+	{
+		if (State.NextIndex < State.Assets.Num())
+		{
+			const FAssetData& AssetData = *State.Assets[State.NextIndex++];
+			if (UObject* Object = AssetData.GetAsset())
+			{
+				State.Objects.Emplace(Object);
+			}
+			else
+			{
+				AddSkipped(OutResult, AssetData.PackageName.ToString(), TEXT("加载失败"));
+			}
+		}
+		return State.NextIndex >= State.Assets.Num();
+	}
+
+	void Apply(const FLoadState& State, FApplyFunction ApplyFunction, FSuperManagerScriptResult& OutResult)
+	{
+		TArray<UObject*> Objects;
+		Objects.Reserve(State.Objects.Num());
+		for (const TStrongObjectPtr<UObject>& Object : State.Objects)
+		{
+			Objects.Add(Object.Get());
+		}
+		ApplyFunction(Objects, OutResult);
+	}
+
+	void LoadAndApply(TArray<TSharedPtr<FAssetData>>&& Assets, FApplyFunction ApplyFunction, FSuperManagerScriptResult& OutResult)
+	{
+		FLoadState State;
+		State.Assets = MoveTemp(Assets);
+		while (!LoadNext(State, OutResult))
+		{
+		}
+		Apply(State, ApplyFunction, OutResult);
+	}
+
+	// 按帧预算逐个加载，全部加载后在一个阶段里统一处理并回调；可以从任意线程调用
+	void EnqueueLoadAndApply(FSuperManagerTaskScheduler& TaskScheduler, TArray<TSharedPtr<FAssetData>>&& Assets, FApplyFunction ApplyFunction,
+	                         const TSharedRef<FSuperManagerScriptResult>& Result, const FOnSuperManagerScriptFinished& OnFinished,
+	                         const FSuperManagerCancellationTokenRef& Token)
+	{
+		const TSharedRef<FLoadState> State = MakeShared<FLoadState>();
+		State->Assets = MoveTemp(Assets);
+
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ScriptLoadAssets"), [State, Result]()
+		{
+			return LoadNext(*State, *Result);
+		}, Token);
+
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ScriptApply"), [State, ApplyFunction, Result, OnFinished, Token]()
+		{
+			Apply(*State, ApplyFunction, *Result);
+			Finish(Token, OnFinished, *Result);
+			return true;
+		}, Token);
+	}
+
+	void EnqueueFinished(FSuperManagerTaskScheduler& TaskScheduler, const TSharedRef<FSuperManagerScriptResult>& Result,
+	                     const FOnSuperManagerScriptFinished& OnFinished, const FSuperManagerCancellationTokenRef& Token)
+	{
+		TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ScriptFinished"), [Result, OnFinished, Token]()
+		{
+			Finish(Token, OnFinished, *Result);
+			return true;
+		}, Token, ESuperManagerTaskPriority::High);
+	}
+}
+
+#pragma region ListUnused
+
+FSuperManagerScriptResult USuperManagerScriptLibrary::ListUnusedAssets(const TArray<FString>& PackagePaths, bool bTransitive)
+{
+	FSuperManagerScriptResult Result;
+	const TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, Result);
+
+	const FSuperManagerModule& SuperManagerModule = SuperManagerScriptLibrary::GetModule();
+	SuperManagerModule.GetStringReferenceScanner()->ScanBlocking();
+	SuperManagerScriptLibrary::AppendPackagePaths(
+		SuperManagerScriptLibrary::ComputeUnused(Assets, bTransitive, *SuperManagerModule.GetStringReferenceScanner()), Result);
+	return Result;
+}
+
+FSuperManagerScriptHandle USuperManagerScriptLibrary::ListUnusedAssetsAsync(const TArray<FString>& PackagePaths, bool bTransitive, const FOnSuperManagerScriptFinished& OnFinished)
+{
+	const TSharedRef<FSuperManagerScriptResult> Result = MakeShared<FSuperManagerScriptResult>();
+	TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, *Result);
+
+	const FSuperManagerModule& SuperManagerModule = SuperManagerScriptLibrary::GetModule();
+	const TSharedRef<FSuperManagerTaskScheduler> TaskScheduler = SuperManagerModule.GetTaskScheduler().ToSharedRef();
+	const TSharedRef<FSuperManagerStringReferenceScanner> Scanner = SuperManagerModule.GetStringReferenceScanner().ToSharedRef();
+	FSuperManagerScriptHandle Handle;
+	const FSuperManagerCancellationTokenRef Token = SuperManagerScriptLibrary::BeginAsync(Handle);
+
+	// 文本引用重扫 -> 工作线程查引用 -> 游戏线程回调
+	Scanner->RequestScan(Token, [TaskScheduler, Scanner, Assets = MoveTemp(Assets), bTransitive, Result, OnFinished, Token]()
+	{
+		TaskScheduler->LaunchWorker(TEXT("SuperManager.ScriptListUnused"),
+			[TaskScheduler, Scanner, Assets, bTransitive, Result, OnFinished, Token](const FSuperManagerCancellationToken&)
+			{
+				SuperManagerScriptLibrary::AppendPackagePaths(SuperManagerScriptLibrary::ComputeUnused(Assets, bTransitive, *Scanner), *Result);
+				SuperManagerScriptLibrary::EnqueueFinished(*TaskScheduler, Result, OnFinished, Token);
+			}, Token, ESuperManagerTaskPriority::High);
+	});
+	return Handle;
+}
+
+#pragma endregion
+
+#pragma region FindDuplicates
+
+FSuperManagerScriptResult USuperManagerScriptLibrary::FindDuplicateGroups(const TArray<FString>& PackagePaths, ESuperManagerScriptDuplicateKind Kind)
+{
+	FSuperManagerScriptResult Result;
+	const TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, Result);
+
+	const FSuperManagerModule& SuperManagerModule = SuperManagerScriptLibrary::GetModule();
+	switch (Kind)
+	{
+	case ESuperManagerScriptDuplicateKind::SameName:
+		SuperManagerScriptLibrary::GroupSameName(Assets, Result);
+		break;
+	case ESuperManagerScriptDuplicateKind::SimilarTextures:
+		{
+			FSuperManagerTextureSimilarity::FResults TextureHashes;
+			SuperManagerModule.GetTextureSimilarity()->ComputeBlocking(Assets, TextureHashes);
+			SuperManagerScriptLibrary::GroupTextureHashes(TextureHashes, Result);
+			break;
+		}
+	case ESuperManagerScriptDuplicateKind::Meshes:
+		{
+			FSuperManagerMeshDuplicates::FResults MeshFingerprints;
+			SuperManagerModule.GetMeshDuplicates()->ComputeBlocking(Assets, MeshFingerprints);
+			SuperManagerScriptLibrary::GroupMeshFingerprints(MeshFingerprints, Result);
+			break;
+		}
+	case ESuperManagerScriptDuplicateKind::MaterialInstances:
+		{
+			FSuperManagerMaterialInstanceDuplicates::FResults MaterialInstanceFingerprints;
+			SuperManagerModule.GetMaterialInstanceDuplicates()->ComputeBlocking(Assets, MaterialInstanceFingerprints);
+			SuperManagerScriptLibrary::GroupMaterialInstanceFingerprints(MaterialInstanceFingerprints, Result);
+			break;
+		}
+	}
+	return Result;
+}
+
+FSuperManagerScriptHandle USuperManagerScriptLibrary::FindDuplicateGroupsAsync(const TArray<FString>& PackagePaths, ESuperManagerScriptDuplicateKind Kind,
+                                                                               const FOnSuperManagerScriptFinished& OnFinished)
+{
+	const TSharedRef<FSuperManagerScriptResult> Result = MakeShared<FSuperManagerScriptResult>();
+	const TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, *Result);
+
+	const FSuperManagerModule& SuperManagerModule = SuperManagerScriptLibrary::GetModule();
+	const TSharedRef<FSuperManagerTaskScheduler> TaskScheduler = SuperManagerModule.GetTaskScheduler().ToSharedRef();
+	FSuperManagerScriptHandle Handle;
+	const FSuperManagerCancellationTokenRef Token = SuperManagerScriptLibrary::BeginAsync(Handle);
+
+	// 指纹的加载和计算由各自的查找器按帧切片，完成时已经在游戏线程上
+	switch (Kind)
+	{
+	case ESuperManagerScriptDuplicateKind::SameName:
+		TaskScheduler->LaunchWorker(TEXT("SuperManager.ScriptGroupSameName"),
+			[TaskScheduler, Assets, Result, OnFinished, Token](const FSuperManagerCancellationToken&)
+			{
+				SuperManagerScriptLibrary::GroupSameName(Assets, *Result);
+				SuperManagerScriptLibrary::EnqueueFinished(*TaskScheduler, Result, OnFinished, Token);
+			}, Token, ESuperManagerTaskPriority::High);
+		break;
+	case ESuperManagerScriptDuplicateKind::SimilarTextures:
+		SuperManagerModule.GetTextureSimilarity()->Request(Assets, Token,
+			[Result, OnFinished, Token](const TSharedRef<const FSuperManagerTextureSimilarity::FResults>& TextureHashes)
+			{
+				SuperManagerScriptLibrary::GroupTextureHashes(*TextureHashes, *Result);
+				SuperManagerScriptLibrary::Finish(Token, OnFinished, *Result);
+			});
+		break;
+	case ESuperManagerScriptDuplicateKind::Meshes:
+		SuperManagerModule.GetMeshDuplicates()->Request(Assets, Token,
+			[Result, OnFinished, Token](const TSharedRef<const FSuperManagerMeshDuplicates::FResults>& MeshFingerprints)
+			{
+				SuperManagerScriptLibrary::GroupMeshFingerprints(*MeshFingerprints, *Result);
+				SuperManagerScriptLibrary::Finish(Token, OnFinished, *Result);
+			});
+		break;
+	case ESuperManagerScriptDuplicateKind::MaterialInstances:
+		SuperManagerModule.GetMaterialInstanceDuplicates()->Request(Assets, Token,
+			[Result, OnFinished, Token](const TSharedRef<const FSuperManagerMaterialInstanceDuplicates::FResults>& MaterialInstanceFingerprints)
+			{
+				SuperManagerScriptLibrary::GroupMaterialInstanceFingerprints(*MaterialInstanceFingerprints, *Result);
+				SuperManagerScriptLibrary::Finish(Token, OnFinished, *Result);
+			});
+		break;
+	}
+	return Handle;
+}
+
+#pragma endregion
+
+#pragma region BatchOperations
+
+FSuperManagerScriptResult USuperManagerScriptLibrary::AddPrefixes(const TArray<FString>& PackagePaths)
+{
+	FSuperManagerScriptResult Result;
+	TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, Result, true);
+	SuperManagerScriptLibrary::LoadAndApply(MoveTemp(Assets), &SuperManagerScriptLibrary::ApplyPrefixes, Result);
+	return Result;
+}
+
+FSuperManagerScriptHandle USuperManagerScriptLibrary::AddPrefixesAsync(const TArray<FString>& PackagePaths, const FOnSuperManagerScriptFinished& OnFinished)
+{
+	const TSharedRef<FSuperManagerScriptResult> Result = MakeShared<FSuperManagerScriptResult>();
+	TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, *Result, true);
+	FSuperManagerScriptHandle Handle;
+	SuperManagerScriptLibrary::EnqueueLoadAndApply(*SuperManagerScriptLibrary::GetModule().GetTaskScheduler(), MoveTemp(Assets),
+	                                               &SuperManagerScriptLibrary::ApplyPrefixes, Result, OnFinished,
+	                                               SuperManagerScriptLibrary::BeginAsync(Handle));
+	return Handle;
+}
+
+FSuperManagerScriptResult USuperManagerScriptLibrary::DuplicateAssets(const TArray<FString>& PackagePaths, int32 NumOfDuplicates)
+{
+	FSuperManagerScriptResult Result;
+	const TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, Result, true);
+	for (const TSharedPtr<FAssetData>& AssetData : Assets)
+	{
+		if (NumOfDuplicates <= 0)
+		{
+			SuperManagerScriptLibrary::AddSkipped(Result, AssetData->PackageName.ToString(), TEXT("复制份数需要大于0"));
+		}
+		for (int32 i = 0; i < NumOfDuplicates; i++)
+		{
+			SuperManagerScriptLibrary::DuplicateOne(*AssetData, i, Result);
+		}
+	}
+	return Result;
+}
+
+FSuperManagerScriptHandle USuperManagerScriptLibrary::DuplicateAssetsAsync(const TArray<FString>& PackagePaths, int32 NumOfDuplicates, const FOnSuperManagerScriptFinished& OnFinished)
+{
+	const TSharedRef<FSuperManagerScriptResult> Result = MakeShared<FSuperManagerScriptResult>();
+	const TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, *Result, true);
+
+	// 和右键菜单一样，每次复制+保存作为一个游戏线程阶段
+	FSuperManagerTaskScheduler& TaskScheduler = *SuperManagerScriptLibrary::GetModule().GetTaskScheduler();
+	FSuperManagerScriptHandle Handle;
+	const FSuperManagerCancellationTokenRef Token = SuperManagerScriptLibrary::BeginAsync(Handle);
+	for (const TSharedPtr<FAssetData>& AssetData : Assets)
+	{
+		if (NumOfDuplicates <= 0)
+		{
+			SuperManagerScriptLibrary::AddSkipped(*Result, AssetData->PackageName.ToString(), TEXT("复制份数需要大于0"));
+		}
+		for (int32 i = 0; i < NumOfDuplicates; i++)
+		{
+			TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ScriptDuplicateAsset"), [AssetData, i, Result]()
+			{
+				SuperManagerScriptLibrary::DuplicateOne(*AssetData, i, *Result);
+				return true;
+			}, Token);
+		}
+	}
+	TaskScheduler.EnqueueGameThreadStage(TEXT("SuperManager.ScriptFinished"), [Result, OnFinished, Token]()
+	{
+		SuperManagerScriptLibrary::Finish(Token, OnFinished, *Result);
+		return true;
+	}, Token);
+	return Handle;
+}
+
+FSuperManagerScriptResult USuperManagerScriptLibrary::DeleteAssets(const TArray<FString>& PackagePaths)
+{
+	FSuperManagerScriptResult Result;
+	const TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, Result, true);
+
+	const FSuperManagerModule& SuperManagerModule = SuperManagerScriptLibrary::GetModule();
+	SuperManagerModule.GetStringReferenceScanner()->ScanBlocking();
+	SuperManagerScriptLibrary::LoadAndApply(
+		SuperManagerScriptLibrary::FilterDeletable(Assets, *SuperManagerModule.GetStringReferenceScanner(), Result),
+		&SuperManagerScriptLibrary::ApplyDelete, Result);
+	return Result;
+}
+
+FSuperManagerScriptHandle USuperManagerScriptLibrary::DeleteAssetsAsync(const TArray<FString>& PackagePaths, const FOnSuperManagerScriptFinished& OnFinished)
+{
+	const TSharedRef<FSuperManagerScriptResult> Result = MakeShared<FSuperManagerScriptResult>();
+	TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, *Result, true);
+
+	const FSuperManagerModule& SuperManagerModule = SuperManagerScriptLibrary::GetModule();
+	const TSharedRef<FSuperManagerTaskScheduler> TaskScheduler = SuperManagerModule.GetTaskScheduler().ToSharedRef();
+	const TSharedRef<FSuperManagerStringReferenceScanner> Scanner = SuperManagerModule.GetStringReferenceScanner().ToSharedRef();
+	FSuperManagerScriptHandle Handle;
+	const FSuperManagerCancellationTokenRef Token = SuperManagerScriptLibrary::BeginAsync(Handle);
+
+	// 文本引用重扫 -> 工作线程查引用 -> 游戏线程逐个加载 -> 一次删除
+	Scanner->RequestScan(Token, [TaskScheduler, Scanner, Assets = MoveTemp(Assets), Result, OnFinished, Token]()
+	{
+		TaskScheduler->LaunchWorker(TEXT("SuperManager.ScriptFindDeletable"),
+			[TaskScheduler, Scanner, Assets, Result, OnFinished, Token](const FSuperManagerCancellationToken&)
+			{
+				SuperManagerScriptLibrary::EnqueueLoadAndApply(*TaskScheduler, SuperManagerScriptLibrary::FilterDeletable(Assets, *Scanner, *Result),
+				                                               &SuperManagerScriptLibrary::ApplyDelete, Result, OnFinished, Token);
+			}, Token, ESuperManagerTaskPriority::High);
+	});
+	return Handle;
+}
+
+FSuperManagerScriptResult USuperManagerScriptLibrary::FixUpRedirectors(const TArray<FString>& PackagePaths)
+{
+	FSuperManagerScriptResult Result;
+	const TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, Result);
+	SuperManagerScriptLibrary::LoadAndApply(SuperManagerScriptLibrary::FilterRedirectors(Assets, Result),
+	                                        &SuperManagerScriptLibrary::ApplyFixUpRedirectors, Result);
+	return Result;
+}
+
+FSuperManagerScriptHandle USuperManagerScriptLibrary::FixUpRedirectorsAsync(const TArray<FString>& PackagePaths, const FOnSuperManagerScriptFinished& OnFinished)
+{
+	const TSharedRef<FSuperManagerScriptResult> Result = MakeShared<FSuperManagerScriptResult>();
+	const TArray<TSharedPtr<FAssetData>> Assets = SuperManagerScriptLibrary::ResolvePackages(PackagePaths, *Result);
+	FSuperManagerScriptHandle Handle;
+	SuperManagerScriptLibrary::EnqueueLoadAndApply(*SuperManagerScriptLibrary::GetModule().GetTaskScheduler(),
+	                                               SuperManagerScriptLibrary::FilterRedirectors(Assets, *Result),
+	                                               &SuperManagerScriptLibrary::ApplyFixUpRedirectors, Result, OnFinished,
+	                                               SuperManagerScriptLibrary::BeginAsync(Handle));
+	return Handle;
+}
+
+#pragma endregion
+
+#pragma region Cancel
+
+bool USuperManagerScriptLibrary::CancelAsync(const FSuperManagerScriptHandle& Handle)
+{
+	check(IsInGameThread());
+	const FSuperManagerCancellationTokenRef* Token = SuperManagerScriptLibrary::PendingTokens.Find(Handle.Id);
+	if (!Token)
+	{
+		return false;
+	}
+	// 排队中的阶段和工作线程任务都会跳过，已经在执行的阶段做完为止
+	(*Token)->Cancel();
+	SuperManagerScriptLibrary::PendingTokens.Remove(Handle.Id);
+	return true;
+}
+
+bool USuperManagerScriptLibrary::IsAsyncRunning(const FSuperManagerScriptHandle& Handle)
+{
+	check(IsInGameThread());
+	return SuperManagerScriptLibrary::PendingTokens.Contains(Handle.Id);
+}
+
+#pragma endregion
@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Settings/SuperManagerSettings.h"
+
+USuperManagerSettings::USuperManagerSettings()
+{
+	ExcludedFolders.Add(TEXT("/Game/Developers"));
+	ExcludedFolders.Add(TEXT("/Game/Collections"));
+
+	StringReferenceExtensions = {
+		TEXT("ini"), TEXT("h"), TEXT("cpp"), TEXT("inl"), TEXT("cs"), TEXT("py"), TEXT("json"), TEXT("csv"), TEXT("txt"), TEXT("xml")
+	};
+}
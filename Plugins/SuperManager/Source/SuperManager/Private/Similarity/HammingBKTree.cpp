@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Similarity/HammingBKTree.h"
+
+int32 FSuperManagerHammingBKTree::Insert(uint64 Hash)
+{
+	if (Nodes.Num() == 0)
+	{
+		Nodes.AddDefaulted_GetRef().Hash = Hash;
+		return 0;
+	}
+
+	int32 NodeIndex = 0;
+	while (true)
+	{
+		const int32 NodeDistance = Distance(Nodes[NodeIndex].Hash, Hash);
+		if (NodeDistance == 0)
+		{
+			return NodeIndex;
+		}
+
+		const TPair<uint8, int32>* Child = Nodes[NodeIndex].Children.FindByPredicate([NodeDistance](const TPair<uint8, int32>& Pair)
+		{
+			return Pair.Key == NodeDistance;
+		});
+		if (!Child)
+		{
+			const int32 NewIndex = Nodes.Num();
+			Nodes.AddDefaulted_GetRef().Hash = Hash;
+			Nodes[NodeIndex].Children.Emplace(static_cast<uint8>(NodeDistance), NewIndex);
+			return NewIndex;
+		}
+		NodeIndex = Child->Value;
+	}
+}
+
+void FSuperManagerHammingBKTree::Query(uint64 Hash, int32 MaxDistance, TArray<int32>& OutNodes) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(EAllowShrinking::No)];
+		const int32 NodeDistance = Distance(Node.Hash, Hash);
+		if (NodeDistance <= MaxDistance)
+		{
+			OutNodes.Add(static_cast<int32>(&Node - Nodes.GetData()));
+		}
+
+		// 三角不等式：只有到该节点距离在 [d-Max, d+Max] 内的子树可能有结果
+		for (const TPair<uint8, int32>& Child : Node.Children)
+		{
+			if (FMath::Abs(Child.Key - NodeDistance) <= MaxDistance)
+			{
+				Stack.Add(Child.Value);
+			}
+		}
+	}
+}
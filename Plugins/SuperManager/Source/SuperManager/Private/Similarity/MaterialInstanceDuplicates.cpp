@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Similarity/MaterialInstanceDuplicates.h"
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Hash/xxhash.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "VT/RuntimeVirtualTexture.h"
+
+namespace SuperManagerMaterialInstanceDuplicates
+{
+	// 规范化方式变化时递增，旧的缓存文件整体作废
+	constexpr uint32 FingerprintCacheVersion = 2;
+
+	const FName ParentTagName(TEXT("Parent"));
+
+	// 参数名带上图层信息，图层参数与同名的全局参数不混淆
+	FString MakeParameterKey(const TCHAR* Type, const FMaterialParameterInfo& ParameterInfo)
+	{
+		return FString::Printf(TEXT("%s:%s@%d.%d"), Type, *ParameterInfo.Name.ToString(),
+		                       static_cast<int32>(ParameterInfo.Association), ParameterInfo.Index);
+	}
+
+	// 浮点按位写出，避免格式化误差让相同的值看起来不同
+	FString FloatToKey(float Value)
+	{
+		return FString::Printf(TEXT("%08x"), FMath::AsUInt(Value));
+	}
+
+	FString ObjectToKey(const UObject* Object)
+	{
+		return Object ? Object->GetPathName() : FString();
+	}
+
+	// 只记录勾选了覆盖的基础属性，未覆盖的取父材质的值，不影响是否重复
+	// 按反射遍历 bOverride_X 开关，引擎新增的基础属性也会被算进来
+	void AddBasePropertyOverrides(const FMaterialInstanceBasePropertyOverrides& Overrides, FSuperManagerMaterialParameterSet& OutParameters)
+	{
+		const UScriptStruct* Struct = FMaterialInstanceBasePropertyOverrides::StaticStruct();
+		for (TFieldIterator<FBoolProperty> It(Struct); It; ++It)
+		{
+			FString PropertyName = It->GetName();
+			if (!PropertyName.RemoveFromStart(TEXT("bOverride_")) || !It->GetPropertyValue_InContainer(&Overrides))
+			{
+				continue;
+			}
+			// 开关和值的命名不完全对应，如 bOverride_OutputTranslucentVelocity 对应 bOutputTranslucentVelocity
+			const FProperty* ValueProperty = Struct->FindPropertyByName(*PropertyName);
+			if (!ValueProperty)
+			{
+				ValueProperty = Struct->FindPropertyByName(*(TEXT("b") + PropertyName));
+			}
+			FString Value;
+			if (ValueProperty)
+			{
+				ValueProperty->ExportTextItem_InContainer(Value, &Overrides, nullptr, nullptr, PPF_None);
+			}
+			OutParameters.Overrides.Add(FString::Printf(TEXT("B:%s=%s"), *PropertyName, *Value));
+			// 基础属性覆盖和静态开关一样会让实例编译自己的着色器
+			OutParameters.bHasOwnPermutations = true;
+		}
+	}
+}
+
+void FSuperManagerMaterialInstanceDuplicates::CountInstancesPerParent(TMap<FString, int32>& OutNumInstancesPerParent)
+{
+	TArray<FAssetData> AllInstances;
+	IAssetRegistry::GetChecked().GetAssetsByClass(UMaterialInstanceConstant::StaticClass()->GetClassPathName(), AllInstances);
+	for (const FAssetData& AssetData : AllInstances)
+	{
+		FString Parent;
+		if (AssetData.GetTagValue(SuperManagerMaterialInstanceDuplicates::ParentTagName, Parent))
+		{
+			++OutNumInstancesPerParent.FindOrAdd(Parent);
+		}
+	}
+}
+
+FSuperManagerMaterialInstanceDuplicates::FSuperManagerMaterialInstanceDuplicates(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler)
+	: TSuperManagerAssetFingerprinter(InTaskScheduler, TEXT("MaterialInstanceFingerprints.bin"),
+	                                  SuperManagerMaterialInstanceDuplicates::FingerprintCacheVersion)
+{
+}
+
+bool FSuperManagerMaterialInstanceDuplicates::IsCandidate(const FAssetData& AssetData) const
+{
+	return AssetData.AssetClassPath == UMaterialInstanceConstant::StaticClass()->GetClassPathName();
+}
+
+void FSuperManagerMaterialInstanceDuplicates::FilterCandidates(TArray<const FAssetData*>& InOutCandidates) const
+{
+	// 父材质不同的实例不可能重复，父材质下只有一个实例的不需要加载
+	// 按整个注册表计数：候选只是一部分(分片、增量审计)时，兄弟实例可能不在候选里
+	// 没有 Parent 标签(旧资产)的保留下来，加载后再判断
+	TMap<FString, int32> NumInstancesPerParent;
+	CountInstancesPerParent(NumInstancesPerParent);
+	TArray<FString> Parents;
+	Parents.SetNum(InOutCandidates.Num());
+	for (int32 Index = 0; Index < InOutCandidates.Num(); ++Index)
+	{
+		InOutCandidates[Index]->GetTagValue(SuperManagerMaterialInstanceDuplicates::ParentTagName, Parents[Index]);
+	}
+
+	int32 WriteIndex = 0;
+	for (int32 Index = 0; Index < InOutCandidates.Num(); ++Index)
+	{
+		const int32* NumInstances = Parents[Index].IsEmpty() ? nullptr : NumInstancesPerParent.Find(Parents[Index]);
+		if (!NumInstances || *NumInstances > 1)
+		{
+			InOutCandidates[WriteIndex++] = InOutCandidates[Index];
+		}
+	}
+	InOutCandidates.SetNum(WriteIndex);
+}
+
+bool FSuperManagerMaterialInstanceDuplicates::LoadPayload(const FAssetData& AssetData, FSuperManagerMaterialParameterSet& OutParameters)
+{
+	using namespace SuperManagerMaterialInstanceDuplicates;
+
+	const UMaterialInstanceConstant* MaterialInstance = Cast<UMaterialInstanceConstant>(AssetData.GetAsset());
+	if (!MaterialInstance || !MaterialInstance->Parent)
+	{
+		return false;
+	}
+
+	OutParameters.ParentPath = MaterialInstance->Parent->GetPathName();
+
+	const FStaticParameterSet StaticParameters = MaterialInstance->GetStaticParameters();
+	for (const FStaticSwitchParameter& Parameter : StaticParameters.StaticSwitchParameters)
+	{
+		if (Parameter.bOverride)
+		{
+			OutParameters.Overrides.Add(MakeParameterKey(TEXT("S"), Parameter.ParameterInfo) + (Parameter.Value ? TEXT("=1") : TEXT("=0")));
+			OutParameters.bHasOwnPermutations = true;
+		}
+	}
+	for (const FStaticComponentMaskParameter& Parameter : StaticParameters.EditorOnly.StaticComponentMaskParameters)
+	{
+		if (Parameter.bOverride)
+		{
+			OutParameters.Overrides.Add(MakeParameterKey(TEXT("M"), Parameter.ParameterInfo) + FString::Printf(TEXT("=%d%d%d%d"),
+				Parameter.R ? 1 : 0, Parameter.G ? 1 : 0, Parameter.B ? 1 : 0, Parameter.A ? 1 : 0));
+			OutParameters.bHasOwnPermutations = true;
+		}
+	}
+
+	// 图层是静态参数，覆盖时整套图层(函数、混合、可见性)都属于这个实例
+	if (StaticParameters.bHasMaterialLayers)
+	{
+		const FMaterialLayersFunctions& Layers = StaticParameters.MaterialLayers;
+		for (int32 Index = 0; Index < Layers.Layers.Num(); ++Index)
+		{
+			const bool bVisible = !Layers.EditorOnly.LayerStates.IsValidIndex(Index) || Layers.EditorOnly.LayerStates[Index];
+			OutParameters.Overrides.Add(FString::Printf(TEXT("L:%d=%s,%d"), Index, *ObjectToKey(Layers.Layers[Index]), bVisible ? 1 : 0));
+		}
+		for (int32 Index = 0; Index < Layers.Blends.Num(); ++Index)
+		{
+			OutParameters.Overrides.Add(FString::Printf(TEXT("LB:%d=%s"), Index, *ObjectToKey(Layers.Blends[Index])));
+		}
+		OutParameters.bHasOwnPermutations = true;
+	}
+	AddBasePropertyOverrides(MaterialInstance->BasePropertyOverrides, OutParameters);
+
+	for (const FScalarParameterValue& Parameter : MaterialInstance->ScalarParameterValues)
+	{
+		OutParameters.Overrides.Add(MakeParameterKey(TEXT("F"), Parameter.ParameterInfo) + TEXT("=") + FloatToKey(Parameter.ParameterValue));
+	}
+	for (const FVectorParameterValue& Parameter : MaterialInstance->VectorParameterValues)
+	{
+		const FLinearColor& Value = Parameter.ParameterValue;
+		OutParameters.Overrides.Add(MakeParameterKey(TEXT("V"), Parameter.ParameterInfo) + TEXT("=") +
+			FloatToKey(Value.R) + FloatToKey(Value.G) + FloatToKey(Value.B) + FloatToKey(Value.A));
+	}
+	for (const FTextureParameterValue& Parameter : MaterialInstance->TextureParameterValues)
+	{
+		OutParameters.Overrides.Add(MakeParameterKey(TEXT("T"), Parameter.ParameterInfo) + TEXT("=") +
+			ObjectToKey(Parameter.ParameterValue));
+	}
+	for (const FFontParameterValue& Parameter : MaterialInstance->FontParameterValues)
+	{
+		OutParameters.Overrides.Add(MakeParameterKey(TEXT("Font"), Parameter.ParameterInfo) + TEXT("=") +
+			ObjectToKey(Parameter.FontValue) + FString::Printf(TEXT("#%d"), Parameter.FontPage));
+	}
+	for (const FRuntimeVirtualTextureParameterValue& Parameter : MaterialInstance->RuntimeVirtualTextureParameterValues)
+	{
+		OutParameters.Overrides.Add(MakeParameterKey(TEXT("RVT"), Parameter.ParameterInfo) + TEXT("=") +
+			ObjectToKey(Parameter.ParameterValue));
+	}
+	return true;
+}
+
+bool FSuperManagerMaterialInstanceDuplicates::ComputeValue(const FAssetData& AssetData, const FSuperManagerMaterialParameterSet& Parameters,
+                                                           FSuperManagerMaterialInstanceFingerprint& OutFingerprint) const
+{
+	// 参数覆盖的保存顺序与编辑顺序有关，排序后才可比较
+	TArray<FString> SortedOverrides = Parameters.Overrides;
+	SortedOverrides.Sort();
+
+	FXxHash64Builder HashBuilder;
+	HashBuilder.Update(*Parameters.ParentPath, Parameters.ParentPath.Len() * sizeof(TCHAR));
+	for (const FString& Override : SortedOverrides)
+	{
+		// 每条之间插入分隔，防止拼接后产生歧义
+		const TCHAR Separator = TEXT('\n');
+		HashBuilder.Update(&Separator, sizeof(Separator));
+		HashBuilder.Update(*Override, Override.Len() * sizeof(TCHAR));
+	}
+	OutFingerprint.ParameterHash = HashBuilder.Finalize().Hash;
+	OutFingerprint.bHasOwnPermutations = Parameters.bHasOwnPermutations;
+	return true;
+}
+
+void FSuperManagerMaterialInstanceDuplicates::GroupDuplicates(const FResults& Fingerprints, TArray<TArray<int32>>& OutGroups)
+{
+	TMap<uint64, TArray<int32>> GroupsByHash;
+	for (int32 Index = 0; Index < Fingerprints.Num(); ++Index)
+	{
+		GroupsByHash.FindOrAdd(Fingerprints[Index].Value.ParameterHash).Add(Index);
+	}
+	for (TPair<uint64, TArray<int32>>& Pair : GroupsByHash)
+	{
+		if (Pair.Value.Num() >= 2)
+		{
+			OutGroups.Add(MoveTemp(Pair.Value));
+		}
+	}
+}
@@ -0,0 +1,312 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Similarity/MeshDuplicates.h"
+
+#include "MeshDescription.h"
+#include "StaticMeshAttributes.h"
+#include "Algo/Sort.h"
+#include "Algo/StableSort.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/StaticMesh.h"
+#include "Hash/xxhash.h"
+#include "PhysicsEngine/BodySetup.h"
+
+namespace SuperManagerMeshDuplicates
+{
+	// 规整或哈希方式变化时递增，旧的缓存文件整体作废
+	constexpr uint32 FingerprintCacheVersion = 2;
+
+	struct FCanonicalTriangle
+	{
+		int32 Vertices[3];
+		int32 Section;
+	};
+
+	// 网格描述里的ID可能不连续，拷贝时压缩成连续下标
+	void CopyGeometry(const FMeshDescription& MeshDescription, FSuperManagerMeshGeometry& OutGeometry)
+	{
+		FStaticMeshConstAttributes Attributes(MeshDescription);
+		const TVertexAttributesConstRef<FVector3f> VertexPositions = Attributes.GetVertexPositions();
+
+		TArray<int32> VertexRemap;
+		VertexRemap.Init(INDEX_NONE, MeshDescription.Vertices().GetArraySize());
+		OutGeometry.Positions.Reserve(MeshDescription.Vertices().Num());
+		for (const FVertexID VertexID : MeshDescription.Vertices().GetElementIDs())
+		{
+			VertexRemap[VertexID.GetValue()] = OutGeometry.Positions.Add(VertexPositions[VertexID]);
+		}
+
+		TArray<int32> SectionRemap;
+		SectionRemap.Init(INDEX_NONE, MeshDescription.PolygonGroups().GetArraySize());
+		int32 NumSections = 0;
+		for (const FPolygonGroupID PolygonGroupID : MeshDescription.PolygonGroups().GetElementIDs())
+		{
+			SectionRemap[PolygonGroupID.GetValue()] = NumSections++;
+		}
+
+		OutGeometry.TriangleVertices.Reserve(MeshDescription.Triangles().Num() * 3);
+		OutGeometry.TriangleSections.Reserve(MeshDescription.Triangles().Num());
+		for (const FTriangleID TriangleID : MeshDescription.Triangles().GetElementIDs())
+		{
+			for (const FVertexID VertexID : MeshDescription.GetTriangleVertices(TriangleID))
+			{
+				OutGeometry.TriangleVertices.Add(VertexRemap[VertexID.GetValue()]);
+			}
+			OutGeometry.TriangleSections.Add(SectionRemap[MeshDescription.GetTrianglePolygonGroup(TriangleID).GetValue()]);
+		}
+	}
+
+	template <typename StructType>
+	void AppendStructText(FString& OutText, const StructType& Value)
+	{
+		StructType::StaticStruct()->ExportText(OutText, &Value, nullptr, nullptr, PPF_None, nullptr);
+		OutText += TEXT('\n');
+	}
+
+	// 组件按下标覆盖材质、按碰撞设置参与物理，这些在替换网格后都要保持不变
+	void ExportSetupText(const UStaticMesh& StaticMesh, FString& OutText)
+	{
+		for (const FStaticMaterial& StaticMaterial : StaticMesh.GetStaticMaterials())
+		{
+			OutText += FString::Printf(TEXT("Slot %s=%s\n"), *StaticMaterial.MaterialSlotName.ToString(),
+			                           StaticMaterial.MaterialInterface ? *StaticMaterial.MaterialInterface->GetPathName() : TEXT("None"));
+		}
+
+		if (const UBodySetup* BodySetup = StaticMesh.GetBodySetup())
+		{
+			OutText += FString::Printf(TEXT("Collision %d %s %d %s\n"), static_cast<int32>(BodySetup->CollisionTraceFlag.GetValue()),
+			                           *BodySetup->DefaultInstance.GetCollisionProfileName().ToString(),
+			                           static_cast<int32>(BodySetup->DefaultInstance.GetCollisionEnabled()),
+			                           BodySetup->PhysMaterial ? *BodySetup->PhysMaterial->GetPathName() : TEXT("None"));
+			AppendStructText(OutText, BodySetup->AggGeom);
+		}
+
+		for (int32 LODIndex = 0; LODIndex < StaticMesh.GetNumSourceModels(); ++LODIndex)
+		{
+			const FStaticMeshSourceModel& SourceModel = StaticMesh.GetSourceModel(LODIndex);
+			OutText += FString::Printf(TEXT("LOD %d %f\n"), LODIndex, SourceModel.ScreenSize.Default);
+			AppendStructText(OutText, SourceModel.BuildSettings);
+			AppendStructText(OutText, SourceModel.ReductionSettings);
+		}
+	}
+}
+
+FSuperManagerMeshDuplicates::FSuperManagerMeshDuplicates(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler)
+	: TSuperManagerAssetFingerprinter(InTaskScheduler, TEXT("MeshFingerprints.bin"), SuperManagerMeshDuplicates::FingerprintCacheVersion)
+{
+}
+
+bool FSuperManagerMeshDuplicates::IsCandidate(const FAssetData& AssetData) const
+{
+	return AssetData.AssetClassPath == UStaticMesh::StaticClass()->GetClassPathName();
+}
+
+bool FSuperManagerMeshDuplicates::LoadPayload(const FAssetData& AssetData, FSuperManagerMeshPayload& OutPayload)
+{
+	using namespace SuperManagerMeshDuplicates;
+
+	const UStaticMesh* StaticMesh = Cast<UStaticMesh>(AssetData.GetAsset());
+	if (!StaticMesh)
+	{
+		return false;
+	}
+	const FMeshDescription* MeshDescription = StaticMesh->GetMeshDescription(0);
+	if (!MeshDescription)
+	{
+		return false;
+	}
+	CopyGeometry(*MeshDescription, OutPayload.Geometry);
+
+	// 渲染分段只对应有三角形的多边形组，分段信息表按分段序号存放材质下标和开关
+	FStaticMeshConstAttributes Attributes(*MeshDescription);
+	const TPolygonGroupAttributesConstRef<FName> SlotNames = Attributes.GetPolygonGroupMaterialSlotNames();
+	const FMeshSectionInfoMap& SectionInfoMap = StaticMesh->GetSectionInfoMap();
+	int32 RenderSectionIndex = 0;
+	for (const FPolygonGroupID PolygonGroupID : MeshDescription->PolygonGroups().GetElementIDs())
+	{
+		FSuperManagerMeshSectionSetup& Section = OutPayload.Sections.AddDefaulted_GetRef();
+		if (MeshDescription->GetNumPolygonGroupTriangles(PolygonGroupID) == 0)
+		{
+			continue;
+		}
+		if (SectionInfoMap.IsValidSection(0, RenderSectionIndex))
+		{
+			const FMeshSectionInfo SectionInfo = SectionInfoMap.Get(0, RenderSectionIndex);
+			Section.MaterialIndex = SectionInfo.MaterialIndex;
+			Section.bEnableCollision = SectionInfo.bEnableCollision;
+			Section.bCastShadow = SectionInfo.bCastShadow;
+		}
+		else
+		{
+			Section.MaterialIndex = StaticMesh->GetMaterialIndexFromImportedMaterialSlotName(SlotNames[PolygonGroupID]);
+		}
+		++RenderSectionIndex;
+	}
+
+	ExportSetupText(*StaticMesh, OutPayload.SetupText);
+	for (int32 LODIndex = 1; LODIndex < StaticMesh->GetNumSourceModels(); ++LODIndex)
+	{
+		if (StaticMesh->IsReductionActive(LODIndex))
+		{
+			continue;
+		}
+		if (const FMeshDescription* LODMeshDescription = StaticMesh->GetMeshDescription(LODIndex))
+		{
+			CopyGeometry(*LODMeshDescription, OutPayload.ImportedLODs.AddDefaulted_GetRef());
+		}
+	}
+	return OutPayload.Geometry.TriangleSections.Num() > 0;
+}
+
+bool FSuperManagerMeshDuplicates::ComputeValue(const FAssetData& AssetData, const FSuperManagerMeshPayload& Payload,
+                                               FSuperManagerMeshFingerprint& OutFingerprint) const
+{
+	TArray<int32> SectionOrder;
+	OutFingerprint.GeometryHash = ComputeGeometryHash(Payload.Geometry, OutFingerprint.NumVertices, &SectionOrder);
+	OutFingerprint.SetupHash = ComputeSetupHash(Payload, SectionOrder);
+	OutFingerprint.NumTriangles = Payload.Geometry.TriangleSections.Num();
+	if (const TOptional<FAssetPackageData> PackageData = IAssetRegistry::GetChecked().GetAssetPackageDataCopy(AssetData.PackageName))
+	{
+		OutFingerprint.DiskSize = PackageData->DiskSize;
+	}
+	return true;
+}
+
+uint64 FSuperManagerMeshDuplicates::ComputeGeometryHash(const FSuperManagerMeshGeometry& Geometry, int32& OutNumUniqueVertices,
+                                                        TArray<int32>* OutSectionOrder)
+{
+	using namespace SuperManagerMeshDuplicates;
+
+	// 顶点量化后排序去重，得到与原始顶点顺序无关的编号
+	// 只做四舍五入不探测相邻格子：哈希只能比较相等，容差匹配需要换成逐对比较
+	TArray<FIntVector3> QuantizedPositions;
+	QuantizedPositions.SetNumUninitialized(Geometry.Positions.Num());
+	for (int32 Index = 0; Index < Geometry.Positions.Num(); ++Index)
+	{
+		const FVector3f& Position = Geometry.Positions[Index];
+		QuantizedPositions[Index] = FIntVector3(FMath::RoundToInt(Position.X / QuantizationStep),
+		                                        FMath::RoundToInt(Position.Y / QuantizationStep),
+		                                        FMath::RoundToInt(Position.Z / QuantizationStep));
+	}
+
+	auto LessPosition = [](const FIntVector3& A, const FIntVector3& B)
+	{
+		return A.X != B.X ? A.X < B.X : (A.Y != B.Y ? A.Y < B.Y : A.Z < B.Z);
+	};
+	TArray<int32> SortedVertices;
+	SortedVertices.SetNumUninitialized(QuantizedPositions.Num());
+	for (int32 Index = 0; Index < SortedVertices.Num(); ++Index)
+	{
+		SortedVertices[Index] = Index;
+	}
+	Algo::Sort(SortedVertices, [&QuantizedPositions, &LessPosition](int32 A, int32 B)
+	{
+		return LessPosition(QuantizedPositions[A], QuantizedPositions[B]);
+	});
+
+	TArray<FIntVector3> UniquePositions;
+	TArray<int32> CanonicalVertex;
+	CanonicalVertex.SetNumUninitialized(QuantizedPositions.Num());
+	for (const int32 VertexIndex : SortedVertices)
+	{
+		if (UniquePositions.Num() == 0 || UniquePositions.Last() != QuantizedPositions[VertexIndex])
+		{
+			UniquePositions.Add(QuantizedPositions[VertexIndex]);
+		}
+		CanonicalVertex[VertexIndex] = UniquePositions.Num() - 1;
+	}
+	OutNumUniqueVertices = UniquePositions.Num();
+
+	// 三角形旋转到最小顶点在前(保留绕序)，再整体排序
+	const int32 NumTriangles = Geometry.TriangleSections.Num();
+	TArray<FCanonicalTriangle> Triangles;
+	Triangles.SetNumUninitialized(NumTriangles);
+	for (int32 TriangleIndex = 0; TriangleIndex < NumTriangles; ++TriangleIndex)
+	{
+		int32 Corners[3];
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			Corners[Corner] = CanonicalVertex[Geometry.TriangleVertices[TriangleIndex * 3 + Corner]];
+		}
+		const int32 First = Corners[0] <= Corners[1] && Corners[0] <= Corners[2] ? 0 : (Corners[1] <= Corners[2] ? 1 : 2);
+		FCanonicalTriangle& Triangle = Triangles[TriangleIndex];
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			Triangle.Vertices[Corner] = Corners[(First + Corner) % 3];
+		}
+		Triangle.Section = Geometry.TriangleSections[TriangleIndex];
+	}
+	Algo::Sort(Triangles, [](const FCanonicalTriangle& A, const FCanonicalTriangle& B)
+	{
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			if (A.Vertices[Corner] != B.Vertices[Corner])
+			{
+				return A.Vertices[Corner] < B.Vertices[Corner];
+			}
+		}
+		return A.Section < B.Section;
+	});
+
+	// 材质槽按在排序后三角形中首次出现的顺序重新编号，只保留分段布局，与槽的名字和顺序无关
+	TMap<int32, int32> SectionRemap;
+	for (FCanonicalTriangle& Triangle : Triangles)
+	{
+		const int32* CanonicalSection = SectionRemap.Find(Triangle.Section);
+		if (CanonicalSection)
+		{
+			Triangle.Section = *CanonicalSection;
+			continue;
+		}
+		if (OutSectionOrder)
+		{
+			OutSectionOrder->Add(Triangle.Section);
+		}
+		Triangle.Section = SectionRemap.Add(Triangle.Section, SectionRemap.Num());
+	}
+
+	FXxHash64Builder HashBuilder;
+	HashBuilder.Update(UniquePositions.GetData(), UniquePositions.Num() * sizeof(FIntVector3));
+	HashBuilder.Update(Triangles.GetData(), Triangles.Num() * sizeof(FCanonicalTriangle));
+	return HashBuilder.Finalize().Hash;
+}
+
+uint64 FSuperManagerMeshDuplicates::ComputeSetupHash(const FSuperManagerMeshPayload& Payload, const TArray<int32>& SectionOrder)
+{
+	FXxHash64Builder HashBuilder;
+	HashBuilder.Update(*Payload.SetupText, Payload.SetupText.Len() * sizeof(TCHAR));
+
+	// 分段按几何规整后的编号排列，分段对应的材质槽下标不同时组件上的覆盖材质会落到别的分段上
+	for (const int32 SectionIndex : SectionOrder)
+	{
+		const FSuperManagerMeshSectionSetup& Section = Payload.Sections[SectionIndex];
+		const int32 SectionValues[3] = { Section.MaterialIndex, Section.bEnableCollision ? 1 : 0, Section.bCastShadow ? 1 : 0 };
+		HashBuilder.Update(SectionValues, sizeof(SectionValues));
+	}
+
+	for (const FSuperManagerMeshGeometry& LODGeometry : Payload.ImportedLODs)
+	{
+		int32 NumUniqueVertices = 0;
+		const uint64 LODHash = ComputeGeometryHash(LODGeometry, NumUniqueVertices);
+		HashBuilder.Update(&LODHash, sizeof(LODHash));
+	}
+	return HashBuilder.Finalize().Hash;
+}
+
+void FSuperManagerMeshDuplicates::GroupDuplicates(const FResults& Fingerprints, TArray<TArray<int32>>& OutGroups)
+{
+	TMap<uint64, TArray<int32>> GroupsByHash;
+	for (int32 Index = 0; Index < Fingerprints.Num(); ++Index)
+	{
+		GroupsByHash.FindOrAdd(Fingerprints[Index].Value.GeometryHash).Add(Index);
+	}
+	for (TPair<uint64, TArray<int32>>& Pair : GroupsByHash)
+	{
+		if (Pair.Value.Num() >= 2)
+		{
+			Algo::StableSortBy(Pair.Value, [&Fingerprints](int32 Index) { return Fingerprints[Index].Value.SetupHash; });
+			OutGroups.Add(MoveTemp(Pair.Value));
+		}
+	}
+}
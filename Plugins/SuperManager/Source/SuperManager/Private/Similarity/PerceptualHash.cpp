@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Similarity/PerceptualHash.h"
+
+#include "ImageCore.h"
+#include "Algo/Sort.h"
+#include "Math/VectorRegister.h"
+
+namespace SuperManagerPerceptualHash
+{
+	constexpr int32 N = FSuperManagerPerceptualHash::SampleSize;
+	constexpr int32 K = FSuperManagerPerceptualHash::HashSize;
+
+	// 只需要DCT基的前K行，K*N，行优先
+	struct FDCTBasis
+	{
+		alignas(16) float Rows[K * N];
+
+		FDCTBasis()
+		{
+			for (int32 U = 0; U < K; ++U)
+			{
+				const double Scale = U == 0 ? FMath::Sqrt(1.0 / N) : FMath::Sqrt(2.0 / N);
+				for (int32 X = 0; X < N; ++X)
+				{
+					Rows[U * N + X] = static_cast<float>(Scale * FMath::Cos((2 * X + 1) * U * UE_DOUBLE_PI / (2.0 * N)));
+				}
+			}
+		}
+	};
+
+	const FDCTBasis& GetDCTBasis()
+	{
+		static const FDCTBasis Basis;
+		return Basis;
+	}
+
+	// 按 Rec.709 系数把线性RGBA转为亮度，每个像素一次4宽点积
+	void ToLuminance(const FLinearColor* Pixels, float* OutLuminance)
+	{
+		const VectorRegister4Float Weights = MakeVectorRegisterFloat(0.2126f, 0.7152f, 0.0722f, 0.f);
+		for (int32 Index = 0; Index < N * N; ++Index)
+		{
+			VectorStoreFloat1(VectorDot4(VectorLoad(&Pixels[Index].R), Weights), &OutLuminance[Index]);
+		}
+	}
+}
+
+uint64 FSuperManagerPerceptualHash::ComputeFromLuminance(const float* Luminance)
+{
+	using namespace SuperManagerPerceptualHash;
+	const float* Basis = GetDCTBasis().Rows;
+
+	// 二维DCT = D * X * D^T，只算结果左上角K*K
+	// 第一步 T = D(K*N) * X(N*N)，每次处理一行中相邻的4列
+	alignas(16) float Temp[K * N];
+	for (int32 U = 0; U < K; ++U)
+	{
+		for (int32 Column = 0; Column < N; Column += 4)
+		{
+			VectorRegister4Float Accumulator = VectorZeroFloat();
+			for (int32 X = 0; X < N; ++X)
+			{
+				Accumulator = VectorMultiplyAdd(VectorSetFloat1(Basis[U * N + X]), VectorLoad(&Luminance[X * N + Column]), Accumulator);
+			}
+			VectorStoreAligned(Accumulator, &Temp[U * N + Column]);
+		}
+	}
+
+	// 第二步 C = T(K*N) * D^T(N*K)，每个系数是两个长度N的行向量点积
+	float Coefficients[K * K];
+	for (int32 U = 0; U < K; ++U)
+	{
+		for (int32 V = 0; V < K; ++V)
+		{
+			VectorRegister4Float Accumulator = VectorZeroFloat();
+			for (int32 X = 0; X < N; X += 4)
+			{
+				Accumulator = VectorMultiplyAdd(VectorLoadAligned(&Temp[U * N + X]), VectorLoadAligned(&Basis[V * N + X]), Accumulator);
+			}
+			VectorStoreFloat1(VectorDot4(Accumulator, VectorOneFloat()), &Coefficients[U * K + V]);
+		}
+	}
+
+	// 直流分量只反映整体亮度，不参与中位数
+	float AcCoefficients[K * K - 1];
+	FMemory::Memcpy(AcCoefficients, Coefficients + 1, sizeof(AcCoefficients));
+	Algo::Sort(AcCoefficients);
+	const float Median = AcCoefficients[(K * K - 1) / 2];
+
+	uint64 Hash = 0;
+	for (int32 Index = 0; Index < K * K; ++Index)
+	{
+		if (Coefficients[Index] > Median)
+		{
+			Hash |= uint64(1) << Index;
+		}
+	}
+	return Hash;
+}
+
+bool FSuperManagerPerceptualHash::ComputeFromImage(const FImage& Image, uint64& OutHash)
+{
+	using namespace SuperManagerPerceptualHash;
+	if (Image.SizeX <= 0 || Image.SizeY <= 0)
+	{
+		return false;
+	}
+
+	FImage Sample;
+	Image.ResizeTo(Sample, N, N, ERawImageFormat::RGBA32F, EGammaSpace::Linear);
+
+	alignas(16) float Luminance[N * N];
+	ToLuminance(Sample.AsRGBA32F().GetData(), Luminance);
+	OutHash = ComputeFromLuminance(Luminance);
+	return true;
+}
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Similarity/TextureSimilarity.h"
+
+#include "Engine/Texture2D.h"
+#include "Similarity/HammingBKTree.h"
+#include "Similarity/PerceptualHash.h"
+
+namespace SuperManagerTextureSimilarity
+{
+	// 算法或采样方式变化时递增，旧的缓存文件整体作废
+	constexpr uint32 HashCacheVersion = 1;
+
+	// 为了取源数据新加载的贴图每累计这么多张回收一次，源mip在回收前一直留在内存里
+	constexpr int32 LoadedTexturesPerGarbageCollection = 32;
+}
+
+FSuperManagerTextureSimilarity::FSuperManagerTextureSimilarity(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler)
+	: TSuperManagerAssetFingerprinter(InTaskScheduler, TEXT("TextureHashes.bin"), SuperManagerTextureSimilarity::HashCacheVersion)
+{
+}
+
+bool FSuperManagerTextureSimilarity::IsCandidate(const FAssetData& AssetData) const
+{
+	return AssetData.AssetClassPath == UTexture2D::StaticClass()->GetClassPathName();
+}
+
+bool FSuperManagerTextureSimilarity::LoadPayload(const FAssetData& AssetData, FImage& OutImage)
+{
+	// 本来就在内存里的贴图(正在编辑、被关卡引用)不算，回收不掉
+	const bool bWasLoaded = AssetData.IsAssetLoaded();
+	bool bCopied = false;
+	{
+		UTexture2D* Texture = Cast<UTexture2D>(AssetData.GetAsset());
+		if (Texture && Texture->Source.IsValid())
+		{
+			// 取仍不小于采样尺寸的最小一级mip，减少拷贝和缩放的数据量
+			FTextureSource& Source = Texture->Source;
+			int32 MipIndex = 0;
+			while (MipIndex + 1 < Source.GetNumMips() &&
+				FMath::Min(Source.GetSizeX() >> (MipIndex + 1), Source.GetSizeY() >> (MipIndex + 1)) >= FSuperManagerPerceptualHash::SampleSize)
+			{
+				++MipIndex;
+			}
+			bCopied = Source.GetMipImage(OutImage, 0, 0, MipIndex);
+		}
+	}
+
+	// 拷贝出来的 mip 不引用贴图，这里之后没有任何地方持有它，回收时连同源数据一起释放
+	if (!bWasLoaded && ++NumTexturesLoadedSinceGarbageCollection >= SuperManagerTextureSimilarity::LoadedTexturesPerGarbageCollection)
+	{
+		NumTexturesLoadedSinceGarbageCollection = 0;
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+	return bCopied;
+}
+
+bool FSuperManagerTextureSimilarity::ComputeValue(const FAssetData& AssetData, const FImage& Image, uint64& OutHash) const
+{
+	return FSuperManagerPerceptualHash::ComputeFromImage(Image, OutHash);
+}
+
+void FSuperManagerTextureSimilarity::GroupNearDuplicates(const FResults& Hashes, int32 MaxDistance, TArray<TArray<int32>>& OutGroups)
+{
+	FSuperManagerHammingBKTree Tree;
+	TArray<int32> NodeOfHash;
+	NodeOfHash.SetNum(Hashes.Num());
+	for (int32 Index = 0; Index < Hashes.Num(); ++Index)
+	{
+		NodeOfHash[Index] = Tree.Insert(Hashes[Index].Value);
+	}
+
+	// 树构建完后只读，每个节点的近邻查询互不依赖
+	TArray<TArray<int32>> Neighbors;
+	Neighbors.SetNum(Tree.Num());
+	ParallelFor(Tree.Num(), [&Tree, &Neighbors, MaxDistance](int32 NodeIndex)
+	{
+		Tree.Query(Tree.GetHash(NodeIndex), MaxDistance, Neighbors[NodeIndex]);
+	});
+
+	// 并查集合并近邻节点，得到传递闭包
+	TArray<int32> Parents;
+	Parents.SetNum(Tree.Num());
+	for (int32 NodeIndex = 0; NodeIndex < Tree.Num(); ++NodeIndex)
+	{
+		Parents[NodeIndex] = NodeIndex;
+	}
+	auto FindRoot = [&Parents](int32 NodeIndex)
+	{
+		while (Parents[NodeIndex] != NodeIndex)
+		{
+			Parents[NodeIndex] = Parents[Parents[NodeIndex]];
+			NodeIndex = Parents[NodeIndex];
+		}
+		return NodeIndex;
+	};
+	for (int32 NodeIndex = 0; NodeIndex < Tree.Num(); ++NodeIndex)
+	{
+		for (const int32 Neighbor : Neighbors[NodeIndex])
+		{
+			const int32 RootA = FindRoot(NodeIndex);
+			const int32 RootB = FindRoot(Neighbor);
+			if (RootA != RootB)
+			{
+				Parents[RootB] = RootA;
+			}
+		}
+	}
+
+	TMap<int32, TArray<int32>> GroupsByRoot;
+	for (int32 Index = 0; Index < Hashes.Num(); ++Index)
+	{
+		GroupsByRoot.FindOrAdd(FindRoot(NodeOfHash[Index])).Add(Index);
+	}
+	for (TPair<int32, TArray<int32>>& Pair : GroupsByRoot)
+	{
+		if (Pair.Value.Num() >= 2)
+		{
+			OutGroups.Add(MoveTemp(Pair.Value));
+		}
+	}
+}
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SlateWidgets/AdvanceDeletionRow.h"
+
+#include "SuperManager.h"
+#include "Settings/SuperManagerSettings.h"
+
+void SAdvanceDeletionRow::Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& InOwnerTable)
+{
+	OnIsChecked = InArgs._OnIsChecked;
+	OnCheckStateChanged = InArgs._OnCheckStateChanged;
+	OnDeleteClicked = InArgs._OnDeleteClicked;
+
+	// 缩略图到达之前先显示类图标，行高不随缩略图变化
+	constexpr float ThumbnailDisplaySize = 40.f;
+
+	STableRow::Construct(
+		STableRow::FArguments()
+		.Padding(FMargin(5.f))
+		[
+			SNew(SHorizontalBox)
+
+			+ SHorizontalBox::Slot()
+			.HAlign(HAlign_Left)
+			.VAlign(VAlign_Center)
+			.FillWidth(0.05f)
+			[
+				SNew(SCheckBox)
+				.Type(ESlateCheckBoxType::CheckBox)
+				.IsChecked(this, &SAdvanceDeletionRow::GetCheckState)
+				.OnCheckStateChanged(this, &SAdvanceDeletionRow::OnCheckBoxStateChanged)
+			]
+
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(FMargin(0.f, 0.f, 5.f, 0.f))
+			[
+				SNew(SBox)
+				.WidthOverride(ThumbnailDisplaySize)
+				.HeightOverride(ThumbnailDisplaySize)
+				[
+					SAssignNew(ThumbnailImage, SImage)
+				]
+			]
+
+			+ SHorizontalBox::Slot()
+			.HAlign(HAlign_Left)
+			.VAlign(VAlign_Fill)
+			.FillWidth(0.55)
+			[
+				SAssignNew(ClassTextBlock, STextBlock)
+				.Font(InArgs._ClassFont)
+				.ColorAndOpacity(FColor::White)
+			]
+
+			+ SHorizontalBox::Slot()
+			.HAlign(HAlign_Left)
+			.VAlign(VAlign_Fill)
+			[
+				SAssignNew(NameTextBlock, STextBlock)
+				.Font(InArgs._NameFont)
+				.ColorAndOpacity(FColor::White)
+			]
+
+			// 资产来自哪个选中的目录
+			+ SHorizontalBox::Slot()
+			.HAlign(HAlign_Left)
+			.VAlign(VAlign_Fill)
+			[
+				SAssignNew(DetailTextBlock, STextBlock)
+				.Font(InArgs._ClassFont)
+				.ColorAndOpacity(FColor::White)
+			]
+
+			+ SHorizontalBox::Slot()
+			.HAlign(HAlign_Right)
+			.VAlign(VAlign_Fill)
+			[
+				SNew(SButton)
+				.Text(FText::FromString(TEXT("Delete")))
+				.OnClicked(this, &SAdvanceDeletionRow::OnDeleteButtonClicked)
+			]
+		],
+		InOwnerTable);
+}
+
+SAdvanceDeletionRow::~SAdvanceDeletionRow()
+{
+	Unbind();
+}
+
+void SAdvanceDeletionRow::Bind(const TSharedRef<const FSuperManagerAssetRowViewModel>& InViewModel)
+{
+	ViewModel = InViewModel;
+	ClassTextBlock->SetText(InViewModel->ClassText);
+	NameTextBlock->SetText(InViewModel->NameText);
+	DetailTextBlock->SetText(InViewModel->DetailText);
+	ThumbnailImage->SetImage(InViewModel->ClassIcon);
+	RequestThumbnail();
+}
+
+void SAdvanceDeletionRow::Unbind()
+{
+	if (ThumbnailToken.IsValid())
+	{
+		ThumbnailToken->Cancel();
+		ThumbnailToken.Reset();
+	}
+	ThumbnailBrush.Reset();
+	ViewModel.Reset();
+}
+
+void SAdvanceDeletionRow::RequestThumbnail()
+{
+	if (!USuperManagerSettings::Get()->bShowThumbnails || !ViewModel->AssetData.IsValid())
+	{
+		return;
+	}
+
+	const FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	const TSharedPtr<FSuperManagerThumbnailCache> ThumbnailCache = SuperManagerModule.GetThumbnailCache();
+	// 已知没有缩略图的资产同样命中，不再发请求
+	if (ThumbnailCache->Find(*ViewModel->AssetData, ThumbnailBrush))
+	{
+		if (ThumbnailBrush.IsValid())
+		{
+			ThumbnailImage->SetImage(ThumbnailBrush.Get());
+		}
+		return;
+	}
+
+	// 只发请求，解码在工作线程完成，滚动不会等待缩略图；行被回收时令牌已取消，不会显示到别的资产上
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	ThumbnailToken = Token;
+	TWeakPtr<SAdvanceDeletionRow> WeakThis = StaticCastSharedRef<SAdvanceDeletionRow>(AsShared());
+	ThumbnailCache->Request(*ViewModel->AssetData, Token, [WeakThis](const TSharedPtr<FSlateBrush>& Brush)
+	{
+		const TSharedPtr<SAdvanceDeletionRow> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			return;
+		}
+		This->ThumbnailToken.Reset();
+		if (Brush.IsValid())
+		{
+			This->ThumbnailBrush = Brush;
+			This->ThumbnailImage->SetImage(Brush.Get());
+		}
+	});
+}
+
+ECheckBoxState SAdvanceDeletionRow::GetCheckState() const
+{
+	const bool bChecked = ViewModel.IsValid() && OnIsChecked.IsBound() && OnIsChecked.Execute(ViewModel->AssetData);
+	return bChecked ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void SAdvanceDeletionRow::OnCheckBoxStateChanged(ECheckBoxState NewState)
+{
+	if (ViewModel.IsValid())
+	{
+		OnCheckStateChanged.ExecuteIfBound(NewState, ViewModel->AssetData);
+	}
+}
+
+FReply SAdvanceDeletionRow::OnDeleteButtonClicked()
+{
+	if (!ViewModel.IsValid() || !OnDeleteClicked.IsBound())
+	{
+		return FReply::Handled();
+	}
+	// 删除后列表会刷新，这一行可能被回收，先拷贝一份资产引用
+	const TSharedPtr<FAssetData> AssetData = ViewModel->AssetData;
+	return OnDeleteClicked.Execute(AssetData);
+}
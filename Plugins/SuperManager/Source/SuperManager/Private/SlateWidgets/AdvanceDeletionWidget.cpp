@@ -5,25 +5,40 @@
 
 #include "DebugHeader.h"
 #include "SuperManager.h"
+#include "Misc/Paths.h"
+#include "SlateWidgets/UnusedAssetStatusWidget.h"
+#include "Styling/SlateIconFinder.h"
 
 #define ListAll TEXT("List All Available Assets")
 #define ListUnused TEXT("List Unused Assets")
 #define ListSameName TEXT("List Assets With Same Name")
+#define ListSimilarTextures TEXT("List Near-Duplicate Textures")
+#define ListDuplicateMeshes TEXT("List Duplicate Static Meshes")
+#define ListDuplicateMaterialInstances TEXT("List Duplicate Material Instances")
+#define ListTextureBudget TEXT("Audit Texture Budgets")
 
 void SAdvanceDeletionTab::Construct(const FArguments& InArgs)
 {
 	bCanSupportFocus = true;
 
-	StoredAssetsData = InArgs._AssetDataToStore;
-	DisplayAssetsData = StoredAssetsData;
+	SelectedFolders = InArgs._SelectedFolders;
 
-	CheckBoxesArray.Empty();
-	AssetDataToDeleteArray.Empty();
+	AssetDataToDeleteSet.Empty();
 	ComboSourceItems.Empty();
 
+	// 行里用到的字体只在这里拷贝一次
+	AssetClassNameFont = GetEmboseedTextFont();
+	AssetClassNameFont.Size = 10;
+	AssetNameFont = GetEmboseedTextFont();
+	AssetNameFont.Size = 15;
+
 	ComboSourceItems.Add(MakeShared<FString>(ListAll));
 	ComboSourceItems.Add(MakeShared<FString>(ListUnused));
 	ComboSourceItems.Add(MakeShared<FString>(ListSameName));
+	ComboSourceItems.Add(MakeShared<FString>(ListSimilarTextures));
+	ComboSourceItems.Add(MakeShared<FString>(ListDuplicateMeshes));
+	ComboSourceItems.Add(MakeShared<FString>(ListDuplicateMaterialInstances));
+	ComboSourceItems.Add(MakeShared<FString>(ListTextureBudget));
 
 	FSlateFontInfo TitleTextFont = GetEmboseedTextFont();
 	TitleTextFont.Size = 30;
@@ -67,19 +82,43 @@ void SAdvanceDeletionTab::Construct(const FArguments& InArgs)
 			+ SHorizontalBox::Slot()
 			.FillWidth(0.1f)
 			[
-				ConstructComboHelpTexts(TEXT("Current Folder:\n:" + InArgs._CurrentSelectedFolder),
+				ConstructComboHelpTexts(TEXT("Current Folder:\n") + FString::Join(InArgs._SelectedFolders, TEXT("\n")),
 					ETextJustify::Right)
 			]
+
+			// 实时的未使用资产计数
+			+ SHorizontalBox::Slot()
+			.FillWidth(0.2f)
+			[
+				SNew(SUnusedAssetStatusWidget)
+				.Folders(InArgs._SelectedFolders)
+			]
 		]
 
-		// 资产列表
+		// 列表计算中的提示
 		+ SVerticalBox::Slot()
+		.AutoHeight()
 		[
-			SNew(SScrollBox)
-			+ SScrollBox::Slot()
-			[
-				ConstructAssetListView()
-			]
+			SNew(STextBlock)
+			.Text(FText::FromString(TEXT("正在分析资产...")))
+			.Justification(ETextJustify::Center)
+			.Visibility(this, &SAdvanceDeletionTab::GetLoadingTextVisibility)
+		]
+
+		// 列表汇总，例如贴图预算检查的可节省总量
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			SNew(STextBlock)
+			.Text(this, &SAdvanceDeletionTab::GetSummaryText)
+			.Justification(ETextJustify::Center)
+			.Visibility(this, &SAdvanceDeletionTab::GetSummaryTextVisibility)
+		]
+
+		// 资产列表，由列表自己滚动，只生成可见的行
+		+ SVerticalBox::Slot()
+		[
+			ConstructAssetListView()
 		]
 
 		// 三个操作按钮
@@ -108,8 +147,81 @@ void SAdvanceDeletionTab::Construct(const FArguments& InArgs)
 			[
 				ConstructDeselectAllButton()
 			]
+
+			+ SHorizontalBox::Slot()
+			.FillWidth(10)
+			.Padding(5)
+			[
+				ConstructConsolidateButton()
+			]
+
+			+ SHorizontalBox::Slot()
+			.FillWidth(10)
+			.Padding(5)
+			[
+				ConstructExportButton(ESuperManagerExportFormat::Csv)
+			]
+
+			+ SHorizontalBox::Slot()
+			.FillWidth(10)
+			.Padding(5)
+			[
+				ConstructExportButton(ESuperManagerExportFormat::Json)
+			]
 		]
 	];
+
+	RequestAssetList(ESuperManagerListCondition::All);
+}
+
+SAdvanceDeletionTab::~SAdvanceDeletionTab()
+{
+	if (PendingRequestToken.IsValid())
+	{
+		PendingRequestToken->Cancel();
+	}
+	for (const TPair<ESuperManagerExportFormat, TSharedPtr<FSuperManagerCancellationToken>>& Pair : PendingExportTokens)
+	{
+		Pair.Value->Cancel();
+	}
+}
+
+void SAdvanceDeletionTab::RequestAssetList(ESuperManagerListCondition Condition)
+{
+	if (PendingRequestToken.IsValid())
+	{
+		PendingRequestToken->Cancel();
+	}
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	PendingRequestToken = Token;
+	bIsLoading = true;
+	CurrentCondition = Condition;
+
+	// 结果由模块缓存，目录没有变化时切换条件不会重新计算
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	TWeakPtr<SAdvanceDeletionTab> WeakThis = SharedThis(this);
+	SuperManagerModule.RequestAssetListForFolders(SelectedFolders, Condition,
+		[WeakThis, Condition](const TSharedRef<const FSuperManagerAssetList>& AssetList)
+		{
+			const TSharedPtr<SAdvanceDeletionTab> This = WeakThis.Pin();
+			if (!This.IsValid())
+			{
+				return;
+			}
+			This->bIsLoading = false;
+			This->DisplayAssetsData = AssetList->Assets;
+			This->AssetRoots = AssetList->AssetRoots;
+			This->AssetGroups = AssetList->AssetGroups;
+			This->AssetDetails = AssetList->AssetDetails;
+			This->Summary = AssetList->Summary;
+			// 根目录、组序号和详情随列表变化
+			This->RowViewModels.Reset();
+			if (Condition == ESuperManagerListCondition::All)
+			{
+				This->StoredAssetsData = AssetList->Assets;
+			}
+			This->RefreshAssetListView();
+		}, Token);
 }
 
 TSharedRef<SListView<TSharedPtr<FAssetData>>> SAdvanceDeletionTab::ConstructAssetListView()
@@ -118,6 +230,7 @@ TSharedRef<SListView<TSharedPtr<FAssetData>>> SAdvanceDeletionTab::ConstructAsse
 		.ItemHeight(24)
 		.ListItemsSource(&DisplayAssetsData)
 		.OnGenerateRow(this, &SAdvanceDeletionTab::OnGenerateRowForList)
+		.OnRowReleased(this, &SAdvanceDeletionTab::OnRowReleased)
 		.OnMouseButtonClick(this, &SAdvanceDeletionTab::OnRowWidgetMouseButtonClicked);
 
 	return ConstructedAssetListView.ToSharedRef();
@@ -131,8 +244,7 @@ void SAdvanceDeletionTab::OnRowWidgetMouseButtonClicked(TSharedPtr<FAssetData> C
 
 void SAdvanceDeletionTab::RefreshAssetListView()
 {
-	AssetDataToDeleteArray.Empty();
-	CheckBoxesArray.Empty();
+	AssetDataToDeleteSet.Empty();
 	if (ConstructedAssetListView.IsValid())
 	{
 		ConstructedAssetListView->RebuildList();
@@ -166,21 +278,34 @@ void SAdvanceDeletionTab::OnComboSelectionChanged(TSharedPtr<FString> SelectedOp
 {
 	DebugHeader::Print(*SelectedOption.Get());
 	ComboDisplayTextBlock->SetText(FText::FromString(*SelectedOption.Get()));
-	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
 
-	if (*SelectedOption.Get() == ListAll)
+	ESuperManagerListCondition Condition = ESuperManagerListCondition::All;
+	if (*SelectedOption.Get() == ListUnused)
 	{
-		DisplayAssetsData = StoredAssetsData;
+		Condition = ESuperManagerListCondition::Unused;
 	}
-	else if (*SelectedOption.Get() == ListUnused)
+	else if (*SelectedOption.Get() == ListSameName)
 	{
-		SuperManagerModule.ListUnusedAssetsForAssetList(StoredAssetsData, DisplayAssetsData);
+		Condition = ESuperManagerListCondition::SameName;
 	}
-	else if (*SelectedOption.Get() == ListSameName)
+	else if (*SelectedOption.Get() == ListSimilarTextures)
+	{
+		Condition = ESuperManagerListCondition::SimilarTextures;
+	}
+	else if (*SelectedOption.Get() == ListDuplicateMeshes)
+	{
+		Condition = ESuperManagerListCondition::DuplicateMeshes;
+	}
+	else if (*SelectedOption.Get() == ListDuplicateMaterialInstances)
 	{
-		SuperManagerModule.ListSameNameAsssetsForAssetList(StoredAssetsData, DisplayAssetsData);
+		Condition = ESuperManagerListCondition::DuplicateMaterialInstances;
 	}
-	RefreshAssetListView();
+	else if (*SelectedOption.Get() == ListTextureBudget)
+	{
+		Condition = ESuperManagerListCondition::TextureBudget;
+	}
+
+	RequestAssetList(Condition);
 }
 
 TSharedRef<STextBlock> SAdvanceDeletionTab::ConstructComboHelpTexts(const FString& TextContent, ETextJustify::Type TextJustify)
@@ -197,68 +322,74 @@ TSharedRef<STextBlock> SAdvanceDeletionTab::ConstructComboHelpTexts(const FStrin
 #pragma region RowWidgetForAssetListView
 TSharedRef<ITableRow> SAdvanceDeletionTab::OnGenerateRowForList(TSharedPtr<FAssetData> AssetDataToDisplay, const TSharedRef<STableViewBase>& OwnerTable)
 {
-	if (!AssetDataToDisplay.IsValid())
+	TSharedPtr<SAdvanceDeletionRow> Row;
+	if (RowPool.Num() > 0)
 	{
-		return SNew(STableRow<TSharedPtr<FAssetData>>, OwnerTable);
+		Row = RowPool.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Row = SNew(SAdvanceDeletionRow, OwnerTable)
+			.ClassFont(AssetClassNameFont)
+			.NameFont(AssetNameFont)
+			.OnIsChecked(this, &SAdvanceDeletionTab::IsAssetChecked)
+			.OnCheckStateChanged(this, &SAdvanceDeletionTab::OnCheckBoxStateChanged)
+			.OnDeleteClicked(this, &SAdvanceDeletionTab::OnDeleteButtonClicked);
 	}
 
-	const FString DisplayAssetClassName = AssetDataToDisplay->AssetClassPath.GetAssetName().ToString();
-	FSlateFontInfo AssetClassNameFont = GetEmboseedTextFont();
-	AssetClassNameFont.Size = 10;
-
-	const FString DisplayAssetName = AssetDataToDisplay->AssetName.ToString();
-	FSlateFontInfo AssetNameFont = GetEmboseedTextFont();
-	AssetNameFont.Size = 15;
-
-	TSharedRef<STableRow<TSharedPtr<FAssetData>>> ListViewRowWidget = SNew(STableRow<TSharedPtr<FAssetData>>, OwnerTable)
-		.Padding(FMargin(5.f))
-		[
-			SNew(SHorizontalBox)
-
-			+ SHorizontalBox::Slot()
-			.HAlign(HAlign_Left)
-			.VAlign(VAlign_Center)
-			.FillWidth(0.05f)
-			[
-				ConstructCheckBox(AssetDataToDisplay)
-			]
-
-			+ SHorizontalBox::Slot()
-			.HAlign(HAlign_Left)
-			.VAlign(VAlign_Fill)
-			.FillWidth(0.55)
-			[
-				ConstructTextForRowWidget(DisplayAssetClassName, AssetClassNameFont)
-			]
+	if (AssetDataToDisplay.IsValid())
+	{
+		Row->Bind(GetOrCreateRowViewModel(AssetDataToDisplay));
+	}
+	return Row.ToSharedRef();
+}
 
-			+ SHorizontalBox::Slot()
-			.HAlign(HAlign_Left)
-			.VAlign(VAlign_Fill)
-			[
-				ConstructTextForRowWidget(DisplayAssetName, AssetNameFont)
-			]
+void SAdvanceDeletionTab::OnRowReleased(const TSharedRef<ITableRow>& ReleasedRow)
+{
+	// 列表里的行都由 OnGenerateRowForList 生成
+	const TSharedRef<SAdvanceDeletionRow> Row = StaticCastSharedRef<SAdvanceDeletionRow>(ReleasedRow);
+	Row->Unbind();
+	RowPool.Add(Row);
+}
 
-			+ SHorizontalBox::Slot()
-			.HAlign(HAlign_Right)
-			.VAlign(VAlign_Fill)
-			[
-				ConstructButtonForWidget(AssetDataToDisplay)
-			]
+TSharedRef<const FSuperManagerAssetRowViewModel> SAdvanceDeletionTab::GetOrCreateRowViewModel(const TSharedPtr<FAssetData>& AssetDataToDisplay)
+{
+	if (const TSharedRef<const FSuperManagerAssetRowViewModel>* Existing = RowViewModels.Find(AssetDataToDisplay))
+	{
+		return *Existing;
+	}
 
-		];
+	const TSharedRef<FSuperManagerAssetRowViewModel> ViewModel = MakeShared<FSuperManagerAssetRowViewModel>();
+	ViewModel->AssetData = AssetDataToDisplay;
 
-	return ListViewRowWidget;
-}
+	// 类名和图标每个类只算一次
+	FClassDisplay* ClassDisplay = ClassDisplays.Find(AssetDataToDisplay->AssetClassPath);
+	if (!ClassDisplay)
+	{
+		ClassDisplay = &ClassDisplays.Add(AssetDataToDisplay->AssetClassPath);
+		ClassDisplay->ClassText = FText::FromName(AssetDataToDisplay->AssetClassPath.GetAssetName());
+		ClassDisplay->ClassIcon = FSlateIconFinder::FindIconBrushForClass(AssetDataToDisplay->GetClass());
+	}
+	ViewModel->ClassText = ClassDisplay->ClassText;
+	ViewModel->ClassIcon = ClassDisplay->ClassIcon;
+	ViewModel->NameText = FText::FromName(AssetDataToDisplay->AssetName);
+
+	const FSoftObjectPath ObjectPath = AssetDataToDisplay->GetSoftObjectPath();
+	const FString* AssetRoot = AssetRoots.Find(ObjectPath);
+	FString DisplayAssetRoot = AssetRoot ? *AssetRoot : FString();
+	// 相似/重复资产按组显示
+	if (const int32* AssetGroup = AssetGroups.Find(ObjectPath))
+	{
+		DisplayAssetRoot = FString::Printf(TEXT("[#%d] %s"), *AssetGroup + 1, *DisplayAssetRoot);
+	}
+	if (const FString* AssetDetail = AssetDetails.Find(ObjectPath))
+	{
+		DisplayAssetRoot += TEXT("\n") + *AssetDetail;
+	}
+	ViewModel->DetailText = FText::FromString(MoveTemp(DisplayAssetRoot));
 
-TSharedRef<SCheckBox> SAdvanceDeletionTab::ConstructCheckBox(const TSharedPtr<FAssetData>& AssetDataToDisplay)
-{
-	TSharedRef<SCheckBox> ConstructedCheckBox =
-		SNew(SCheckBox)
-		.Type(ESlateCheckBoxType::CheckBox)
-		.OnCheckStateChanged(this, &SAdvanceDeletionTab::OnCheckBoxStateChanged, AssetDataToDisplay)
-		.Visibility(EVisibility::Visible);
-	CheckBoxesArray.Add(ConstructedCheckBox);
-	return ConstructedCheckBox;
+	RowViewModels.Add(AssetDataToDisplay, ViewModel);
+	return ViewModel;
 }
 
 void SAdvanceDeletionTab::OnCheckBoxStateChanged(const ECheckBoxState NewState, TSharedPtr<FAssetData> AssetData)
@@ -266,57 +397,69 @@ void SAdvanceDeletionTab::OnCheckBoxStateChanged(const ECheckBoxState NewState,
 	switch (NewState)
 	{
 	case ECheckBoxState::Unchecked:
-		if (AssetDataToDeleteArray.Contains(AssetData))
-		{
-			AssetDataToDeleteArray.Remove(AssetData);
-		}
+		AssetDataToDeleteSet.Remove(AssetData);
 		break;
 	case ECheckBoxState::Checked:
-		AssetDataToDeleteArray.AddUnique(AssetData);
+		AssetDataToDeleteSet.Add(AssetData);
 		break;
 	case ECheckBoxState::Undetermined:
 		break;
 	}
 }
 
-TSharedRef<STextBlock> SAdvanceDeletionTab::ConstructTextForRowWidget(const FString& TextContent, const FSlateFontInfo& FontInfo)
+FReply SAdvanceDeletionTab::OnDeleteButtonClicked(TSharedPtr<FAssetData> ClickedAssetData)
 {
-	TSharedRef<STextBlock> ConstructedTextBlock =
-		SNew(STextBlock)
-		.Text(FText::FromString(TextContent))
-		.Font(FontInfo)
-		.ColorAndOpacity(FColor::White);
-	return ConstructedTextBlock;
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	const bool bAssetDeleted = SuperManagerModule.DeleteSingleAssetForAssetList(*ClickedAssetData.Get(), MakeQuarantineCallback());
+
+	if (bAssetDeleted)
+	{
+		// 刷新listview
+		RemoveDeletedAssetFromLists(ClickedAssetData);
+		RefreshAssetListView();
+	}
+	return FReply::Handled();
 }
 
-TSharedRef<SButton> SAdvanceDeletionTab::ConstructButtonForWidget(const TSharedPtr<FAssetData>& AssetDataToDisplay)
+void SAdvanceDeletionTab::RemoveDeletedAssetFromLists(const TSharedPtr<FAssetData>& DeletedAssetData)
 {
-	TSharedRef<SButton> ConstructButton =
-		SNew(SButton)
-		.Text(FText::FromString(TEXT("Delete")))
-		.OnClicked(this, &SAdvanceDeletionTab::OnDeleteButtonClicked, AssetDataToDisplay);
-	return ConstructButton;
+	RemoveDeletedPackageFromLists(DeletedAssetData->PackageName);
 }
 
-FReply SAdvanceDeletionTab::OnDeleteButtonClicked(TSharedPtr<FAssetData> ClickedAssetData)
+FOnQuarantineFinished SAdvanceDeletionTab::MakeQuarantineCallback()
 {
-	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
-	const bool bAssetDeleted = SuperManagerModule.DeleteSingleAssetForAssetList(*ClickedAssetData.Get());
-
-	if (bAssetDeleted)
+	TWeakPtr<SAdvanceDeletionTab> WeakThis = SharedThis(this);
+	return FOnQuarantineFinished::CreateLambda([WeakThis](const FSuperManagerQuarantineReport& Report)
 	{
-		// 刷新listview
-		if (StoredAssetsData.Contains(ClickedAssetData))
+		const TSharedPtr<SAdvanceDeletionTab> This = WeakThis.Pin();
+		if (!This.IsValid() || Report.Packages.Num() == 0)
 		{
-			StoredAssetsData.Remove(ClickedAssetData);
+			return;
 		}
-		if (DisplayAssetsData.Contains(ClickedAssetData))
+		const TSet<FName> MovedPackages(Report.Packages);
+		for (const FName MovedPackage : MovedPackages)
 		{
-			DisplayAssetsData.Remove(ClickedAssetData);
+			This->RemoveDeletedPackageFromLists(MovedPackage);
 		}
-		RefreshAssetListView();
-	}
-	return FReply::Handled();
+		for (auto It = This->AssetDataToDeleteSet.CreateIterator(); It; ++It)
+		{
+			if (MovedPackages.Contains((*It)->PackageName))
+			{
+				It.RemoveCurrent();
+			}
+		}
+		This->RefreshAssetListView();
+	});
+}
+
+void SAdvanceDeletionTab::RemoveDeletedPackageFromLists(FName DeletedPackageName)
+{
+	auto IsDeletedAsset = [DeletedPackageName](const TSharedPtr<FAssetData>& Data)
+	{
+		return Data->PackageName == DeletedPackageName;
+	};
+	StoredAssetsData.RemoveAll(IsDeletedAsset);
+	DisplayAssetsData.RemoveAll(IsDeletedAsset);
 }
 
 #pragma endregion
@@ -334,29 +477,22 @@ TSharedRef<SButton> SAdvanceDeletionTab::ConstructDeleteAllButton()
 
 FReply SAdvanceDeletionTab::OnDeleteAllButtonClicked()
 {
-	if (AssetDataToDeleteArray.Num() == 0)
+	if (AssetDataToDeleteSet.Num() == 0)
 	{
 		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("当前没有选中的资产"));
 		return FReply::Handled();
 	}
 	TArray<FAssetData> AssetDataToDelete;
-	for (TSharedPtr<FAssetData> Data : AssetDataToDeleteArray)
+	for (const TSharedPtr<FAssetData>& Data : AssetDataToDeleteSet)
 	{
 		AssetDataToDelete.Add(*Data.Get());
 	}
 	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
-	if (SuperManagerModule.DeleteMultipleAssetForAssetList(AssetDataToDelete))
+	if (SuperManagerModule.DeleteMultipleAssetForAssetList(AssetDataToDelete, MakeQuarantineCallback()))
 	{
-		for (TSharedPtr<FAssetData> Data : AssetDataToDeleteArray)
+		for (const TSharedPtr<FAssetData>& Data : AssetDataToDeleteSet)
 		{
-			if (StoredAssetsData.Contains(Data))
-			{
-				StoredAssetsData.Remove(Data);
-			}
-			if (DisplayAssetsData.Contains(Data))
-			{
-				DisplayAssetsData.Remove(Data);
-			}
+			RemoveDeletedAssetFromLists(Data);
 		}
 
 		RefreshAssetListView();
@@ -377,43 +513,155 @@ TSharedRef<SButton> SAdvanceDeletionTab::ConstructSelectAllButton()
 
 FReply SAdvanceDeletionTab::OnSelectAllButtonClicked()
 {
-	if (CheckBoxesArray.Num() == 0)
+	// 行的勾选框直接读取这里的状态，不可见的行也一并选中
+	AssetDataToDeleteSet.Append(DisplayAssetsData);
+	return FReply::Handled();
+}
+
+TSharedRef<SButton> SAdvanceDeletionTab::ConstructDeselectAllButton()
+{
+	TSharedRef<SButton> Button =
+		SNew(SButton)
+		.ContentPadding(5)
+		.OnClicked(this, &SAdvanceDeletionTab::OnDeselectAllButtonClicked);
+	Button->SetContent(ConstructTextForTabButtons(TEXT("Deselect All")));
+	return Button;
+}
+
+FReply SAdvanceDeletionTab::OnDeselectAllButtonClicked()
+{
+	AssetDataToDeleteSet.Empty();
+	return FReply::Handled();
+}
+
+TSharedRef<SButton> SAdvanceDeletionTab::ConstructConsolidateButton()
+{
+	TSharedRef<SButton> Button =
+		SNew(SButton)
+		.ContentPadding(5)
+		.IsEnabled(this, &SAdvanceDeletionTab::CanConsolidate)
+		.OnClicked(this, &SAdvanceDeletionTab::OnConsolidateButtonClicked);
+	Button->SetContent(ConstructTextForTabButtons(TEXT("Consolidate Groups")));
+	return Button;
+}
+
+bool SAdvanceDeletionTab::CanConsolidate() const
+{
+	return CurrentCondition == ESuperManagerListCondition::DuplicateMeshes ||
+		CurrentCondition == ESuperManagerListCondition::DuplicateMaterialInstances;
+}
+
+FReply SAdvanceDeletionTab::OnConsolidateButtonClicked()
+{
+	if (!CanConsolidate())
 	{
+		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("只能合并完全相同的重复资产，请先选择重复网格或重复材质实例的列举条件"));
 		return FReply::Handled();
 	}
-	for (TSharedRef<SCheckBox> CheckBox : CheckBoxesArray)
+
+	// 同组资产在列表中相邻，第一个作为保留项
+	TArray<FSuperManagerConsolidationGroup> Groups;
+	int32 LastGroupIndex = INDEX_NONE;
+	int32 NumDuplicates = 0;
+	for (const TSharedPtr<FAssetData>& Data : DisplayAssetsData)
 	{
-		if (!CheckBox->IsChecked())
+		const int32* GroupIndex = AssetGroups.Find(Data->GetSoftObjectPath());
+		if (!GroupIndex)
 		{
-			CheckBox->ToggleCheckedState();
+			continue;
+		}
+		if (*GroupIndex != LastGroupIndex)
+		{
+			LastGroupIndex = *GroupIndex;
+			Groups.AddDefaulted_GetRef().Keeper = *Data;
+		}
+		else
+		{
+			Groups.Last().Duplicates.Add(*Data);
+			++NumDuplicates;
 		}
 	}
+	if (NumDuplicates == 0)
+	{
+		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("当前列表中没有可合并的重复资产"));
+		return FReply::Handled();
+	}
+
+	EAppReturnType::Type ConfirmResult = DebugHeader::ShowMesDialog(EAppMsgType::YesNo,
+		FString::Printf(TEXT("将把 %d 组中的 %d 个重复资产的引用改指向每组第一个资产，然后删除它们，是否继续？"), Groups.Num(), NumDuplicates));
+	if (ConfirmResult != EAppReturnType::Yes)
+	{
+		return FReply::Handled();
+	}
+
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	TWeakPtr<SAdvanceDeletionTab> WeakThis = SharedThis(this);
+	SuperManagerModule.ConsolidateDuplicatesForAssetList(Groups, FOnConsolidationFinished::CreateLambda(
+		[WeakThis](const FSuperManagerConsolidationReport& Report)
+		{
+			DebugHeader::ShowNotifyInfo(Report.ToString());
+			if (const TSharedPtr<SAdvanceDeletionTab> This = WeakThis.Pin())
+			{
+				This->RequestAssetList(This->CurrentCondition);
+			}
+		}));
 	return FReply::Handled();
 }
 
-TSharedRef<SButton> SAdvanceDeletionTab::ConstructDeselectAllButton()
+TSharedRef<SButton> SAdvanceDeletionTab::ConstructExportButton(ESuperManagerExportFormat Format)
 {
 	TSharedRef<SButton> Button =
 		SNew(SButton)
 		.ContentPadding(5)
-		.OnClicked(this, &SAdvanceDeletionTab::OnDeselectAllButtonClicked);
-	Button->SetContent(ConstructTextForTabButtons(TEXT("Deselect All")));
+		.OnClicked(this, &SAdvanceDeletionTab::OnExportButtonClicked, Format);
+	Button->SetContent(ConstructTextForTabButtons(Format == ESuperManagerExportFormat::Json ? TEXT("Export JSON") : TEXT("Export CSV")));
 	return Button;
 }
 
-FReply SAdvanceDeletionTab::OnDeselectAllButtonClicked()
+FReply SAdvanceDeletionTab::OnExportButtonClicked(ESuperManagerExportFormat Format)
 {
-	if (CheckBoxesArray.Num() == 0)
+	TSharedPtr<FSuperManagerCancellationToken> PendingExportToken;
+	if (PendingExportTokens.RemoveAndCopyValue(Format, PendingExportToken))
 	{
+		PendingExportToken->Cancel();
 		return FReply::Handled();
 	}
-	for (TSharedRef<SCheckBox> CheckBox : CheckBoxesArray)
+	if (DisplayAssetsData.Num() == 0)
 	{
-		if (CheckBox->IsChecked())
-		{
-			CheckBox->ToggleCheckedState();
-		}
+		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("当前列表为空"));
+		return FReply::Handled();
+	}
+
+	// 每种条件固定一个文件，暂停后再次导出同一列表时才能找到上次的进度
+	FSuperManagerListingExportRequest Request;
+	Request.FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SuperManager"), TEXT("Exports"),
+	                                   FString::Printf(TEXT("AdvanceDeletion_%s.%s"), LexToString(CurrentCondition),
+	                                                   Format == ESuperManagerExportFormat::Json ? TEXT("json") : TEXT("csv")));
+	Request.Format = Format;
+	Request.Assets = DisplayAssetsData;
+	Request.AssetGroups = AssetGroups;
+	Request.bGroupBySameName = CurrentCondition == ESuperManagerListCondition::SameName;
+	if (SuperManagerListingExport::HasResumableProgress(Request.FilePath))
+	{
+		Request.bResume = DebugHeader::ShowMesDialog(EAppMsgType::YesNo,
+			TEXT("上次导出没有完成，是否从中断处继续？选择否将重新导出")) == EAppReturnType::Yes;
 	}
+
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	PendingExportTokens.Add(Format, Token);
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	TWeakPtr<SAdvanceDeletionTab> WeakThis = SharedThis(this);
+	SuperManagerListingExport::Run(*SuperManagerModule.GetTaskScheduler(), MoveTemp(Request), Token, FOnListingExportFinished::CreateLambda(
+		[WeakThis, Token, Format](const FSuperManagerListingExportResult& Result)
+		{
+			DebugHeader::ShowNotifyInfo(Result.ToString());
+			const TSharedPtr<SAdvanceDeletionTab> This = WeakThis.Pin();
+			if (This.IsValid() && This->PendingExportTokens.FindRef(Format) == Token)
+			{
+				This->PendingExportTokens.Remove(Format);
+			}
+		}));
+	DebugHeader::ShowNotifyInfo(TEXT("正在后台导出，再次点击导出按钮可以暂停"));
 	return FReply::Handled();
 }
 #pragma endregion
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SlateWidgets/LoadChainWidget.h"
+
+#include "SuperManager.h"
+#include "Misc/PackageName.h"
+
+void SLoadChainTab::Construct(const FArguments& InArgs)
+{
+	bCanSupportFocus = true;
+
+	FSlateFontInfo TitleTextFont = GetEmboseedTextFont();
+	TitleTextFont.Size = 30;
+
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+
+		// title
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString("Load Chain"))
+			.Font(TitleTextFont)
+			.Justification(ETextJustify::Center)
+			.ColorAndOpacity(FColor::White)
+		]
+
+		// 闭包大小与分析耗时
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(5)
+		[
+			SNew(STextBlock)
+			.Text(this, &SLoadChainTab::GetSummaryText)
+			.AutoWrapText(true)
+		]
+
+		// 按收益排序的边
+		+ SVerticalBox::Slot()
+		[
+			SNew(SScrollBox)
+			+ SScrollBox::Slot()
+			[
+				SAssignNew(ConstructedEdgeListView, SListView<TSharedPtr<FSuperManagerLoadChainEdge>>)
+				.ItemHeight(24)
+				.ListItemsSource(&DisplayEdges)
+				.OnGenerateRow(this, &SLoadChainTab::OnGenerateRowForEdge)
+				.OnMouseButtonClick(this, &SLoadChainTab::OnEdgeClicked)
+			]
+		]
+	];
+
+	AnalyzePackage(InArgs._RootPackage);
+}
+
+SLoadChainTab::~SLoadChainTab()
+{
+	if (PendingRequestToken.IsValid())
+	{
+		PendingRequestToken->Cancel();
+	}
+}
+
+void SLoadChainTab::AnalyzePackage(FName RootPackage)
+{
+	if (PendingRequestToken.IsValid())
+	{
+		PendingRequestToken->Cancel();
+	}
+	if (RootPackage.IsNone())
+	{
+		return;
+	}
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	PendingRequestToken = Token;
+	bIsLoading = true;
+	Result.Reset();
+	DisplayEdges.Empty();
+	ConstructedEdgeListView->RequestListRefresh();
+
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	TWeakPtr<SLoadChainTab> WeakThis = SharedThis(this);
+	SuperManagerModule.RequestLoadChainForPackage(RootPackage,
+		[WeakThis](const TSharedRef<const FSuperManagerLoadChainResult>& NewResult)
+		{
+			const TSharedPtr<SLoadChainTab> This = WeakThis.Pin();
+			if (!This.IsValid())
+			{
+				return;
+			}
+			This->bIsLoading = false;
+			This->Result = NewResult;
+			This->DisplayEdges.Reset(NewResult->Edges.Num());
+			for (const FSuperManagerLoadChainEdge& Edge : NewResult->Edges)
+			{
+				This->DisplayEdges.Add(MakeShared<FSuperManagerLoadChainEdge>(Edge));
+			}
+			This->ConstructedEdgeListView->RequestListRefresh();
+		}, Token);
+}
+
+FText SLoadChainTab::GetSummaryText() const
+{
+	if (bIsLoading)
+	{
+		return FText::FromString(TEXT("正在分析硬引用..."));
+	}
+	if (!Result.IsValid())
+	{
+		return FText::FromString(TEXT("在内容浏览器中右键资产，选择 Analyze Load Chain"));
+	}
+	return FText::FromString(FString::Printf(
+		TEXT("%s\n硬引用闭包: %d 个包, %s (分析耗时 %.1f ms)\n下列引用改为软引用后，闭包可减少对应的大小。点击条目定位到被引用的资产"),
+		*Result->RootPackage.ToString(), Result->NumPackages, *FText::AsMemory(Result->TotalBytes).ToString(),
+		Result->AnalysisSeconds * 1000.0));
+}
+
+TSharedRef<ITableRow> SLoadChainTab::OnGenerateRowForEdge(TSharedPtr<FSuperManagerLoadChainEdge> Edge, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	FSlateFontInfo EdgeFont = GetEmboseedTextFont();
+	EdgeFont.Size = 12;
+
+	// 支配者链说明被引用者是经过哪条路径被拉进来的
+	const TArray<FName> Chain = Result.IsValid() ? Result->GetDominatorChain(Edge->Referencer) : TArray<FName>();
+	TArray<FString> ChainNames;
+	for (const FName PackageName : Chain)
+	{
+		ChainNames.Add(FPackageName::GetShortName(PackageName));
+	}
+
+	return SNew(STableRow<TSharedPtr<FSuperManagerLoadChainEdge>>, OwnerTable)
+		.Padding(FMargin(5.f))
+		[
+			SNew(SHorizontalBox)
+
+			+ SHorizontalBox::Slot()
+			.HAlign(HAlign_Left)
+			.VAlign(VAlign_Center)
+			.FillWidth(0.7f)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(FString::Printf(TEXT("%s -> %s\n%s"), *Edge->Referencer.ToString(), *Edge->Dependency.ToString(),
+				                                        *FString::Join(ChainNames, TEXT(" > ")))))
+				.Font(EdgeFont)
+			]
+
+			+ SHorizontalBox::Slot()
+			.HAlign(HAlign_Right)
+			.VAlign(VAlign_Center)
+			.FillWidth(0.3f)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(FString::Printf(TEXT("%s (%d 个包)"), *FText::AsMemory(Edge->RetainedBytes).ToString(),
+				                                        Edge->RetainedPackages)))
+				.Font(EdgeFont)
+			]
+		];
+}
+
+void SLoadChainTab::OnEdgeClicked(TSharedPtr<FSuperManagerLoadChainEdge> ClickedEdge)
+{
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	SuperManagerModule.SyncCBToClickedAssetForAssetList(ClickedEdge->Dependency.ToString());
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SlateWidgets/UnusedAssetStatusWidget.h"
+
+#include "SuperManager.h"
+#include "AssetIndex/FolderTrie.h"
+#include "AssetIndex/UnusedAssetTracker.h"
+
+void SUnusedAssetStatusWidget::Construct(const FArguments& InArgs)
+{
+	Folders = InArgs._Folders;
+
+	FSuperManagerModule& SuperManagerModule = FModuleManager::LoadModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+	TrackerWeakPtr = SuperManagerModule.GetUnusedAssetTracker();
+
+	ChildSlot
+	[
+		SAssignNew(StatusTextBlock, STextBlock)
+		.AutoWrapText(true)
+	];
+
+	// 只在计数批量更新后刷新文字，不在每帧重新统计
+	if (const TSharedPtr<FSuperManagerUnusedAssetTracker> Tracker = TrackerWeakPtr.Pin())
+	{
+		StatsChangedHandle = Tracker->OnStatsChanged().AddSP(this, &SUnusedAssetStatusWidget::UpdateStatusText);
+	}
+	UpdateStatusText();
+}
+
+SUnusedAssetStatusWidget::~SUnusedAssetStatusWidget()
+{
+	if (const TSharedPtr<FSuperManagerUnusedAssetTracker> Tracker = TrackerWeakPtr.Pin())
+	{
+		Tracker->OnStatsChanged().Remove(StatsChangedHandle);
+	}
+}
+
+FText SUnusedAssetStatusWidget::MakeStatusText(const FSuperManagerUnusedAssetTracker& Tracker, const TArray<FString>& Folders)
+{
+	if (!Tracker.IsReady())
+	{
+		return FText::FromString(TEXT("未使用资产: 统计中..."));
+	}
+
+	TArray<FString> Roots;
+	FSuperManagerFolderTrie::NormalizeRoots(Folders, Roots);
+
+	FSuperManagerUnusedStats TotalStats;
+	for (const FString& Root : Roots)
+	{
+		const FSuperManagerUnusedStats RootStats = Tracker.GetFolderStats(Root);
+		TotalStats.NumUnusedAssets += RootStats.NumUnusedAssets;
+		TotalStats.UnusedBytes += RootStats.UnusedBytes;
+	}
+
+	return FText::Format(FText::FromString(TEXT("未使用资产: {0} 个 ({1})")),
+	                     FText::AsNumber(TotalStats.NumUnusedAssets), FText::AsMemory(TotalStats.UnusedBytes));
+}
+
+void SUnusedAssetStatusWidget::UpdateStatusText()
+{
+	const TSharedPtr<FSuperManagerUnusedAssetTracker> Tracker = TrackerWeakPtr.Pin();
+	if (Tracker.IsValid() && StatusTextBlock.IsValid())
+	{
+		StatusTextBlock->SetText(MakeStatusText(*Tracker, Folders));
+	}
+}
@@ -7,23 +7,270 @@
 #include "ObjectTools.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "AssetToolsModule.h"
+#include "Async/ParallelFor.h"
 #include "EditorAssetLibrary.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "AssetIndex/FolderTrie.h"
+#include "Audit/TextureBudgetAudit.h"
+#include "AssetIndex/UnusedAssetTracker.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "References/StringReferenceScanner.h"
+#include "Settings/SuperManagerSettings.h"
 #include "SlateWidgets/AdvanceDeletionWidget.h"
+#include "SlateWidgets/LoadChainWidget.h"
+#include "SlateWidgets/UnusedAssetStatusWidget.h"
+#include "UObject/StrongObjectPtr.h"
 
 #define LOCTEXT_NAMESPACE "FSuperManagerModule"
 
+namespace SuperManagerAssetLists
+{
+	// 指纹和审计结果按包名存放，包里别的类型的资产不是候选，只取指定类型的那个，避免同包资产互相覆盖
+	TMap<FName, TSharedPtr<FAssetData>> MapCandidatesByPackage(const TArray<TSharedPtr<FAssetData>>& Assets, const FTopLevelAssetPath& ClassPath)
+	{
+		TMap<FName, TSharedPtr<FAssetData>> CandidatesByPackage;
+		for (const TSharedPtr<FAssetData>& DataSharedPtr : Assets)
+		{
+			if (DataSharedPtr->AssetClassPath == ClassPath)
+			{
+				CandidatesByPackage.Add(DataSharedPtr->PackageName, DataSharedPtr);
+			}
+		}
+		return CandidatesByPackage;
+	}
+}
+
+namespace SuperManagerStartup
+{
+	FAutoConsoleCommand DumpStatsCommand(
+		TEXT("SuperManager.StartupStats"),
+		TEXT("打印SuperManager模块启动和各子系统初始化的耗时"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (!FModuleManager::Get().IsModuleLoaded(TEXT("SuperManager")))
+			{
+				return;
+			}
+			const FSuperManagerModule& SuperManagerModule = FModuleManager::GetModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+			const FSuperManagerStartupStats& Stats = SuperManagerModule.GetStartupStats();
+			UE_LOG(LogTemp, Display, TEXT("SuperManager startup: StartupModule %.2f ms, menu extension %s%s (budget %.2f ms)"),
+			       Stats.StartupModuleMs,
+			       Stats.bMenuExtensionInitialized ? *FString::Printf(TEXT("%.2f ms"), Stats.MenuExtensionMs) : TEXT("not initialized"),
+			       Stats.bMenuExtensionDeferred ? TEXT(" (deferred)") : TEXT(""), USuperManagerSettings::Get()->StartupBudgetMs);
+			for (int32 Index = 0; Index < FSuperManagerStartupStats::NumSubsystems; ++Index)
+			{
+				UE_LOG(LogTemp, Display, TEXT("  %s: %s"), LexToString(static_cast<ESuperManagerSubsystem>(Index)),
+				       Stats.bSubsystemInitialized[Index] ? *FString::Printf(TEXT("%.2f ms"), Stats.SubsystemMs[Index]) : TEXT("not initialized"));
+			}
+		}));
+}
+
+const TCHAR* LexToString(ESuperManagerSubsystem Subsystem)
+{
+	switch (Subsystem)
+	{
+	case ESuperManagerSubsystem::FolderTrie: return TEXT("FolderTrie");
+	case ESuperManagerSubsystem::AssetListCache: return TEXT("AssetListCache");
+	case ESuperManagerSubsystem::StringReferences: return TEXT("StringReferences");
+	case ESuperManagerSubsystem::UnusedAssetTracker: return TEXT("UnusedAssetTracker");
+	case ESuperManagerSubsystem::TextureSimilarity: return TEXT("TextureSimilarity");
+	case ESuperManagerSubsystem::MeshDuplicates: return TEXT("MeshDuplicates");
+	case ESuperManagerSubsystem::MaterialInstanceDuplicates: return TEXT("MaterialInstanceDuplicates");
+	case ESuperManagerSubsystem::ThumbnailCache: return TEXT("ThumbnailCache");
+	case ESuperManagerSubsystem::Quarantine: return TEXT("Quarantine");
+	default: return TEXT("Unknown");
+	}
+}
+
 void FSuperManagerModule::StartupModule()
 {
-	InitCBMenuExtention();
+	TRACE_CPUPROFILER_EVENT_SCOPE(SuperManager_StartupModule);
+	const double StartTime = FPlatformTime::Seconds();
+
+	TaskScheduler = MakeShared<FSuperManagerTaskScheduler>();
+	TaskScheduler->Initialize();
+
+	// 这里只创建对象，Initialize 推迟到 EnsureSubsystem
+	FolderTrie = MakeShared<FSuperManagerFolderTrie>();
+	AssetListCache = MakeShared<FSuperManagerAssetListCache>();
+	StringReferenceScanner = MakeShared<FSuperManagerStringReferenceScanner>(TaskScheduler.ToSharedRef());
+	UnusedAssetTracker = MakeShared<FSuperManagerUnusedAssetTracker>(FolderTrie.ToSharedRef(), TaskScheduler.ToSharedRef(), [this](FName PackageName)
+	{
+		return IsPackageUnused(PackageName);
+	});
+	StringReferenceScanner->OnReferencesChanged().AddRaw(this, &FSuperManagerModule::OnStringReferencesChanged);
+	TextureSimilarity = MakeShared<FSuperManagerTextureSimilarity>(TaskScheduler.ToSharedRef());
+	MeshDuplicates = MakeShared<FSuperManagerMeshDuplicates>(TaskScheduler.ToSharedRef());
+	MaterialInstanceDuplicates = MakeShared<FSuperManagerMaterialInstanceDuplicates>(TaskScheduler.ToSharedRef());
+	ThumbnailCache = MakeShared<FSuperManagerThumbnailCache>(TaskScheduler.ToSharedRef());
+	Quarantine = MakeShared<FSuperManagerQuarantine>(TaskScheduler.ToSharedRef(), StringReferenceScanner.ToSharedRef());
+
+	if (FModuleManager::Get().IsModuleLoaded(TEXT("ContentBrowser")))
+	{
+		InitCBMenuExtention();
+	}
+	else
+	{
+		StartupStats.bMenuExtensionDeferred = true;
+		ModulesChangedHandle = FModuleManager::Get().OnModulesChanged().AddRaw(this, &FSuperManagerModule::OnModulesChanged);
+	}
 
 	RegisterAdvanceDeletionTab();
+	RegisterLoadChainTab();
+
+	IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	if (AssetRegistry.IsLoadingAssets())
+	{
+		FilesLoadedHandle = AssetRegistry.OnFilesLoaded().AddRaw(this, &FSuperManagerModule::EnqueueDeferredInitialization);
+	}
+	else
+	{
+		EnqueueDeferredInitialization();
+	}
+
+	StartupStats.StartupModuleMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	const float StartupBudgetMs = USuperManagerSettings::Get()->StartupBudgetMs;
+	if (StartupBudgetMs > 0.f && StartupStats.StartupModuleMs > StartupBudgetMs)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SuperManager startup took %.2f ms, over the %.2f ms budget"), StartupStats.StartupModuleMs, StartupBudgetMs);
+	}
+}
+
+#pragma region 延迟初始化
+
+void FSuperManagerModule::EnsureSubsystem(ESuperManagerSubsystem Subsystem) const
+{
+	const int32 SubsystemIndex = static_cast<int32>(Subsystem);
+	check(IsInGameThread());
+	if (StartupStats.bSubsystemInitialized[SubsystemIndex])
+	{
+		return;
+	}
+
+	// 依赖先初始化，耗时分开统计
+	switch (Subsystem)
+	{
+	case ESuperManagerSubsystem::UnusedAssetTracker:
+		EnsureSubsystem(ESuperManagerSubsystem::FolderTrie);
+		EnsureSubsystem(ESuperManagerSubsystem::StringReferences);
+		break;
+	case ESuperManagerSubsystem::Quarantine:
+		EnsureSubsystem(ESuperManagerSubsystem::StringReferences);
+		break;
+	default:
+		break;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*WriteToString<64>(TEXT("SuperManager_Initialize"), LexToString(Subsystem)));
+	const double StartTime = FPlatformTime::Seconds();
+	switch (Subsystem)
+	{
+	case ESuperManagerSubsystem::FolderTrie:
+		FolderTrie->Initialize();
+		break;
+	case ESuperManagerSubsystem::AssetListCache:
+		AssetListCache->Initialize();
+		break;
+	case ESuperManagerSubsystem::StringReferences:
+		StringReferenceScanner->Initialize();
+		break;
+	case ESuperManagerSubsystem::UnusedAssetTracker:
+		UnusedAssetTracker->Initialize();
+		break;
+	case ESuperManagerSubsystem::TextureSimilarity:
+		TextureSimilarity->Initialize();
+		break;
+	case ESuperManagerSubsystem::MeshDuplicates:
+		MeshDuplicates->Initialize();
+		break;
+	case ESuperManagerSubsystem::MaterialInstanceDuplicates:
+		MaterialInstanceDuplicates->Initialize();
+		break;
+	case ESuperManagerSubsystem::ThumbnailCache:
+		ThumbnailCache->Initialize();
+		break;
+	case ESuperManagerSubsystem::Quarantine:
+		Quarantine->Initialize();
+		break;
+	default:
+		checkNoEntry();
+		return;
+	}
+	StartupStats.SubsystemMs[SubsystemIndex] = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	StartupStats.bSubsystemInitialized[SubsystemIndex] = true;
+}
+
+void FSuperManagerModule::EnsureSubsystemsForCondition(ESuperManagerListCondition Condition) const
+{
+	EnsureSubsystem(ESuperManagerSubsystem::FolderTrie);
+	EnsureSubsystem(ESuperManagerSubsystem::AssetListCache);
+	EnsureSubsystem(ESuperManagerSubsystem::StringReferences);
+	switch (Condition)
+	{
+	case ESuperManagerListCondition::SimilarTextures:
+		EnsureSubsystem(ESuperManagerSubsystem::TextureSimilarity);
+		break;
+	case ESuperManagerListCondition::DuplicateMeshes:
+		EnsureSubsystem(ESuperManagerSubsystem::MeshDuplicates);
+		break;
+	case ESuperManagerListCondition::DuplicateMaterialInstances:
+		EnsureSubsystem(ESuperManagerSubsystem::MaterialInstanceDuplicates);
+		break;
+	default:
+		break;
+	}
+}
+
+void FSuperManagerModule::EnqueueDeferredInitialization()
+{
+	// Background 阶段只在高优先级的工作都做完、帧预算还有剩余时执行，也就是编辑器空闲的时候
+	TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.DeferredInitialization"), [this]()
+	{
+		int32 NextIndex = 0;
+		while (NextIndex < FSuperManagerStartupStats::NumSubsystems && StartupStats.bSubsystemInitialized[NextIndex])
+		{
+			++NextIndex;
+		}
+		if (NextIndex < FSuperManagerStartupStats::NumSubsystems)
+		{
+			EnsureSubsystem(static_cast<ESuperManagerSubsystem>(NextIndex++));
+		}
+		return NextIndex >= FSuperManagerStartupStats::NumSubsystems;
+	}, DeferredInitializationToken, ESuperManagerTaskPriority::Background);
 }
 
+#pragma endregion
+
 #pragma region 内容浏览器拓展
 
+void FSuperManagerModule::OnModulesChanged(FName ModuleName, EModuleChangeReason Reason)
+{
+	if (ModuleName == TEXT("ContentBrowser") && Reason == EModuleChangeReason::ModuleLoaded)
+	{
+		FModuleManager::Get().OnModulesChanged().Remove(ModulesChangedHandle);
+		ModulesChangedHandle.Reset();
+		InitCBMenuExtention();
+
+		// 推迟注册的菜单扩展同样算启动开销
+		const float StartupBudgetMs = USuperManagerSettings::Get()->StartupBudgetMs;
+		if (StartupBudgetMs > 0.f && StartupStats.GetBudgetedMs() > StartupBudgetMs)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("SuperManager startup took %.2f ms including the menu extension, over the %.2f ms budget"),
+			       StartupStats.GetBudgetedMs(), StartupBudgetMs);
+		}
+	}
+}
+
 void FSuperManagerModule::InitCBMenuExtention()
 {
-	// 加载内容浏览器
+	TRACE_CPUPROFILER_EVENT_SCOPE(SuperManager_InitCBMenuExtention);
+	const double StartTime = FPlatformTime::Seconds();
+
+	// 内容浏览器已经加载，这里只是取到它
 	FContentBrowserModule& ContentBrowserModule =
 		FModuleManager::LoadModuleChecked<FContentBrowserModule>(TEXT("ContentBrowser"));
 
@@ -41,6 +288,17 @@ void FSuperManagerModule::InitCBMenuExtention()
 			this, &FSuperManagerModule::CustomCBMenuExtender
 		)
 	);
+
+	// 资产的右键菜单
+	TArray<FContentBrowserMenuExtender_SelectedAssets>& AssetViewContextMenuExtenders = ContentBrowserModule.GetAllAssetViewContextMenuExtenders();
+	AssetViewContextMenuExtenders.Add(
+		FContentBrowserMenuExtender_SelectedAssets::CreateRaw(
+			this, &FSuperManagerModule::CustomCBAssetMenuExtender
+		)
+	);
+
+	StartupStats.MenuExtensionMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	StartupStats.bMenuExtensionInitialized = true;
 }
 
 TSharedRef<FExtender> FSuperManagerModule::CustomCBMenuExtender(const TArray<FString>& SelectedPaths)
@@ -65,6 +323,15 @@ TSharedRef<FExtender> FSuperManagerModule::CustomCBMenuExtender(const TArray<FSt
 
 void FSuperManagerModule::AddCBMenuEntry(FMenuBuilder& MenuBuilder)
 {
+	// 实时计数，不会触发扫描；点击后打开高级删除面板查看具体资产
+	// 菜单里不初始化子系统，计数器还没建好时显示统计中，由空闲时的延迟初始化或点击后打开的面板去建
+	MenuBuilder.AddMenuEntry(
+		SUnusedAssetStatusWidget::MakeStatusText(*UnusedAssetTracker, FolderPathsSelected),
+		FText::FromString(TEXT("选中目录下未被引用的资产数量与磁盘大小")),
+		FSlateIcon(),
+		FExecuteAction::CreateRaw(this, &FSuperManagerModule::AdvanceDeletionButtonClicked)
+	);
+
 	MenuBuilder.AddMenuEntry(
 		FText::FromString(TEXT("删除未被使用的资产")),
 		FText::FromString(TEXT("安全的删除未被使用的资产")),
@@ -79,6 +346,21 @@ void FSuperManagerModule::AddCBMenuEntry(FMenuBuilder& MenuBuilder)
 		FExecuteAction::CreateRaw(this, &FSuperManagerModule::OnDeleteEmptyFolders)
 	);
 
+	// 隔离区还没初始化时不在菜单里读清单，目录在隔离区下就先显示，点击时再确认是不是一个批次
+	const bool bMaybeQuarantineBatch = FolderPathsSelected.Num() == 1 &&
+		(IsSubsystemInitialized(ESuperManagerSubsystem::Quarantine)
+			 ? !Quarantine->FindBatchIdForPath(FolderPathsSelected[0]).IsEmpty()
+			 : FolderPathsSelected[0].StartsWith(FSuperManagerQuarantine::GetRoot() + TEXT("/")));
+	if (bMaybeQuarantineBatch)
+	{
+		MenuBuilder.AddMenuEntry(
+			FText::FromString(TEXT("恢复隔离的资产")),
+			FText::FromString(TEXT("把这个隔离批次中的资产全部移回原位置")),
+			FSlateIcon(),
+			FExecuteAction::CreateRaw(this, &FSuperManagerModule::OnRestoreQuarantineBatchClicked)
+		);
+	}
+
 	MenuBuilder.AddMenuEntry(
 		FText::FromString(TEXT("高级删除")),
 		FText::FromString(TEXT("List assets by specific condition in a tab for deleting")),
@@ -93,59 +375,44 @@ void FSuperManagerModule::OnDeleteUnusedAssetButtonClicked()
 	{
 		return;
 	}
-	if (FolderPathsSelected.Num() > 1)
-	{
-		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("请不要同时选取多个文件"));
-		return;
-	}
-
-	const TArray<FString> AssetsPathNames = UEditorAssetLibrary::ListAssets(FolderPathsSelected[0]);
-
-	if (AssetsPathNames.Num() == 0)
-	{
-		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("当前目录下未查找到资产"));
-		return;
-	}
-
-	EAppReturnType::Type ConfirmResult = DebugHeader::ShowMesDialog(EAppMsgType::YesNo,TEXT("当前文件夹下有") + FString::FromInt(AssetsPathNames.Num()) + TEXT("个文件，是否确认删除？"));
-	DebugHeader::Print(TEXT("当前选中的文件夹：") + FolderPathsSelected[0]);
-
-	if (ConfirmResult == EAppReturnType::No)
-	{
-		return;
-	}
-
-	FixUpRedirectors();
 
-	TArray<FAssetData> UnusedAssetDataArray;
-	for (const FString& AssetPathName : AssetsPathNames)
+	// 枚举和引用分析都在调度器上进行，对话框和删除在游戏线程的回调里执行
+	const TArray<FString> Folders = FolderPathsSelected;
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	RequestAssetListForFolders(Folders, ESuperManagerListCondition::All, [this, Folders, Token](const TSharedRef<const FSuperManagerAssetList>& AllAssetList)
 	{
-		// 过滤掉不需要检索的文件
-		if (AssetPathName.Contains(TEXT("Developers")) ||
-			AssetPathName.Contains(TEXT("Collections"))
-		)
+		if (AllAssetList->Assets.Num() == 0)
 		{
-			continue;
+			DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("当前目录下未查找到资产"));
+			return;
 		}
 
-		if (!UEditorAssetLibrary::DoesAssetExist(AssetPathName))continue;
-
-		TArray<FString> AssetReferences = UEditorAssetLibrary::FindPackageReferencersForAsset(AssetPathName);
+		EAppReturnType::Type ConfirmResult = DebugHeader::ShowMesDialog(EAppMsgType::YesNo,TEXT("当前文件夹下有") + FString::FromInt(AllAssetList->Assets.Num()) + TEXT("个文件，是否确认删除？"));
+		DebugHeader::Print(TEXT("当前选中的文件夹：") + FString::Join(Folders, TEXT(", ")));
 
-		if (AssetReferences.Num() == 0)
+		if (ConfirmResult == EAppReturnType::No)
 		{
-			const FAssetData UnusedAssetData = UEditorAssetLibrary::FindAssetData(AssetPathName);
-			UnusedAssetDataArray.Add(UnusedAssetData);
+			return;
 		}
-	}
-	if (UnusedAssetDataArray.Num() > 0)
-	{
-		ObjectTools::DeleteAssets(UnusedAssetDataArray);
-	}
-	else
-	{
-		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("当前文件夹下没有未被引用的资产"));
-	}
+
+		RequestAssetListForFolders(Folders, ESuperManagerListCondition::Unused, [this](const TSharedRef<const FSuperManagerAssetList>& UnusedAssetList)
+		{
+			TArray<FAssetData> UnusedAssetDataArray;
+			UnusedAssetDataArray.Reserve(UnusedAssetList->Assets.Num());
+			for (const TSharedPtr<FAssetData>& UnusedAssetData : UnusedAssetList->Assets)
+			{
+				UnusedAssetDataArray.Add(*UnusedAssetData);
+			}
+			if (UnusedAssetDataArray.Num() > 0)
+			{
+				DeleteMultipleAssetForAssetList(UnusedAssetDataArray);
+			}
+			else
+			{
+				DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("当前文件夹下没有未被引用的资产"));
+			}
+		}, Token);
+	}, Token);
 }
 
 void FSuperManagerModule::OnDeleteEmptyFolders()
@@ -155,37 +422,105 @@ void FSuperManagerModule::OnDeleteEmptyFolders()
 		return;
 	}
 
-	for (FString FolderPathSelected : FolderPathsSelected)
+	// 每个目录的检查与删除作为一个游戏线程阶段，大量目录时按帧分摊
+	EnsureSubsystem(ESuperManagerSubsystem::FolderTrie);
+	const FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+	for (const FString& FolderPathSelected : FolderPathsSelected)
 	{
-		const TArray<FString> FilePaths = UEditorAssetLibrary::ListAssets(FolderPathSelected, true, true);
-		for (FString FilePath : FilePaths)
+		TArray<FName> FolderPaths;
+		FolderTrie->EnumerateSubtree(FolderPathSelected, FolderPaths);
+		for (const FName& FolderPath : FolderPaths)
 		{
-			if (FilePath.Contains(TEXT("Developers")) ||
-				FilePath.Contains(TEXT("Collections")))
+			// 选中的目录本身不删除
+			if (FolderPath.ToString().Equals(FolderPathSelected))
 			{
 				continue;
 			}
-			if (!UEditorAssetLibrary::DoesDirectoryExist(FilePath))
+			TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.DeleteEmptyFolder"), [FolderPath]()
 			{
-				continue;
-			}
-			if (UEditorAssetLibrary::DoesDirectoryHaveAssets(FilePath))
-			{
-				continue;
-			}
-			// 判断目录中是否有资产
-			UEditorAssetLibrary::DeleteDirectory(FilePath);
+				const FString FolderPathString = FolderPath.ToString();
+				if (!UEditorAssetLibrary::DoesDirectoryExist(FolderPathString))
+				{
+					return true;
+				}
+				// 判断目录中是否有资产
+				if (IAssetRegistry::GetChecked().HasAssets(FolderPath, true))
+				{
+					return true;
+				}
+				UEditorAssetLibrary::DeleteDirectory(FolderPathString);
+				return true;
+			}, Token);
 		}
 	}
 }
 
-void FSuperManagerModule::AdvanceDeletionButtonClicked()
+void FSuperManagerModule::OnRestoreQuarantineBatchClicked()
 {
-	FixUpRedirectors();
+	if (FolderPathsSelected.Num() != 1)
+	{
+		return;
+	}
+	const FString BatchId = GetQuarantine()->FindBatchIdForPath(FolderPathsSelected[0]);
+	if (BatchId.IsEmpty())
+	{
+		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("选中的目录不是一个隔离批次"));
+		return;
+	}
+	const bool bStarted = GetQuarantine()->RestoreBatch(BatchId, FOnQuarantineFinished::CreateLambda([](const FSuperManagerQuarantineReport& Report)
+	{
+		DebugHeader::ShowNotifyInfo(Report.ToString());
+	}));
+	if (!bStarted)
+	{
+		DebugHeader::ShowMesDialog(EAppMsgType::Ok,TEXT("这个批次正在处理中，请稍后再试"));
+	}
+}
 
+void FSuperManagerModule::AdvanceDeletionButtonClicked()
+{
+	// 重定向器修复放到了未命中缓存时才执行
 	FGlobalTabmanager::Get()->TryInvokeTab(FName("AdvanceDeletion"));
 }
 
+TSharedRef<FExtender> FSuperManagerModule::CustomCBAssetMenuExtender(const TArray<FAssetData>& SelectedAssets)
+{
+	TSharedRef<FExtender> MenuExtender(new FExtender());
+
+	// 只分析单个资产
+	if (SelectedAssets.Num() == 1)
+	{
+		MenuExtender->AddMenuExtension(
+			FName("AssetContextReferences"),
+			EExtensionHook::After,
+			TSharedPtr<FUICommandList>(),
+			FMenuExtensionDelegate::CreateRaw(this, &FSuperManagerModule::AddCBAssetMenuEntry));
+
+		AssetPackageSelected = SelectedAssets[0].PackageName;
+	}
+
+	return MenuExtender;
+}
+
+void FSuperManagerModule::AddCBAssetMenuEntry(FMenuBuilder& MenuBuilder)
+{
+	MenuBuilder.AddMenuEntry(
+		FText::FromString(TEXT("Analyze Load Chain")),
+		FText::FromString(TEXT("统计打开该资产时会一起加载的硬引用，并列出改为软引用后收益最大的引用")),
+		FSlateIcon(),
+		FExecuteAction::CreateRaw(this, &FSuperManagerModule::OnAnalyzeLoadChainButtonClicked)
+	);
+}
+
+void FSuperManagerModule::OnAnalyzeLoadChainButtonClicked()
+{
+	if (const TSharedPtr<SLoadChainTab> ExistingTab = LoadChainTab.Pin())
+	{
+		ExistingTab->AnalyzePackage(AssetPackageSelected);
+	}
+	FGlobalTabmanager::Get()->TryInvokeTab(FName("LoadChain"));
+}
+
 void FSuperManagerModule::FixUpRedirectors()
 {
 	TArray<UObjectRedirector*> RedirectorToFixArray;
@@ -193,10 +528,11 @@ void FSuperManagerModule::FixUpRedirectors()
 	const FAssetRegistryModule& AssetRegistryModule =
 		FModuleManager::Get().LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
 
+	// 排除规则只用于无引用扫描，被排除目录里的重定向器同样要修复，否则它的目标会一直显示为被引用
 	FARFilter Filter;
 	Filter.bRecursivePaths = true;
 	Filter.PackagePaths.Emplace("/Game");
-	Filter.ClassPaths.Emplace("/Script/CoreUObject.UObjectRedirector");
+	Filter.ClassPaths.Add(UObjectRedirector::StaticClass()->GetClassPathName());
 
 	TArray<FAssetData> OutRedirectorArray;
 	AssetRegistryModule.Get().GetAssets(Filter, OutRedirectorArray);
@@ -215,6 +551,147 @@ void FSuperManagerModule::FixUpRedirectors()
 	AssetToolsModule.Get().FixupReferencers(RedirectorToFixArray);
 }
 
+void FSuperManagerModule::EnqueueFixUpRedirectors(const FSuperManagerCancellationTokenRef& Token, TFunction<void()>&& OnFinished)
+{
+	struct FFixUpState
+	{
+		TArray<FAssetData> RedirectorData;
+		TArray<TStrongObjectPtr<UObjectRedirector>> LoadedRedirectors;
+		int32 NextIndex = 0;
+	};
+	const TSharedRef<FFixUpState> State = MakeShared<FFixUpState>();
+
+	TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.FindRedirectors"), [State]()
+	{
+		// 和 FixUpRedirectors 一样不套用排除规则
+		FARFilter Filter;
+		Filter.bRecursivePaths = true;
+		Filter.PackagePaths.Emplace("/Game");
+		Filter.ClassPaths.Add(UObjectRedirector::StaticClass()->GetClassPathName());
+		IAssetRegistry::GetChecked().GetAssets(Filter, State->RedirectorData);
+		return true;
+	}, Token, ESuperManagerTaskPriority::High);
+
+	// 每次只加载一个重定向器，调度器在帧预算内会反复调用
+	TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.LoadRedirectors"), [State]()
+	{
+		if (State->NextIndex < State->RedirectorData.Num())
+		{
+			if (UObjectRedirector* RedirectorToFix = Cast<UObjectRedirector>(State->RedirectorData[State->NextIndex].GetAsset()))
+			{
+				State->LoadedRedirectors.Emplace(RedirectorToFix);
+			}
+			++State->NextIndex;
+		}
+		return State->NextIndex >= State->RedirectorData.Num();
+	}, Token, ESuperManagerTaskPriority::High);
+
+	TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.FixUpRedirectors"), [State, OnFinished = MoveTemp(OnFinished)]()
+	{
+		if (State->LoadedRedirectors.Num() > 0)
+		{
+			TArray<UObjectRedirector*> RedirectorToFixArray;
+			for (const TStrongObjectPtr<UObjectRedirector>& Redirector : State->LoadedRedirectors)
+			{
+				RedirectorToFixArray.Add(Redirector.Get());
+			}
+			const FAssetToolsModule& AssetToolsModule =
+				FModuleManager::LoadModuleChecked<FAssetToolsModule>(TEXT("AssetTools"));
+			AssetToolsModule.Get().FixupReferencers(RedirectorToFixArray);
+		}
+		OnFinished();
+		return true;
+	}, Token, ESuperManagerTaskPriority::High);
+}
+
+void FSuperManagerModule::GatherAssetsUnderFolders(const TArray<FString>& Folders, TArray<TSharedPtr<FAssetData>>& OutAssetData,
+                                                   TMap<FSoftObjectPath, FString>& OutAssetRoots) const
+{
+	// 工作线程上调用时发起方已经在游戏线程初始化过，这里只能断言
+	if (IsInGameThread())
+	{
+		EnsureSubsystem(ESuperManagerSubsystem::FolderTrie);
+	}
+	else
+	{
+		checkSlow(IsSubsystemInitialized(ESuperManagerSubsystem::FolderTrie));
+	}
+	OutAssetData.Reset();
+	OutAssetRoots.Reset();
+
+	// 重叠的子树在这里就合并掉，后面每个根目录的结果互不相交
+	TArray<FString> Roots;
+	FSuperManagerFolderTrie::NormalizeRoots(Folders, Roots);
+
+	const IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	// 注册表的查询接口是线程安全的，各个根目录的子树同时枚举
+	TArray<TArray<FAssetData>> AssetsPerRoot;
+	AssetsPerRoot.SetNum(Roots.Num());
+	ParallelFor(Roots.Num(), [this, &Roots, &AssetsPerRoot, &AssetRegistry](int32 RootIndex)
+	{
+		FARFilter Filter;
+		if (FolderTrie->BuildSubtreeFilter(Roots[RootIndex], Filter))
+		{
+			AssetRegistry.GetAssets(Filter, AssetsPerRoot[RootIndex]);
+		}
+	});
+
+	int32 NumAssets = 0;
+	for (const TArray<FAssetData>& RootAssets : AssetsPerRoot)
+	{
+		NumAssets += RootAssets.Num();
+	}
+	OutAssetData.Reserve(NumAssets);
+	OutAssetRoots.Reserve(NumAssets);
+
+	// 按对象路径去重：一个包里可以有多个资产，按包名去重会丢掉除第一个以外的资产
+	TSet<FSoftObjectPath> SeenObjectPaths;
+	SeenObjectPaths.Reserve(NumAssets);
+	for (int32 RootIndex = 0; RootIndex < Roots.Num(); ++RootIndex)
+	{
+		for (FAssetData& Data : AssetsPerRoot[RootIndex])
+		{
+			FSoftObjectPath ObjectPath = Data.GetSoftObjectPath();
+			bool bAlreadySeen = false;
+			SeenObjectPaths.Add(ObjectPath, &bAlreadySeen);
+			if (!bAlreadySeen)
+			{
+				OutAssetRoots.Add(MoveTemp(ObjectPath), Roots[RootIndex]);
+				OutAssetData.Add(MakeShared<FAssetData>(MoveTemp(Data)));
+			}
+		}
+	}
+}
+
+bool FSuperManagerModule::IsAssetUnused(const FAssetData& AssetData, TArray<FName>* OutReferencers) const
+{
+	return IsPackageUnused(AssetData.PackageName, OutReferencers);
+}
+
+bool FSuperManagerModule::IsPackageUnused(FName PackageName, TArray<FName>* OutReferencers) const
+{
+	// 会在工作线程上调用，直接取注册表单例而不是走模块管理器
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+
+	TArray<FName> Referencers;
+	AssetRegistry.GetReferencers(PackageName, Referencers);
+	// 注册表里没有引用者时，还要看文本文件里有没有写死它的路径
+	const bool bUnused = Referencers.Num() == 0 && !StringReferenceScanner->IsReferenced(PackageName);
+	if (OutReferencers)
+	{
+		*OutReferencers = MoveTemp(Referencers);
+	}
+	return bUnused;
+}
+
+void FSuperManagerModule::OnStringReferencesChanged(const TArray<FName>& ChangedPackages)
+{
+	AssetListCache->InvalidateCondition(ESuperManagerListCondition::Unused);
+	UnusedAssetTracker->MarkPackagesDirty(ChangedPackages);
+}
+
 #pragma endregion
 
 #pragma region CustomEditorTab
@@ -228,50 +705,288 @@ void FSuperManagerModule::RegisterAdvanceDeletionTab()
 
 TSharedRef<SDockTab> FSuperManagerModule::OnSpawnAdvanceDeletionTab(const FSpawnTabArgs& SpawnTabArgs)
 {
+	// 面板先打开，资产列表由面板异步请求
 	return SNew(SDockTab).TabRole(ETabRole::NomadTab)
 		[
 			SNew(SAdvanceDeletionTab)
-			.AssetDataToStore(GetAllAssetDataUnderSelectedFolder())
-			.CurrentSelectedFolder(FolderPathsSelected[0])
+			.SelectedFolders(FolderPathsSelected)
+		];
+}
+
+void FSuperManagerModule::RegisterLoadChainTab()
+{
+	FGlobalTabmanager::Get()->RegisterNomadTabSpawner(FName("LoadChain"),
+	                                                  FOnSpawnTab::CreateRaw(this, &FSuperManagerModule::OnSpawnLoadChainTab))
+	                        .SetDisplayName(FText::FromString(TEXT("Load Chain")));
+}
+
+TSharedRef<SDockTab> FSuperManagerModule::OnSpawnLoadChainTab(const FSpawnTabArgs& SpawnTabArgs)
+{
+	TSharedRef<SLoadChainTab> NewTab =
+		SNew(SLoadChainTab)
+		.RootPackage(AssetPackageSelected);
+	LoadChainTab = NewTab;
+
+	return SNew(SDockTab).TabRole(ETabRole::NomadTab)
+		[
+			NewTab
 		];
 }
 
-TArray<TSharedPtr<FAssetData>> FSuperManagerModule::GetAllAssetDataUnderSelectedFolder()
+#pragma endregion
+
+#pragma region ProcessDataForAssetList
+
+void FSuperManagerModule::RequestLoadChainForPackage(FName RootPackage, FOnLoadChainReady&& OnReady, const FSuperManagerCancellationTokenRef& Token)
+{
+	TaskScheduler->LaunchWorker(TEXT("SuperManager.AnalyzeLoadChain"),
+		[this, RootPackage, OnReady = MoveTemp(OnReady), Token](const FSuperManagerCancellationToken&) mutable
+		{
+			const TSharedRef<const FSuperManagerLoadChainResult> Result = FSuperManagerLoadChainAnalyzer::Analyze(RootPackage);
+			TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.LoadChainReady"),
+				[OnReady = MoveTemp(OnReady), Result]()
+				{
+					OnReady(Result);
+					return true;
+				}, Token, ESuperManagerTaskPriority::High);
+		}, Token, ESuperManagerTaskPriority::High);
+}
+
+TSharedRef<const FSuperManagerAssetList> FSuperManagerModule::GetAssetListForFolders(const TArray<FString>& Folders, ESuperManagerListCondition Condition)
 {
-	if (FolderPathsSelected.IsEmpty())
+	EnsureSubsystemsForCondition(Condition);
+	if (Condition == ESuperManagerListCondition::Unused)
 	{
-		return TArray<TSharedPtr<FAssetData>>();
+		StringReferenceScanner->ScanBlocking();
 	}
-	TArray<TSharedPtr<FAssetData>> AssetDataArray;
-	TArray<FString> AssetsPathNames = UEditorAssetLibrary::ListAssets(FolderPathsSelected[0], true, true);
 
-	TArray<FAssetData> UnusedAssetDataArray;
-	for (const FString& AssetPathName : AssetsPathNames)
+	TArray<FString> Roots;
+	FSuperManagerFolderTrie::NormalizeRoots(Folders, Roots);
+
+	if (TSharedPtr<const FSuperManagerAssetList> CachedList = AssetListCache->Find(Roots, Condition))
 	{
-		// 过滤掉不需要检索的文件
-		if (AssetPathName.Contains(TEXT("Developers")) ||
-			AssetPathName.Contains(TEXT("Collections"))
-		)
-		{
-			continue;
-		}
+		return CachedList.ToSharedRef();
+	}
+
+	TSharedPtr<const FSuperManagerAssetList> AllList;
+	if (Condition == ESuperManagerListCondition::All)
+	{
+		// 修复过程中产生的注册表事件会在结果入缓存之前处理完
+		FixUpRedirectors();
+	}
+	else
+	{
+		AllList = GetAssetListForFolders(Roots, ESuperManagerListCondition::All);
+	}
+
+	const TSharedRef<FSuperManagerAssetList> NewList = BuildAssetList(Roots, Condition, AllList, ComputeFingerprintsBlocking(Condition, AllList));
+	AssetListCache->Add(Roots, Condition, NewList);
+	return NewList;
+}
 
-		if (!UEditorAssetLibrary::DoesAssetExist(AssetPathName))continue;
+TSharedRef<const FSuperManagerAssetList> FSuperManagerModule::BuildAssetListForFoldersBlocking(const TArray<FString>& Folders, ESuperManagerListCondition Condition)
+{
+	EnsureSubsystemsForCondition(Condition);
+	if (Condition == ESuperManagerListCondition::Unused)
+	{
+		StringReferenceScanner->ScanBlocking();
+	}
 
-		const FAssetData Data = UEditorAssetLibrary::FindAssetData(AssetPathName);
-		AssetDataArray.Add(MakeShared<FAssetData>(Data));
+	TArray<FString> Roots;
+	FSuperManagerFolderTrie::NormalizeRoots(Folders, Roots);
+
+	// 不修复重定向器，结果也不写入缓存：缓存里的列表都是修复之后算的
+	const TSharedRef<const FSuperManagerAssetList> AllList = BuildAssetList(Roots, ESuperManagerListCondition::All, nullptr);
+	if (Condition == ESuperManagerListCondition::All)
+	{
+		return AllList;
 	}
-	return AssetDataArray;
+	return BuildAssetList(Roots, Condition, AllList, ComputeFingerprintsBlocking(Condition, AllList));
 }
 
-#pragma endregion
+FSuperManagerModule::FListFingerprints FSuperManagerModule::ComputeFingerprintsBlocking(ESuperManagerListCondition Condition,
+                                                                                       const TSharedPtr<const FSuperManagerAssetList>& AllList)
+{
+	FListFingerprints Fingerprints;
+	if (Condition == ESuperManagerListCondition::SimilarTextures)
+	{
+		const TSharedRef<FSuperManagerTextureSimilarity::FResults> TextureHashes = MakeShared<FSuperManagerTextureSimilarity::FResults>();
+		TextureSimilarity->ComputeBlocking(AllList->Assets, *TextureHashes);
+		Fingerprints.TextureHashes = TextureHashes;
+	}
+	else if (Condition == ESuperManagerListCondition::DuplicateMeshes)
+	{
+		const TSharedRef<FSuperManagerMeshDuplicates::FResults> MeshFingerprints = MakeShared<FSuperManagerMeshDuplicates::FResults>();
+		MeshDuplicates->ComputeBlocking(AllList->Assets, *MeshFingerprints);
+		Fingerprints.MeshFingerprints = MeshFingerprints;
+	}
+	else if (Condition == ESuperManagerListCondition::DuplicateMaterialInstances)
+	{
+		const TSharedRef<FSuperManagerMaterialInstanceDuplicates::FResults> MaterialInstanceFingerprints =
+			MakeShared<FSuperManagerMaterialInstanceDuplicates::FResults>();
+		MaterialInstanceDuplicates->ComputeBlocking(AllList->Assets, *MaterialInstanceFingerprints);
+		Fingerprints.MaterialInstanceFingerprints = MaterialInstanceFingerprints;
+	}
 
-#pragma region ProcessDataForAssetList
+	return Fingerprints;
+}
+
+void FSuperManagerModule::RequestAssetListForFolders(const TArray<FString>& Folders, ESuperManagerListCondition Condition,
+                                                     FOnAssetListReady&& OnReady, const FSuperManagerCancellationTokenRef& Token)
+{
+	EnsureSubsystemsForCondition(Condition);
+
+	// 先重扫修改过的文本文件，文本引用有变化时未使用条件的缓存会被清掉
+	if (Condition == ESuperManagerListCondition::Unused)
+	{
+		StringReferenceScanner->RequestScan(Token, [this, Folders, Condition, OnReady = MoveTemp(OnReady), Token]()
+		{
+			FOnAssetListReady OnReadyCopy = OnReady;
+			RequestAssetListForRoots(Folders, Condition, MoveTemp(OnReadyCopy), Token);
+		});
+		return;
+	}
+	RequestAssetListForRoots(Folders, Condition, MoveTemp(OnReady), Token);
+}
+
+void FSuperManagerModule::RequestAssetListForRoots(const TArray<FString>& Folders, ESuperManagerListCondition Condition,
+                                                   FOnAssetListReady&& OnReady, const FSuperManagerCancellationTokenRef& Token)
+{
+	TArray<FString> Roots;
+	FSuperManagerFolderTrie::NormalizeRoots(Folders, Roots);
+
+	if (TSharedPtr<const FSuperManagerAssetList> CachedList = AssetListCache->Find(Roots, Condition))
+	{
+		OnReady(CachedList.ToSharedRef());
+		return;
+	}
+
+	auto BuildOnWorker = [this, Roots, Condition, OnReady = MoveTemp(OnReady), Token](const TSharedPtr<const FSuperManagerAssetList>& AllList,
+	                                                                                 const FListFingerprints& Fingerprints)
+	{
+		const uint64 CacheGeneration = AssetListCache->GetGeneration();
+		TaskScheduler->LaunchWorker(TEXT("SuperManager.BuildAssetList"),
+			[this, Roots, Condition, OnReady, Token, AllList, Fingerprints, CacheGeneration](const FSuperManagerCancellationToken&)
+			{
+				const TSharedRef<const FSuperManagerAssetList> NewList = BuildAssetList(Roots, Condition, AllList, Fingerprints);
+				TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.AssetListReady"),
+					[this, Roots, Condition, OnReady, NewList, CacheGeneration]()
+					{
+						// 计算期间有过注册表变化时结果可能已经过期，只交给调用方，不写回缓存
+						if (AssetListCache->GetGeneration() == CacheGeneration)
+						{
+							AssetListCache->Add(Roots, Condition, NewList);
+						}
+						OnReady(NewList);
+						return true;
+					}, Token, ESuperManagerTaskPriority::High);
+			}, Token, ESuperManagerTaskPriority::High);
+	};
+
+	if (Condition == ESuperManagerListCondition::All)
+	{
+		EnqueueFixUpRedirectors(Token, [BuildOnWorker]()
+		{
+			BuildOnWorker(nullptr, FListFingerprints());
+		});
+	}
+	else if (Condition == ESuperManagerListCondition::SimilarTextures)
+	{
+		// 先拿到全部资产，再为其中的贴图计算(或从缓存取)感知哈希
+		RequestAssetListForFolders(Roots, ESuperManagerListCondition::All, [this, BuildOnWorker, Token](const TSharedRef<const FSuperManagerAssetList>& AllList)
+		{
+			TextureSimilarity->Request(AllList->Assets, Token,
+				[BuildOnWorker, AllList](const TSharedRef<const FSuperManagerTextureSimilarity::FResults>& TextureHashes)
+				{
+					FListFingerprints Fingerprints;
+					Fingerprints.TextureHashes = TextureHashes;
+					BuildOnWorker(AllList, Fingerprints);
+				});
+		}, Token);
+	}
+	else if (Condition == ESuperManagerListCondition::DuplicateMeshes)
+	{
+		RequestAssetListForFolders(Roots, ESuperManagerListCondition::All, [this, BuildOnWorker, Token](const TSharedRef<const FSuperManagerAssetList>& AllList)
+		{
+			MeshDuplicates->Request(AllList->Assets, Token,
+				[BuildOnWorker, AllList](const TSharedRef<const FSuperManagerMeshDuplicates::FResults>& MeshFingerprints)
+				{
+					FListFingerprints Fingerprints;
+					Fingerprints.MeshFingerprints = MeshFingerprints;
+					BuildOnWorker(AllList, Fingerprints);
+				});
+		}, Token);
+	}
+	else if (Condition == ESuperManagerListCondition::DuplicateMaterialInstances)
+	{
+		RequestAssetListForFolders(Roots, ESuperManagerListCondition::All, [this, BuildOnWorker, Token](const TSharedRef<const FSuperManagerAssetList>& AllList)
+		{
+			MaterialInstanceDuplicates->Request(AllList->Assets, Token,
+				[BuildOnWorker, AllList](const TSharedRef<const FSuperManagerMaterialInstanceDuplicates::FResults>& MaterialInstanceFingerprints)
+				{
+					FListFingerprints Fingerprints;
+					Fingerprints.MaterialInstanceFingerprints = MaterialInstanceFingerprints;
+					BuildOnWorker(AllList, Fingerprints);
+				});
+		}, Token);
+	}
+	else
+	{
+		RequestAssetListForFolders(Roots, ESuperManagerListCondition::All, [BuildOnWorker](const TSharedRef<const FSuperManagerAssetList>& AllList)
+		{
+			BuildOnWorker(AllList, FListFingerprints());
+		}, Token);
+	}
+}
+
+TSharedRef<FSuperManagerAssetList> FSuperManagerModule::BuildAssetList(const TArray<FString>& Roots, ESuperManagerListCondition Condition,
+                                                                       const TSharedPtr<const FSuperManagerAssetList>& AllList,
+                                                                       const FListFingerprints& Fingerprints)
+{
+	TSharedRef<FSuperManagerAssetList> NewList = MakeShared<FSuperManagerAssetList>();
+	switch (Condition)
+	{
+	case ESuperManagerListCondition::All:
+		GatherAssetsUnderFolders(Roots, NewList->Assets, NewList->AssetRoots);
+		break;
+	case ESuperManagerListCondition::Unused:
+		ListUnusedAssetsForAssetList(AllList->Assets, NewList->Assets, &NewList->ReferencerPackages);
+		NewList->AssetRoots = AllList->AssetRoots;
+		break;
+	case ESuperManagerListCondition::SameName:
+		ListSameNameAsssetsForAssetList(AllList->Assets, NewList->Assets);
+		NewList->AssetRoots = AllList->AssetRoots;
+		break;
+	case ESuperManagerListCondition::SimilarTextures:
+		ListSimilarTexturesForAssetList(AllList->Assets, *Fingerprints.TextureHashes, NewList->Assets, NewList->AssetGroups);
+		NewList->AssetRoots = AllList->AssetRoots;
+		break;
+	case ESuperManagerListCondition::DuplicateMeshes:
+		ListDuplicateMeshesForAssetList(AllList->Assets, *Fingerprints.MeshFingerprints, NewList->Assets, NewList->AssetGroups,
+		                                NewList->AssetDetails);
+		NewList->AssetRoots = AllList->AssetRoots;
+		break;
+	case ESuperManagerListCondition::DuplicateMaterialInstances:
+		ListDuplicateMaterialInstancesForAssetList(AllList->Assets, *Fingerprints.MaterialInstanceFingerprints, NewList->Assets,
+		                                           NewList->AssetGroups, NewList->AssetDetails);
+		NewList->AssetRoots = AllList->AssetRoots;
+		break;
+	case ESuperManagerListCondition::TextureBudget:
+		ListTextureBudgetIssuesForAssetList(AllList->Assets, NewList->Assets, NewList->AssetDetails, NewList->Summary);
+		NewList->AssetRoots = AllList->AssetRoots;
+		break;
+	}
+	return NewList;
+}
 
-bool FSuperManagerModule::DeleteSingleAssetForAssetList(const FAssetData& AssetDataToDelete)
+bool FSuperManagerModule::DeleteSingleAssetForAssetList(const FAssetData& AssetDataToDelete, FOnQuarantineFinished OnQuarantined)
 {
 	TArray<FAssetData> AssetDataForDeletion;
 	AssetDataForDeletion.Add(AssetDataToDelete);
+	if (USuperManagerSettings::Get()->bDeleteToQuarantine)
+	{
+		return DeleteMultipleAssetForAssetList(AssetDataForDeletion, MoveTemp(OnQuarantined));
+	}
 	if (ObjectTools::DeleteAssets(AssetDataForDeletion) > 0)
 	{
 		return true;
@@ -279,8 +994,22 @@ bool FSuperManagerModule::DeleteSingleAssetForAssetList(const FAssetData& AssetD
 	return false;
 }
 
-bool FSuperManagerModule::DeleteMultipleAssetForAssetList(const TArray<FAssetData>& AssetsToDelete)
+bool FSuperManagerModule::DeleteMultipleAssetForAssetList(const TArray<FAssetData>& AssetsToDelete, FOnQuarantineFinished OnQuarantined)
 {
+	if (USuperManagerSettings::Get()->bDeleteToQuarantine)
+	{
+		if (AssetsToDelete.Num() > 0)
+		{
+			GetQuarantine()->QuarantineAssets(AssetsToDelete, FOnQuarantineFinished::CreateLambda(
+				[OnQuarantined = MoveTemp(OnQuarantined)](const FSuperManagerQuarantineReport& Report)
+				{
+					DebugHeader::ShowNotifyInfo(Report.ToString());
+					OnQuarantined.ExecuteIfBound(Report);
+				}));
+		}
+		return false;
+	}
+
 	if (ObjectTools::DeleteAssets(AssetsToDelete) > 0)
 	{
 		return true;
@@ -288,16 +1017,51 @@ bool FSuperManagerModule::DeleteMultipleAssetForAssetList(const TArray<FAssetDat
 	return false;
 }
 
-void FSuperManagerModule::ListUnusedAssetsForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetDataToFilter, TArray<TSharedPtr<FAssetData>>& OutUnusedAssetData)
+void FSuperManagerModule::ConsolidateDuplicatesForAssetList(const TArray<FSuperManagerConsolidationGroup>& Groups, FOnConsolidationFinished OnFinished)
+{
+	if (Groups.Num() == 0)
+	{
+		return;
+	}
+	EnsureSubsystem(ESuperManagerSubsystem::StringReferences);
+	SuperManagerBatchConsolidation::Run(*TaskScheduler, Groups, StringReferenceScanner.ToSharedRef(), FSuperManagerTaskScheduler::MakeToken(),
+	                                    MoveTemp(OnFinished));
+}
+
+void FSuperManagerModule::ListUnusedAssetsForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetDataToFilter, TArray<TSharedPtr<FAssetData>>& OutUnusedAssetData,
+                                                       TSet<FName>* OutReferencerPackages)
 {
+	// BuildAssetList 在工作线程上调用，发起方已经在游戏线程初始化过
+	if (IsInGameThread())
+	{
+		EnsureSubsystem(ESuperManagerSubsystem::StringReferences);
+	}
+	else
+	{
+		checkSlow(IsSubsystemInitialized(ESuperManagerSubsystem::StringReferences));
+	}
 	OutUnusedAssetData.Empty();
-	for (const TSharedPtr<FAssetData>& DataSharedPtr : AssetDataToFilter)
+
+	// 按资产并行查询引用，耗时随核心数而不是目录数缩放
+	TArray<bool> UnusedFlags;
+	UnusedFlags.SetNumZeroed(AssetDataToFilter.Num());
+	TArray<TArray<FName>> ReferencersPerAsset;
+	ReferencersPerAsset.SetNum(OutReferencerPackages ? AssetDataToFilter.Num() : 0);
+	ParallelFor(AssetDataToFilter.Num(), [this, &AssetDataToFilter, &UnusedFlags, &ReferencersPerAsset](int32 Index)
 	{
-		TArray<FString> AssetReferences =
-			UEditorAssetLibrary::FindPackageReferencersForAsset(DataSharedPtr->GetObjectPathString());
-		if (AssetReferences.Num() == 0)
+		UnusedFlags[Index] = IsAssetUnused(*AssetDataToFilter[Index],
+		                                   ReferencersPerAsset.IsEmpty() ? nullptr : &ReferencersPerAsset[Index]);
+	});
+
+	for (int32 Index = 0; Index < AssetDataToFilter.Num(); ++Index)
+	{
+		if (UnusedFlags[Index])
+		{
+			OutUnusedAssetData.Add(AssetDataToFilter[Index]);
+		}
+		else if (OutReferencerPackages)
 		{
-			OutUnusedAssetData.Add(DataSharedPtr);
+			OutReferencerPackages->Append(ReferencersPerAsset[Index]);
 		}
 	}
 }
@@ -326,6 +1090,161 @@ void FSuperManagerModule::ListSameNameAsssetsForAssetList(const TArray<TSharedPt
 	}
 }
 
+void FSuperManagerModule::ListSimilarTexturesForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,
+                                                          const FSuperManagerTextureSimilarity::FResults& TextureHashes,
+                                                          TArray<TSharedPtr<FAssetData>>& OutSimilarAssetData,
+                                                          TMap<FSoftObjectPath, int32>& OutAssetGroups)
+{
+	OutSimilarAssetData.Empty();
+	OutAssetGroups.Empty();
+
+	const TMap<FName, TSharedPtr<FAssetData>> AssetsByPackage =
+		SuperManagerAssetLists::MapCandidatesByPackage(AssetsToFilter, UTexture2D::StaticClass()->GetClassPathName());
+
+	TArray<TArray<int32>> Groups;
+	FSuperManagerTextureSimilarity::GroupNearDuplicates(TextureHashes, USuperManagerSettings::Get()->SimilarTextureMaxDistance, Groups);
+	for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); ++GroupIndex)
+	{
+		for (const int32 HashIndex : Groups[GroupIndex])
+		{
+			const FName PackageName = TextureHashes[HashIndex].Key;
+			if (const TSharedPtr<FAssetData>* DataSharedPtr = AssetsByPackage.Find(PackageName))
+			{
+				OutSimilarAssetData.Add(*DataSharedPtr);
+				OutAssetGroups.Add((*DataSharedPtr)->GetSoftObjectPath(), GroupIndex);
+			}
+		}
+	}
+}
+
+void FSuperManagerModule::ListDuplicateMeshesForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,
+                                                          const FSuperManagerMeshDuplicates::FResults& MeshFingerprints,
+                                                          TArray<TSharedPtr<FAssetData>>& OutDuplicateAssetData,
+                                                          TMap<FSoftObjectPath, int32>& OutAssetGroups,
+                                                          TMap<FSoftObjectPath, FString>& OutAssetDetails)
+{
+	OutDuplicateAssetData.Empty();
+	OutAssetGroups.Empty();
+	OutAssetDetails.Empty();
+
+	const TMap<FName, TSharedPtr<FAssetData>> AssetsByPackage =
+		SuperManagerAssetLists::MapCandidatesByPackage(AssetsToFilter, UStaticMesh::StaticClass()->GetClassPathName());
+
+	TArray<TArray<int32>> Groups;
+	FSuperManagerMeshDuplicates::GroupDuplicates(MeshFingerprints, Groups);
+	// 几何相同但材质槽、碰撞或LOD设置不同的网格各自成组，合并只在组内进行，这样的网格不会被互相替换
+	int32 NextGroupIndex = 0;
+	for (const TArray<int32>& Group : Groups)
+	{
+		const bool bMixedSetups = MeshFingerprints[Group[0]].Value.SetupHash != MeshFingerprints[Group.Last()].Value.SetupHash;
+		uint64 SetupHash = 0;
+		bool bFirstSetup = true;
+		for (const int32 FingerprintIndex : Group)
+		{
+			const TPair<FName, FSuperManagerMeshFingerprint>& Fingerprint = MeshFingerprints[FingerprintIndex];
+			const TSharedPtr<FAssetData>* DataSharedPtr = AssetsByPackage.Find(Fingerprint.Key);
+			if (!DataSharedPtr)
+			{
+				continue;
+			}
+
+			// 组内按设置哈希排好序，设置变化时开始新的一组，新组的第一个作为保留项，其余每个都是冗余副本
+			const bool bKeeper = bFirstSetup || Fingerprint.Value.SetupHash != SetupHash;
+			if (bKeeper)
+			{
+				SetupHash = Fingerprint.Value.SetupHash;
+				bFirstSetup = false;
+				++NextGroupIndex;
+			}
+			const FSoftObjectPath ObjectPath = (*DataSharedPtr)->GetSoftObjectPath();
+			OutDuplicateAssetData.Add(*DataSharedPtr);
+			OutAssetGroups.Add(ObjectPath, NextGroupIndex - 1);
+			if (!bKeeper)
+			{
+				OutAssetDetails.Add(ObjectPath, FString::Printf(TEXT("冗余: %d 顶点, %s"), Fingerprint.Value.NumVertices,
+				                                                       *FText::AsMemory(Fingerprint.Value.DiskSize).ToString()));
+			}
+			else if (bMixedSetups)
+			{
+				OutAssetDetails.Add(ObjectPath, TEXT("几何与相邻的组相同，但材质槽、碰撞或LOD设置不同，不与它们合并"));
+			}
+		}
+	}
+}
+
+void FSuperManagerModule::ListDuplicateMaterialInstancesForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,
+                                                                     const FSuperManagerMaterialInstanceDuplicates::FResults& MaterialInstanceFingerprints,
+                                                                     TArray<TSharedPtr<FAssetData>>& OutDuplicateAssetData,
+                                                                     TMap<FSoftObjectPath, int32>& OutAssetGroups,
+                                                                     TMap<FSoftObjectPath, FString>& OutAssetDetails)
+{
+	OutDuplicateAssetData.Empty();
+	OutAssetGroups.Empty();
+	OutAssetDetails.Empty();
+
+	const TMap<FName, TSharedPtr<FAssetData>> AssetsByPackage =
+		SuperManagerAssetLists::MapCandidatesByPackage(AssetsToFilter, UMaterialInstanceConstant::StaticClass()->GetClassPathName());
+
+	TArray<TArray<int32>> Groups;
+	FSuperManagerMaterialInstanceDuplicates::GroupDuplicates(MaterialInstanceFingerprints, Groups);
+	for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); ++GroupIndex)
+	{
+		const TArray<int32>& Group = Groups[GroupIndex];
+		const TPair<FName, FSuperManagerMaterialInstanceFingerprint>& Keeper = MaterialInstanceFingerprints[Group[0]];
+
+		// 同组实例的静态参数和基础属性覆盖相同，有这类覆盖时每个冗余实例都各自编译一套着色器排列
+		const int32 NumRedundant = Group.Num() - 1;
+		const int32 NumPermutationSetsSaved = Keeper.Value.bHasOwnPermutations ? NumRedundant : 0;
+
+		for (int32 MemberIndex = 0; MemberIndex < Group.Num(); ++MemberIndex)
+		{
+			const FName PackageName = MaterialInstanceFingerprints[Group[MemberIndex]].Key;
+			const TSharedPtr<FAssetData>* DataSharedPtr = AssetsByPackage.Find(PackageName);
+			if (!DataSharedPtr)
+			{
+				continue;
+			}
+			const FSoftObjectPath ObjectPath = (*DataSharedPtr)->GetSoftObjectPath();
+			OutDuplicateAssetData.Add(*DataSharedPtr);
+			OutAssetGroups.Add(ObjectPath, GroupIndex);
+			if (MemberIndex == 0)
+			{
+				OutAssetDetails.Add(ObjectPath, FString::Printf(TEXT("合并 %d 个冗余实例可减少 %d 套着色器排列"), NumRedundant, NumPermutationSetsSaved));
+			}
+			else
+			{
+				OutAssetDetails.Add(ObjectPath, Keeper.Value.bHasOwnPermutations ? TEXT("冗余: 独立着色器排列") : TEXT("冗余: 共用父材质着色器"));
+			}
+		}
+	}
+}
+
+void FSuperManagerModule::ListTextureBudgetIssuesForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,
+                                                              TArray<TSharedPtr<FAssetData>>& OutFlaggedAssetData,
+                                                              TMap<FSoftObjectPath, FString>& OutAssetDetails,
+                                                              FString& OutSummary)
+{
+	OutFlaggedAssetData.Empty();
+	OutAssetDetails.Empty();
+
+	const TMap<FName, TSharedPtr<FAssetData>> AssetsByPackage =
+		SuperManagerAssetLists::MapCandidatesByPackage(AssetsToFilter, UTexture2D::StaticClass()->GetClassPathName());
+
+	FSuperManagerTextureBudgetAudit::FResults Results;
+	FSuperManagerTextureBudgetAudit().Run(AssetsToFilter, Results);
+
+	int64 TotalSavableBytes = 0;
+	for (const TPair<FName, FSuperManagerTextureAuditEntry>& Result : Results)
+	{
+		const TSharedPtr<FAssetData>& DataSharedPtr = AssetsByPackage.FindChecked(Result.Key);
+		OutFlaggedAssetData.Add(DataSharedPtr);
+		OutAssetDetails.Add(DataSharedPtr->GetSoftObjectPath(), FSuperManagerTextureBudgetAudit::Describe(Result.Value));
+		TotalSavableBytes += Result.Value.SavableBytes;
+	}
+	OutSummary = FString::Printf(TEXT("%d 张贴图存在问题，全部缩到预算内并改用压缩格式后预计可节省 %s 显存"),
+	                             Results.Num(), *FText::AsMemory(TotalSavableBytes).ToString());
+}
+
 void FSuperManagerModule::SyncCBToClickedAssetForAssetList(const FString& AssetPathToSync)
 {
 	TArray<FString> AssetsPathToSync;
@@ -337,7 +1256,79 @@ void FSuperManagerModule::SyncCBToClickedAssetForAssetList(const FString& AssetP
 
 void FSuperManagerModule::ShutdownModule()
 {
+	DeferredInitializationToken->Cancel();
+	if (FModuleManager::Get().IsModuleLoaded(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.OnFilesLoaded().Remove(FilesLoadedHandle);
+	}
+	FModuleManager::Get().OnModulesChanged().Remove(ModulesChangedHandle);
+
 	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(FName("AdvanceDeletion"));
+	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(FName("LoadChain"));
+
+	// 先停掉调度器，等待还在工作线程上的任务结束，之后才能释放它们用到的对象
+	if (TaskScheduler.IsValid())
+	{
+		TaskScheduler->Shutdown();
+	}
+
+	if (Quarantine.IsValid())
+	{
+		Quarantine->Shutdown();
+		Quarantine.Reset();
+	}
+
+	if (ThumbnailCache.IsValid())
+	{
+		ThumbnailCache->Shutdown();
+		ThumbnailCache.Reset();
+	}
+
+	if (MaterialInstanceDuplicates.IsValid())
+	{
+		MaterialInstanceDuplicates->Shutdown();
+		MaterialInstanceDuplicates.Reset();
+	}
+
+	if (MeshDuplicates.IsValid())
+	{
+		MeshDuplicates->Shutdown();
+		MeshDuplicates.Reset();
+	}
+
+	if (TextureSimilarity.IsValid())
+	{
+		TextureSimilarity->Shutdown();
+		TextureSimilarity.Reset();
+	}
+
+	if (UnusedAssetTracker.IsValid())
+	{
+		UnusedAssetTracker->Shutdown();
+		UnusedAssetTracker.Reset();
+	}
+
+	if (StringReferenceScanner.IsValid())
+	{
+		StringReferenceScanner->OnReferencesChanged().RemoveAll(this);
+		StringReferenceScanner->Shutdown();
+		StringReferenceScanner.Reset();
+	}
+
+	if (AssetListCache.IsValid())
+	{
+		AssetListCache->Shutdown();
+		AssetListCache.Reset();
+	}
+
+	if (FolderTrie.IsValid())
+	{
+		FolderTrie->Shutdown();
+		FolderTrie.Reset();
+	}
+
+	TaskScheduler.Reset();
 }
 
 
@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+#include "SuperManager.h"
+#include "SuperManagerStats.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Settings/SuperManagerSettings.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending Worker Tasks"), STAT_SuperManager_PendingWorkerTasks, STATGROUP_SuperManager);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending Game Thread Stages"), STAT_SuperManager_PendingStages, STATGROUP_SuperManager);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Average Worker Latency (ms)"), STAT_SuperManager_WorkerLatency, STATGROUP_SuperManager);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Average Stage Latency (ms)"), STAT_SuperManager_StageLatency, STATGROUP_SuperManager);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Stage Time This Frame (ms)"), STAT_SuperManager_StageFrameTime, STATGROUP_SuperManager);
+
+namespace SuperManagerTaskScheduler
+{
+	// 平均延迟用指数滑动平均，越新的样本权重越大
+	constexpr double LatencySmoothing = 0.1;
+
+	UE::Tasks::ETaskPriority ToTaskPriority(ESuperManagerTaskPriority Priority)
+	{
+		switch (Priority)
+		{
+		case ESuperManagerTaskPriority::High:
+			return UE::Tasks::ETaskPriority::High;
+		case ESuperManagerTaskPriority::Background:
+			return UE::Tasks::ETaskPriority::BackgroundNormal;
+		default:
+			return UE::Tasks::ETaskPriority::Normal;
+		}
+	}
+
+	FAutoConsoleCommand DumpStatsCommand(
+		TEXT("SuperManager.SchedulerStats"),
+		TEXT("打印SuperManager任务调度器的队列深度与延迟"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (!FModuleManager::Get().IsModuleLoaded(TEXT("SuperManager")))
+			{
+				return;
+			}
+			const FSuperManagerModule& SuperManagerModule = FModuleManager::GetModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+			const FSuperManagerSchedulerStats Stats = SuperManagerModule.GetTaskScheduler()->GetStats();
+			UE_LOG(LogTemp, Display,
+			       TEXT("SuperManager scheduler: workers pending %d (done %lld, avg latency %.2f ms), stages pending %d (done %lld, avg latency %.2f ms, max %.2f ms), last frame %.2f ms"),
+			       Stats.PendingWorkerTasks, Stats.CompletedWorkerTasks, Stats.AverageWorkerLatencyMs,
+			       Stats.PendingGameThreadStages, Stats.CompletedGameThreadStages, Stats.AverageStageLatencyMs,
+			       Stats.MaxStageLatencyMs, Stats.LastFrameStageTimeMs);
+		}));
+}
+
+void FSuperManagerTaskScheduler::Initialize()
+{
+	bShuttingDown = false;
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateSP(this, &FSuperManagerTaskScheduler::Tick));
+}
+
+void FSuperManagerTaskScheduler::Shutdown()
+{
+	bShuttingDown = true;
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	{
+		FScopeLock ScopeLock(&StageQueuesCS);
+		for (FStageQueue& Queue : StageQueues)
+		{
+			for (int32 Index = Queue.Head; Index < Queue.Stages.Num(); ++Index)
+			{
+				Queue.Stages[Index].Token->Cancel();
+			}
+			Queue.Stages.Empty();
+			Queue.Head = 0;
+		}
+	}
+
+	// 工作线程里的任务可能引用模块数据，必须等它们结束
+	TArray<UE::Tasks::FTask> WorkersToWait;
+	{
+		FScopeLock ScopeLock(&InFlightWorkersCS);
+		WorkersToWait = MoveTemp(InFlightWorkers);
+	}
+	UE::Tasks::Wait(WorkersToWait);
+}
+
+UE::Tasks::FTask FSuperManagerTaskScheduler::LaunchWorker(const TCHAR* DebugName, FWorkerFunction&& Work,
+                                                         const FSuperManagerCancellationTokenRef& Token,
+                                                         ESuperManagerTaskPriority Priority)
+{
+	++PendingWorkerTasks;
+	const double EnqueueTime = FPlatformTime::Seconds();
+
+	UE::Tasks::FTask Task = UE::Tasks::Launch(DebugName,
+		[this, Work = MoveTemp(Work), Token, EnqueueTime]() mutable
+		{
+			RecordWorkerLatency(FPlatformTime::Seconds() - EnqueueTime);
+			if (!Token->IsCancelled())
+			{
+				Work(*Token);
+			}
+			--PendingWorkerTasks;
+
+			FScopeLock ScopeLock(&StatsCS);
+			++Stats.CompletedWorkerTasks;
+		},
+		SuperManagerTaskScheduler::ToTaskPriority(Priority));
+
+	FScopeLock ScopeLock(&InFlightWorkersCS);
+	InFlightWorkers.Add(Task);
+	return Task;
+}
+
+void FSuperManagerTaskScheduler::EnqueueGameThreadStage(const TCHAR* DebugName, FStageFunction&& Stage,
+                                                        const FSuperManagerCancellationTokenRef& Token,
+                                                        ESuperManagerTaskPriority Priority)
+{
+	if (bShuttingDown)
+	{
+		return;
+	}
+
+	FGameThreadStage NewStage;
+	NewStage.DebugName = DebugName;
+	NewStage.Stage = MoveTemp(Stage);
+	NewStage.Token = Token;
+	NewStage.EnqueueTime = FPlatformTime::Seconds();
+
+	FScopeLock ScopeLock(&StageQueuesCS);
+	if (bShuttingDown)
+	{
+		return;
+	}
+	StageQueues[static_cast<int32>(Priority)].Stages.Add(MoveTemp(NewStage));
+}
+
+FSuperManagerSchedulerStats FSuperManagerTaskScheduler::GetStats() const
+{
+	FSuperManagerSchedulerStats Result;
+	{
+		FScopeLock ScopeLock(&StatsCS);
+		Result = Stats;
+	}
+	Result.PendingWorkerTasks = PendingWorkerTasks.load();
+
+	FScopeLock ScopeLock(&StageQueuesCS);
+	Result.PendingGameThreadStages = 0;
+	for (const FStageQueue& Queue : StageQueues)
+	{
+		Result.PendingGameThreadStages += Queue.Num();
+	}
+	return Result;
+}
+
+bool FSuperManagerTaskScheduler::Tick(float DeltaTime)
+{
+	const double BudgetSeconds = USuperManagerSettings::Get()->GameThreadBudgetMs / 1000.0;
+	const double FrameStartTime = FPlatformTime::Seconds();
+
+	// 至少执行一个阶段，保证预算设得很小时队列也能前进
+	bool bRanAnyStage = false;
+	while (!bRanAnyStage || FPlatformTime::Seconds() - FrameStartTime < BudgetSeconds)
+	{
+		FGameThreadStage Stage;
+		int32 QueueIndex = INDEX_NONE;
+		{
+			FScopeLock ScopeLock(&StageQueuesCS);
+			for (int32 Index = 0; Index < UE_ARRAY_COUNT(StageQueues); ++Index)
+			{
+				FStageQueue& Queue = StageQueues[Index];
+				if (!Queue.IsEmpty())
+				{
+					Stage = MoveTemp(Queue.Stages[Queue.Head++]);
+					QueueIndex = Index;
+					break;
+				}
+			}
+		}
+		if (QueueIndex == INDEX_NONE)
+		{
+			break;
+		}
+		bRanAnyStage = true;
+
+		if (Stage.Token->IsCancelled())
+		{
+			continue;
+		}
+		if (!Stage.bStarted)
+		{
+			Stage.bStarted = true;
+			RecordStageLatency(FPlatformTime::Seconds() - Stage.EnqueueTime);
+		}
+
+		bool bFinished = false;
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(Stage.DebugName);
+			bFinished = Stage.Stage();
+		}
+
+		if (bFinished || Stage.Token->IsCancelled())
+		{
+			FScopeLock ScopeLock(&StatsCS);
+			++Stats.CompletedGameThreadStages;
+			continue;
+		}
+
+		// 没做完的阶段放回队首，保证同一操作的后续阶段不会越过它
+		FScopeLock ScopeLock(&StageQueuesCS);
+		FStageQueue& Queue = StageQueues[QueueIndex];
+		if (Queue.Head > 0)
+		{
+			Queue.Stages[--Queue.Head] = MoveTemp(Stage);
+		}
+		else
+		{
+			Queue.Stages.Insert(MoveTemp(Stage), 0);
+		}
+	}
+
+	{
+		FScopeLock ScopeLock(&StageQueuesCS);
+		for (FStageQueue& Queue : StageQueues)
+		{
+			if (Queue.IsEmpty())
+			{
+				Queue.Stages.Reset();
+				Queue.Head = 0;
+			}
+			else if (Queue.Head > 1024 && Queue.Head > Queue.Stages.Num() / 2)
+			{
+				Queue.Stages.RemoveAt(0, Queue.Head);
+				Queue.Head = 0;
+			}
+		}
+	}
+	{
+		FScopeLock ScopeLock(&InFlightWorkersCS);
+		InFlightWorkers.RemoveAll([](const UE::Tasks::FTask& Task) { return Task.IsCompleted(); });
+	}
+
+	const FSuperManagerSchedulerStats CurrentStats = GetStats();
+	{
+		FScopeLock ScopeLock(&StatsCS);
+		Stats.LastFrameStageTimeMs = bRanAnyStage ? (FPlatformTime::Seconds() - FrameStartTime) * 1000.0 : 0.0;
+	}
+	SET_DWORD_STAT(STAT_SuperManager_PendingWorkerTasks, CurrentStats.PendingWorkerTasks);
+	SET_DWORD_STAT(STAT_SuperManager_PendingStages, CurrentStats.PendingGameThreadStages);
+	SET_FLOAT_STAT(STAT_SuperManager_WorkerLatency, CurrentStats.AverageWorkerLatencyMs);
+	SET_FLOAT_STAT(STAT_SuperManager_StageLatency, CurrentStats.AverageStageLatencyMs);
+	SET_FLOAT_STAT(STAT_SuperManager_StageFrameTime, CurrentStats.LastFrameStageTimeMs);
+	return true;
+}
+
+void FSuperManagerTaskScheduler::RecordWorkerLatency(double LatencySeconds)
+{
+	FScopeLock ScopeLock(&StatsCS);
+	const double LatencyMs = LatencySeconds * 1000.0;
+	Stats.AverageWorkerLatencyMs = FMath::Lerp(Stats.AverageWorkerLatencyMs, LatencyMs, SuperManagerTaskScheduler::LatencySmoothing);
+}
+
+void FSuperManagerTaskScheduler::RecordStageLatency(double LatencySeconds)
+{
+	FScopeLock ScopeLock(&StatsCS);
+	const double LatencyMs = LatencySeconds * 1000.0;
+	Stats.AverageStageLatencyMs = FMath::Lerp(Stats.AverageStageLatencyMs, LatencyMs, SuperManagerTaskScheduler::LatencySmoothing);
+	Stats.MaxStageLatencyMs = FMath::Max(Stats.MaxStageLatencyMs, LatencyMs);
+}
@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Thumbnails/ThumbnailCache.h"
+
+#include "SuperManager.h"
+#include "SuperManagerStats.h"
+#include "HAL/IConsoleManager.h"
+#include "ImageCore.h"
+#include "ObjectTools.h"
+#include "Brushes/SlateDynamicImageBrush.h"
+#include "Misc/ObjectThumbnail.h"
+#include "Misc/PackageName.h"
+#include "Settings/SuperManagerSettings.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Thumbnail Cache Entries"), STAT_SuperManager_ThumbnailEntries, STATGROUP_SuperManager);
+DECLARE_MEMORY_STAT(TEXT("Thumbnail Cache Memory"), STAT_SuperManager_ThumbnailMemory, STATGROUP_SuperManager);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending Thumbnail Requests"), STAT_SuperManager_ThumbnailPending, STATGROUP_SuperManager);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Thumbnail Cache Hit Rate (%)"), STAT_SuperManager_ThumbnailHitRate, STATGROUP_SuperManager);
+
+namespace SuperManagerThumbnailCache
+{
+	// 足够大，实际淘汰由内存预算决定
+	constexpr int32 MaxEntries = 1 << 20;
+
+	FAutoConsoleCommand DumpStatsCommand(
+		TEXT("SuperManager.ThumbnailStats"),
+		TEXT("打印SuperManager缩略图缓存的命中率与内存占用"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (!FModuleManager::Get().IsModuleLoaded(TEXT("SuperManager")))
+			{
+				return;
+			}
+			const FSuperManagerModule& SuperManagerModule = FModuleManager::GetModuleChecked<FSuperManagerModule>(TEXT("SuperManager"));
+			const FSuperManagerThumbnailCacheStats Stats = SuperManagerModule.GetThumbnailCache()->GetStats();
+			UE_LOG(LogTemp, Display,
+			       TEXT("SuperManager thumbnails: %d entries, %.1f / %.1f MB, %d pending, hit rate %.1f%% (%lld hits, %lld misses)"),
+			       Stats.NumEntries, Stats.MemoryBytes / (1024.0 * 1024.0), Stats.BudgetBytes / (1024.0 * 1024.0),
+			       Stats.PendingRequests, Stats.GetHitRate() * 100.0, Stats.Hits, Stats.Misses);
+		}));
+
+	int64 GetBudgetBytes()
+	{
+		return static_cast<int64>(USuperManagerSettings::Get()->ThumbnailCacheBudgetMB) * 1024 * 1024;
+	}
+
+	// 工作线程：只读包文件头部的缩略图表，解码后缩小到 ThumbnailSize，输出BGRA8像素
+	bool DecodeThumbnail(const FAssetData& AssetData, FImage& OutImage)
+	{
+		FString PackageFilename;
+		if (!FPackageName::DoesPackageExist(AssetData.PackageName.ToString(), &PackageFilename))
+		{
+			return false;
+		}
+
+		const FName ObjectFullName(*AssetData.GetFullName());
+		FThumbnailMap ThumbnailMap;
+		ThumbnailTools::LoadThumbnailsFromPackage(PackageFilename, {ObjectFullName}, ThumbnailMap);
+		FObjectThumbnail* Thumbnail = ThumbnailMap.Find(ObjectFullName);
+		if (!Thumbnail || Thumbnail->IsEmpty())
+		{
+			return false;
+		}
+
+		const int32 Width = Thumbnail->GetImageWidth();
+		const int32 Height = Thumbnail->GetImageHeight();
+		const TArray<uint8>& ImageData = Thumbnail->GetUncompressedImageData();
+		if (Width <= 0 || Height <= 0 || ImageData.Num() != Width * Height * 4)
+		{
+			return false;
+		}
+
+		FImage Source(Width, Height, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+		FMemory::Memcpy(Source.RawData.GetData(), ImageData.GetData(), ImageData.Num());
+		const float Scale = FMath::Min(1.f, static_cast<float>(FSuperManagerThumbnailCache::ThumbnailSize) / FMath::Max(Width, Height));
+		Source.ResizeTo(OutImage, FMath::Max(1, FMath::RoundToInt(Width * Scale)), FMath::Max(1, FMath::RoundToInt(Height * Scale)),
+		                ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+
+		// 有些缩略图渲染时没有写透明通道，统一按不透明显示
+		TArrayView64<FColor> Pixels = OutImage.AsBGRA8();
+		for (FColor& Pixel : Pixels)
+		{
+			Pixel.A = 255;
+		}
+		return true;
+	}
+}
+
+FSuperManagerThumbnailCache::FSuperManagerThumbnailCache(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler)
+	: TaskScheduler(InTaskScheduler)
+	, Entries(SuperManagerThumbnailCache::MaxEntries)
+{
+}
+
+void FSuperManagerThumbnailCache::Initialize()
+{
+	UpdateStats();
+}
+
+void FSuperManagerThumbnailCache::Shutdown()
+{
+	check(IsInGameThread());
+	Entries.Empty(SuperManagerThumbnailCache::MaxEntries);
+	MemoryBytes = 0;
+	UpdateStats();
+}
+
+bool FSuperManagerThumbnailCache::Find(const FAssetData& AssetData, TSharedPtr<FSlateBrush>& OutBrush)
+{
+	check(IsInGameThread());
+	const TSharedPtr<FEntry>* Entry = Entries.FindAndTouch(AssetData.PackageName);
+	if (Entry)
+	{
+		++Hits;
+	}
+	else
+	{
+		++Misses;
+	}
+	UpdateStats();
+	OutBrush = Entry ? (*Entry)->Brush : nullptr;
+	return Entry != nullptr;
+}
+
+void FSuperManagerThumbnailCache::Request(const FAssetData& AssetData, const FSuperManagerCancellationTokenRef& Token, FOnThumbnailReady&& OnReady)
+{
+	check(IsInGameThread());
+	TWeakPtr<FSuperManagerThumbnailCache> WeakThis = AsShared();
+	++PendingRequests;
+
+	// 调度器会直接丢弃已取消的排队任务，这里用独立的令牌保证任务总会开始，由任务自己检查行的令牌
+	const FSuperManagerCancellationTokenRef TaskToken = FSuperManagerTaskScheduler::MakeToken();
+	TaskScheduler->LaunchWorker(TEXT("SuperManager.DecodeThumbnail"),
+		[WeakThis, AssetData, Token, TaskToken, OnReady = MoveTemp(OnReady)](const FSuperManagerCancellationToken&) mutable
+		{
+			const TSharedPtr<FSuperManagerThumbnailCache> This = WeakThis.Pin();
+			if (!This.IsValid())
+			{
+				return;
+			}
+			// 行已经滚出可见区域，快速滚动时绝大多数请求在这里结束
+			if (Token->IsCancelled())
+			{
+				--This->PendingRequests;
+				return;
+			}
+
+			// 画刷接口只接受 TArray<uint8>，FImage 用的是 TArray64，在工作线程上先拷贝好
+			FImage Image;
+			const TSharedRef<TArray<uint8>> Pixels = MakeShared<TArray<uint8>>();
+			FVector2D ImageSize = FVector2D::ZeroVector;
+			if (SuperManagerThumbnailCache::DecodeThumbnail(AssetData, Image))
+			{
+				Pixels->Append(Image.RawData.GetData(), IntCastChecked<int32>(Image.RawData.Num()));
+				ImageSize = FVector2D(Image.SizeX, Image.SizeY);
+			}
+
+			This->TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.ThumbnailReady"),
+				[WeakThis, PackageName = AssetData.PackageName, Pixels, ImageSize, Token, OnReady = MoveTemp(OnReady)]()
+				{
+					const TSharedPtr<FSuperManagerThumbnailCache> This = WeakThis.Pin();
+					if (!This.IsValid())
+					{
+						return true;
+					}
+					--This->PendingRequests;
+
+					// 同一资产的多个请求可能同时在路上，先完成的那个已经放进缓存
+					// 解码期间行被释放也照样放进缓存，滚回来时可以直接命中
+					TSharedPtr<FSlateBrush> Brush;
+					if (const TSharedPtr<FEntry>* Existing = This->Entries.FindAndTouch(PackageName))
+					{
+						Brush = (*Existing)->Brush;
+					}
+					else if (!Pixels->IsEmpty())
+					{
+						const TSharedRef<FEntry> Entry = MakeShared<FEntry>();
+						Entry->Bytes = Pixels->Num();
+						Entry->Brush = FSlateDynamicImageBrush::CreateWithImageData(
+							*FString::Printf(TEXT("SuperManager.Thumbnail.%u"), ++This->NextBrushSerial),
+							ImageSize, *Pixels);
+						This->Add(PackageName, Entry);
+						Brush = Entry->Brush;
+					}
+					else
+					{
+						// 负缓存只占一个条目的开销，同样受内存预算约束
+						const TSharedRef<FEntry> Entry = MakeShared<FEntry>();
+						Entry->Bytes = sizeof(FEntry);
+						This->Add(PackageName, Entry);
+					}
+					This->UpdateStats();
+
+					if (!Token->IsCancelled())
+					{
+						OnReady(Brush);
+					}
+					return true;
+				}, TaskToken, ESuperManagerTaskPriority::High);
+		}, TaskToken, ESuperManagerTaskPriority::High);
+	UpdateStats();
+}
+
+FSuperManagerThumbnailCacheStats FSuperManagerThumbnailCache::GetStats() const
+{
+	FSuperManagerThumbnailCacheStats Stats;
+	Stats.NumEntries = Entries.Num();
+	Stats.MemoryBytes = MemoryBytes;
+	Stats.BudgetBytes = SuperManagerThumbnailCache::GetBudgetBytes();
+	Stats.PendingRequests = PendingRequests;
+	Stats.Hits = Hits;
+	Stats.Misses = Misses;
+	return Stats;
+}
+
+void FSuperManagerThumbnailCache::Add(FName PackageName, const TSharedRef<FEntry>& Entry)
+{
+	Entries.Add(PackageName, Entry);
+	MemoryBytes += Entry->Bytes;
+	Trim();
+	UpdateStats();
+}
+
+void FSuperManagerThumbnailCache::Trim()
+{
+	// 被淘汰的画刷如果还显示在某一行上，由那一行继续持有，行释放时才真正销毁
+	const int64 BudgetBytes = SuperManagerThumbnailCache::GetBudgetBytes();
+	while (MemoryBytes > BudgetBytes && Entries.Num() > 0)
+	{
+		const TSharedPtr<FEntry> Evicted = Entries.RemoveLeastRecent();
+		MemoryBytes -= Evicted.IsValid() ? Evicted->Bytes : 0;
+	}
+}
+
+void FSuperManagerThumbnailCache::UpdateStats() const
+{
+	SET_DWORD_STAT(STAT_SuperManager_ThumbnailEntries, Entries.Num());
+	SET_MEMORY_STAT(STAT_SuperManager_ThumbnailMemory, MemoryBytes);
+	SET_DWORD_STAT(STAT_SuperManager_ThumbnailPending, PendingRequests.load());
+	SET_FLOAT_STAT(STAT_SuperManager_ThumbnailHitRate, GetStats().GetHitRate() * 100.0);
+}
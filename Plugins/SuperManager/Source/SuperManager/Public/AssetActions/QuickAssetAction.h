@@ -29,6 +29,9 @@ public:
 
 	UFUNCTION(CallInEditor)
 	void RemoveUnusedAssets();
+
+	// 类对应的命名前缀，没有规定时返回nullptr；审计检查命名时通过CDO查询
+	const FString* FindPrefixForClass(UClass* Class) const { return PrefixMap.Find(Class); }
 	
 private:
 	TMap<UClass*, FString> PrefixMap = {
@@ -47,6 +50,4 @@ private:
 		{UNiagaraSystem::StaticClass(), TEXT("NS_")},
 		{UNiagaraEmitter::StaticClass(), TEXT("NE_")}
 	};
-
-	void FixUpRedirectors();
 };
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include <atomic>
+
+// 高级删除面板的列举条件
+enum class ESuperManagerListCondition : uint8
+{
+	All,
+	Unused,
+	SameName,
+	SimilarTextures,
+	DuplicateMeshes,
+	DuplicateMaterialInstances,
+	TextureBudget
+};
+
+// 导出文件名和命令行参数使用的名字
+SUPERMANAGER_API const TCHAR* LexToString(ESuperManagerListCondition Condition);
+SUPERMANAGER_API bool LexTryParseString(ESuperManagerListCondition& OutCondition, const TCHAR* Buffer);
+
+// 一次列举的结果，缓存后在多次打开面板之间共享，不可修改
+struct FSuperManagerAssetList
+{
+	TArray<TSharedPtr<FAssetData>> Assets;
+
+	// 对象路径 -> 该资产所属的选中根目录，一个包里可以有多个资产，不能按包名存放
+	TMap<FSoftObjectPath, FString> AssetRoots;
+
+	// 仅Unused条件：根目录内被引用资产的所有引用者，这些包变化时结果才可能失效
+	TSet<FName> ReferencerPackages;
+
+	// 仅相似/重复条件：对象路径 -> 组序号，同组资产在Assets中相邻
+	TMap<FSoftObjectPath, int32> AssetGroups;
+
+	// 对象路径 -> 附加说明，例如冗余副本多占用的顶点数和磁盘大小
+	TMap<FSoftObjectPath, FString> AssetDetails;
+
+	// 整个列表的汇总说明，例如全部处理后预计可节省的显存
+	FString Summary;
+};
+
+/**
+ * 按(根目录, 列举条件)缓存高级删除的结果
+ * 只有资产注册表事件涉及到的目录对应的条目才会失效
+ */
+class SUPERMANAGER_API FSuperManagerAssetListCache : public TSharedFromThis<FSuperManagerAssetListCache>
+{
+public:
+	void Initialize();
+	void Shutdown();
+
+	// Roots 必须已经过 FSuperManagerFolderTrie::NormalizeRoots 处理
+	TSharedPtr<const FSuperManagerAssetList> Find(const TArray<FString>& Roots, ESuperManagerListCondition Condition) const;
+	void Add(const TArray<FString>& Roots, ESuperManagerListCondition Condition, const TSharedRef<const FSuperManagerAssetList>& Result);
+
+	void InvalidateAll();
+	// 只影响某一种条件的变化(例如未使用判定依据的变化)
+	void InvalidateCondition(ESuperManagerListCondition Condition);
+
+	// 每次可能失效时递增，异步计算开始时记下，完成时不一致就不写回缓存
+	uint64 GetGeneration() const { return Generation.load(); }
+
+private:
+	struct FEntry
+	{
+		TArray<FString> Roots;
+		ESuperManagerListCondition Condition = ESuperManagerListCondition::All;
+		TSharedPtr<const FSuperManagerAssetList> Result;
+	};
+
+	static FString MakeKey(const TArray<FString>& Roots, ESuperManagerListCondition Condition);
+
+	// PackageNames 中的包发生了增删改，Dependencies 为其中被修改包当前的依赖
+	void InvalidatePackages(TConstArrayView<FName> PackageNames, TConstArrayView<FName> Dependencies);
+
+	void OnAssetAdded(const FAssetData& AssetData);
+	void OnAssetRemoved(const FAssetData& AssetData);
+	void OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+	void OnAssetUpdated(const FAssetData& AssetData);
+	void OnSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent);
+
+	TMap<FString, FEntry> Entries;
+	std::atomic<uint64> Generation = 0;
+	mutable FCriticalSection EntriesCS;
+
+	FDelegateHandle AssetAddedHandle;
+	FDelegateHandle AssetRemovedHandle;
+	FDelegateHandle AssetRenamedHandle;
+	FDelegateHandle AssetUpdatedHandle;
+	FDelegateHandle SettingsChangedHandle;
+};
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FARFilter;
+
+/**
+ * 内容目录的前缀树，路径的每一段以 FName 驻留
+ * 由资产注册表构建，并通过注册表的路径增删事件保持同步
+ * 排除/包含规则挂在节点上，判断一个路径是否被排除只需要沿路径走一遍(O(深度))
+ */
+class SUPERMANAGER_API FSuperManagerFolderTrie : public TSharedFromThis<FSuperManagerFolderTrie>
+{
+public:
+	FSuperManagerFolderTrie();
+
+	void Initialize();
+	void Shutdown();
+
+	// 根据项目设置重建排除/包含规则
+	void RebuildRules();
+
+	bool ContainsPath(FStringView Path) const;
+	bool IsPathExcluded(FStringView Path) const;
+
+	// 按路径段判断Path是否位于Root子树内(Root自身也算)，不会把 /Game/Foo2 当作 /Game/Foo 的子目录
+	static bool IsPathUnderRoot(FStringView Path, FStringView Root);
+
+	// 去掉重复的根目录以及被其他根目录包含的根目录，保证各子树互不重叠
+	static void NormalizeRoots(const TArray<FString>& InRoots, TArray<FString>& OutRoots);
+
+	// 列出Root以及其下所有存在的子目录，默认跳过被排除的子树
+	void EnumerateSubtree(FStringView Root, TArray<FName>& OutPaths, bool bIncludeExcluded = false) const;
+
+	// 生成只覆盖Root子树中未被排除目录的非递归过滤器，子树为空时返回false
+	bool BuildSubtreeFilter(FStringView Root, FARFilter& OutFilter) const;
+
+private:
+	enum class ERule : uint8
+	{
+		None,
+		Exclude,
+		Include
+	};
+
+	struct FNode
+	{
+		FName Segment;
+		int32 Parent = INDEX_NONE;
+		TMap<FName, int32> Children;
+		ERule Rule = ERule::None;
+		// 规则节点可能只是占位，只有注册表里真实存在的目录才会被列出
+		bool bExists = false;
+	};
+
+	int32 FindNode(FStringView Path) const;
+	int32 FindOrAddNode(FStringView Path);
+	int32 AllocNode(FName Segment, int32 Parent);
+	void MarkSubtreeRemoved(int32 NodeIndex);
+	void PruneNode(int32 NodeIndex);
+	bool IsNodeExcluded(int32 NodeIndex) const;
+	void EnumerateRecursive(int32 NodeIndex, TStringBuilder<256>& PathBuilder, bool bExcluded, bool bIncludeExcluded, TArray<FName>& OutPaths) const;
+
+	void OnPathAdded(const FString& Path);
+	void OnPathRemoved(const FString& Path);
+	void OnSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent);
+
+	// 0号节点是根 "/"
+	TArray<FNode> Nodes;
+	TArray<int32> FreeNodes;
+	int32 NumIncludeRules = 0;
+
+	mutable FRWLock Lock;
+
+	FDelegateHandle PathAddedHandle;
+	FDelegateHandle PathRemovedHandle;
+	FDelegateHandle SettingsChangedHandle;
+};
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
+#include <atomic>
+
+/**
+ * 按包文件时间戳缓存的分析结果(哈希等)，持久化到 Saved/SuperManager 下
+ * 包文件时间戳没变的情况下直接复用上次的结果，线程安全
+ * ValueType 需要支持 FArchive 的 operator<<
+ */
+template <typename ValueType>
+class TSuperManagerPackageTimestampCache
+{
+public:
+	// Version 变化(例如算法调整)时旧文件整体作废
+	TSuperManagerPackageTimestampCache(const TCHAR* InFileName, uint32 InVersion)
+		: FileName(InFileName)
+		, Version(InVersion)
+	{
+	}
+
+	// 包文件不存在时返回 FDateTime::MinValue()，会访问磁盘，最好在工作线程调用
+	static FDateTime GetPackageTimestamp(FName PackageName)
+	{
+		FString PackageFilename;
+		if (!FPackageName::DoesPackageExist(PackageName.ToString(), &PackageFilename))
+		{
+			return FDateTime::MinValue();
+		}
+		return IFileManager::Get().GetTimeStamp(*PackageFilename);
+	}
+
+	bool Find(FName PackageName, const FDateTime& Timestamp, ValueType& OutValue) const
+	{
+		FReadScopeLock ScopeLock(EntriesLock);
+		const FEntry* Entry = Entries.Find(PackageName);
+		if (!Entry || Entry->Timestamp != Timestamp)
+		{
+			return false;
+		}
+		OutValue = Entry->Value;
+		return true;
+	}
+
+	void Add(FName PackageName, const FDateTime& Timestamp, const ValueType& Value)
+	{
+		FWriteScopeLock ScopeLock(EntriesLock);
+		FEntry& Entry = Entries.FindOrAdd(PackageName);
+		Entry.Timestamp = Timestamp;
+		Entry.Value = Value;
+		bDirty = true;
+	}
+
+	void Load()
+	{
+		TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*GetFilePath()));
+		if (!Reader.IsValid())
+		{
+			return;
+		}
+
+		uint32 FileVersion = 0;
+		int32 NumEntries = 0;
+		*Reader << FileVersion;
+		if (FileVersion != Version)
+		{
+			return;
+		}
+		*Reader << NumEntries;
+
+		FWriteScopeLock ScopeLock(EntriesLock);
+		Entries.Reset();
+		Entries.Reserve(NumEntries);
+		for (int32 Index = 0; Index < NumEntries && !Reader->IsError(); ++Index)
+		{
+			// FName 在普通文件归档里不会被序列化，按字符串存取
+			FString PackageName;
+			FEntry Entry;
+			*Reader << PackageName;
+			*Reader << Entry.Timestamp;
+			*Reader << Entry.Value;
+			Entries.Add(FName(*PackageName), MoveTemp(Entry));
+		}
+		if (Reader->IsError())
+		{
+			Entries.Reset();
+		}
+		bDirty = false;
+	}
+
+	// 分片审计的多个工作进程共用同一份缓存文件，带 -SuperManagerReadOnlyCache 启动时只读不写
+	static bool IsReadOnly()
+	{
+		return FParse::Param(FCommandLine::Get(), TEXT("SuperManagerReadOnlyCache"));
+	}
+
+	void Save()
+	{
+		FReadScopeLock ScopeLock(EntriesLock);
+		if (!bDirty || IsReadOnly())
+		{
+			return;
+		}
+
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*GetFilePath()));
+		if (!Writer.IsValid())
+		{
+			return;
+		}
+
+		uint32 FileVersion = Version;
+		int32 NumEntries = Entries.Num();
+		*Writer << FileVersion;
+		*Writer << NumEntries;
+		for (const TPair<FName, FEntry>& Pair : Entries)
+		{
+			FString PackageName = Pair.Key.ToString();
+			FEntry Entry = Pair.Value;
+			*Writer << PackageName;
+			*Writer << Entry.Timestamp;
+			*Writer << Entry.Value;
+		}
+		bDirty = false;
+	}
+
+private:
+	struct FEntry
+	{
+		FDateTime Timestamp;
+		ValueType Value;
+	};
+
+	FString GetFilePath() const
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SuperManager"), FileName);
+	}
+
+	FString FileName;
+	uint32 Version = 0;
+
+	TMap<FName, FEntry> Entries;
+	mutable FRWLock EntriesLock;
+	std::atomic<bool> bDirty = false;
+};
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class FSuperManagerFolderTrie;
+class FSuperManagerTaskScheduler;
+struct FAssetData;
+
+// 某个目录(含子目录)下未被引用的资产统计
+struct FSuperManagerUnusedStats
+{
+	int32 NumUnusedAssets = 0;
+	int64 UnusedBytes = 0;
+};
+
+DECLARE_MULTICAST_DELEGATE(FOnUnusedStatsChanged);
+
+/**
+ * 实时维护每个目录下未被引用资产的数量与磁盘大小
+ * 注册表的增删改事件先收集起来，去抖动后按批增量更新，只重算受影响的包及其新旧依赖
+ */
+class SUPERMANAGER_API FSuperManagerUnusedAssetTracker : public TSharedFromThis<FSuperManagerUnusedAssetTracker>
+{
+public:
+	using FIsPackageUnused = TFunction<bool(FName /*PackageName*/)>;
+
+	FSuperManagerUnusedAssetTracker(const TSharedRef<FSuperManagerFolderTrie>& InFolderTrie,
+	                                const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler,
+	                                FIsPackageUnused InIsPackageUnused);
+
+	void Initialize();
+	void Shutdown();
+
+	// 目录的统计已经向上累加过，查询是一次哈希查找
+	FSuperManagerUnusedStats GetFolderStats(FStringView FolderPath) const;
+
+	bool IsReady() const { return bInitialScanDone; }
+	int32 GetNumUpdatePasses() const { return NumUpdatePasses; }
+
+	FOnUnusedStatsChanged& OnStatsChanged() { return StatsChangedEvent; }
+
+	// 注册表之外的引用(例如文本文件里的路径)发生变化时，由外部通知重算这些包
+	void MarkPackagesDirty(TConstArrayView<FName> PackageNames);
+
+private:
+	struct FPackageState
+	{
+		FName FolderPath;
+		int64 DiskSize = 0;
+		bool bUnused = false;
+		// 上次计算时的依赖，包被删除后靠它找到可能变为未使用的资产
+		TArray<FName> Dependencies;
+	};
+
+	// 统计在工作线程上计算，结果作为游戏线程阶段应用
+	void RebuildAll();
+	void ApplyPendingBatch();
+	void ApplyEvaluatedStates(const TArray<FName>& PackageNames, const TArray<FPackageState>& States, const TArray<bool>& Tracked);
+
+	// 包不存在或不在统计范围内时返回false
+	bool EvaluatePackage(FName PackageName, FPackageState& OutState) const;
+	void SetPackageState(FName PackageName, const FPackageState* NewState);
+	void AddToFolderStats(FName FolderPath, int32 CountDelta, int64 BytesDelta);
+
+	void MarkPackageDirty(FName PackageName);
+	bool Tick(float DeltaTime);
+
+	void OnFilesLoaded();
+	void OnAssetAdded(const FAssetData& AssetData);
+	void OnAssetRemoved(const FAssetData& AssetData);
+	void OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+	void OnAssetUpdated(const FAssetData& AssetData);
+	void OnSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent);
+
+	TSharedRef<FSuperManagerFolderTrie> FolderTrie;
+	TSharedRef<FSuperManagerTaskScheduler> TaskScheduler;
+	FIsPackageUnused IsPackageUnused;
+
+	TMap<FName, FPackageState> Packages;
+	TMap<FName, FSuperManagerUnusedStats> FolderStats;
+
+	TSet<FName> PendingPackages;
+	double FirstPendingTime = 0.0;
+	double LastEventTime = 0.0;
+
+	bool bInitialScanDone = false;
+	bool bAcceptEvents = false;
+	bool bBatchInFlight = false;
+	// 每次完整重建递增，丢弃在重建之前发出的增量结果
+	int32 Generation = 0;
+	int32 NumUpdatePasses = 0;
+
+	FOnUnusedStatsChanged StatsChangedEvent;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+	FDelegateHandle FilesLoadedHandle;
+	FDelegateHandle AssetAddedHandle;
+	FDelegateHandle AssetRemovedHandle;
+	FDelegateHandle AssetRenamedHandle;
+	FDelegateHandle AssetUpdatedHandle;
+	FDelegateHandle SettingsChangedHandle;
+};
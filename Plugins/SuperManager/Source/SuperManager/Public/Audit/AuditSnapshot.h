@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "IO/IoHash.h"
+#include "Similarity/MaterialInstanceDuplicates.h"
+#include "Similarity/MeshDuplicates.h"
+
+// 快照里每个包的状态
+struct FSuperManagerAuditPackageState
+{
+	// 注册表记录的包保存哈希，变了就说明包被重新保存过
+	FIoHash SavedHash;
+	int64 DiskSize = 0;
+	// 上次的依赖，包被修改或删除后用来找出引用计数可能变化的包
+	TArray<FName> Dependencies;
+	bool bUnused = false;
+	bool bStringReferenced = false;
+	// 不符合命名规范时为期望的前缀，否则为空
+	FString MissingPrefix;
+};
+
+// 某次审计时项目的状态，下一次差异审计以它为基线
+struct SUPERMANAGER_API FSuperManagerAuditSnapshot
+{
+	FString Root;
+	FDateTime Timestamp;
+	TMap<FName, FSuperManagerAuditPackageState> Packages;
+	TMap<FName, uint64> TextureHashes;
+	TMap<FName, FSuperManagerMeshFingerprint> MeshFingerprints;
+	TMap<FName, FSuperManagerMaterialInstanceFingerprint> MaterialInstanceFingerprints;
+
+	// 默认存放在 Saved/SuperManager 下，每个根目录一份
+	static FString GetDefaultFilePath(const FString& Root);
+
+	bool Load(const FString& FilePath);
+	bool Save(const FString& FilePath) const;
+};
+
+struct FSuperManagerAuditDuplicate
+{
+	FName PackageName;
+	// 与它相同(或相似)的其他包，已排序
+	TArray<FName> Matches;
+};
+
+// 两次快照之间的变化，只列出新出现的问题
+struct SUPERMANAGER_API FSuperManagerAuditDelta
+{
+	FString Root;
+	FDateTime BaselineTimestamp;
+
+	TArray<FName> AddedPackages;
+	TArray<FName> ModifiedPackages;
+	TArray<FName> RemovedPackages;
+	// 重新判断过是否被使用的包数量，与改动规模成正比
+	int32 NumReevaluated = 0;
+
+	TArray<FName> NewlyUnused;
+	TArray<FName> NoLongerUnused;
+	TArray<FSuperManagerAuditDuplicate> NewlySimilarTextures;
+	TArray<FSuperManagerAuditDuplicate> NewlyDuplicateMeshes;
+	TArray<FSuperManagerAuditDuplicate> NewlyDuplicateMaterialInstances;
+	// (PackageName, 期望的前缀)
+	TArray<TPair<FName, FString>> NewNamingViolations;
+
+	int64 BytesDelta = 0;
+	// 目录 -> 直接位于该目录下的包的大小变化
+	TMap<FString, int64> FolderBytesDelta;
+
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
+/**
+ * 差异审计：以上一次的快照为基线，只重新计算依赖于改动包的部分
+ * 改动由注册表里的包保存哈希判断，不访问磁盘；加载资产、计算指纹、查询引用都只针对改动波及的包
+ * 其余部分只是对快照内存数据的遍历和查表
+ */
+namespace SuperManagerAuditSnapshot
+{
+	// 把 Snapshot 更新为当前状态，同时输出变化；Snapshot 为空时相当于全量审计，所有包都视为新增
+	// 需要加载资产计算指纹，必须在游戏线程调用
+	SUPERMANAGER_API void Update(FSuperManagerAuditSnapshot& Snapshot, FSuperManagerAuditDelta& OutDelta);
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Similarity/MaterialInstanceDuplicates.h"
+#include "Similarity/MeshDuplicates.h"
+#include "Similarity/TextureSimilarity.h"
+
+struct FSuperManagerAuditFolderSize
+{
+	int32 NumPackages = 0;
+	int64 Bytes = 0;
+};
+
+// 一个分片的审计结果，只包含可以直接相加或求并集的数据
+struct SUPERMANAGER_API FSuperManagerAuditPartial
+{
+	// (PackageName, 磁盘大小)
+	TArray<TPair<FName, int64>> UnusedPackages;
+	FSuperManagerTextureSimilarity::FResults TextureHashes;
+	FSuperManagerMeshDuplicates::FResults MeshFingerprints;
+	FSuperManagerMaterialInstanceDuplicates::FResults MaterialInstanceFingerprints;
+	// 目录 -> 直接位于该目录下的包，合并后才向上累加
+	TMap<FString, FSuperManagerAuditFolderSize> FolderSizes;
+
+	TSharedRef<FJsonObject> ToJson() const;
+	bool FromJson(const TSharedPtr<FJsonObject>& JsonObject);
+};
+
+// 合并后的报告，所有数组和键都按名字排序，同样的输入总是得到逐字节相同的JSON
+struct SUPERMANAGER_API FSuperManagerAuditReport
+{
+	FString Root;
+	int32 NumPackages = 0;
+	int64 TotalBytes = 0;
+	TArray<TPair<FName, int64>> UnusedPackages;
+	int64 UnusedBytes = 0;
+	TArray<TArray<FName>> SimilarTextureGroups;
+	TArray<TArray<FName>> DuplicateMeshGroups;
+	TArray<TArray<FName>> DuplicateMaterialInstanceGroups;
+	// 目录 -> 该目录及子目录下的包
+	TMap<FString, FSuperManagerAuditFolderSize> FolderSizes;
+
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
+/**
+ * 项目审计：未使用资产、近似/重复资产、目录大小汇总
+ * 资产按包名的CRC分到若干分片，每个分片可以在单独的编辑器进程里计算，
+ * 分组(相似贴图的连通分量、相同哈希)只在合并后对全部指纹统一进行，因此结果与单进程完全一致
+ */
+namespace SuperManagerProjectAudit
+{
+	// 不依赖 FName 的哈希(各进程不同)，只依赖包名字符串
+	SUPERMANAGER_API bool IsInShard(FName PackageName, int32 ShardIndex, int32 NumShards);
+
+	// 只读，不会修复重定向器或保存任何包；需要加载资产计算指纹，必须在游戏线程调用
+	SUPERMANAGER_API void GatherPartial(const FString& Root, int32 ShardIndex, int32 NumShards, FSuperManagerAuditPartial& OutPartial);
+
+	SUPERMANAGER_API void Merge(const FString& Root, const TArray<FSuperManagerAuditPartial>& Partials, FSuperManagerAuditReport& OutReport);
+
+	SUPERMANAGER_API FString ToJsonString(const TSharedRef<FJsonObject>& JsonObject);
+	SUPERMANAGER_API bool SaveJson(const TSharedRef<FJsonObject>& JsonObject, const FString& FilePath);
+	SUPERMANAGER_API TSharedPtr<FJsonObject> LoadJson(const FString& FilePath);
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SuperManagerAuditCommandlet.generated.h"
+
+struct FSuperManagerAuditReport;
+
+/**
+ * 项目审计命令行
+ * 单进程:   -run=SuperManagerAudit [-Root=/Game] [-Report=路径]
+ * 多进程:   -run=SuperManagerAudit -Workers=N，按包名分成N片，每片由一个本地编辑器进程计算后合并
+ * 工作进程: -run=SuperManagerAudit -Shard=I -NumShards=N -Partial=路径(由协调进程传入)
+ * 性能曲线: -run=SuperManagerAudit -Benchmark=16，依次用1到16个工作进程运行并校验结果与单进程一致
+ * 差异审计: -run=SuperManagerAudit -Diff [-Snapshot=路径]，只报告上次快照之后新出现的问题并更新快照
+ * 导出列表: -run=SuperManagerAudit -Export=路径 [-Condition=Unused] [-Format=Json] [-Restart]，上次中断的导出默认续传
+ * 启动检查: -run=SuperManagerAudit -CheckStartup[=毫秒]，模块启动(含菜单扩展)耗时超出预算(默认取项目设置)时返回失败
+ *           菜单扩展要等内容浏览器加载后才注册，只有带着编辑器模块运行时检查才有意义
+ */
+UCLASS()
+class USuperManagerAuditCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USuperManagerAuditCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	int32 RunStartupCheck(float BudgetMs);
+
+	int32 RunWorker(const FString& Root, int32 ShardIndex, int32 NumShards, const FString& PartialPath);
+
+	// 启动 NumWorkers 个工作进程并合并，任何一个失败都返回false
+	bool RunCoordinator(const FString& Root, int32 NumWorkers, FSuperManagerAuditReport& OutReport);
+
+	int32 RunExport(const FString& Root, const FString& Params);
+
+	int32 RunDiff(const FString& Root, const FString& SnapshotPath, const FString& ReportPath);
+
+	int32 RunBenchmark(const FString& Root, int32 MaxWorkers, const FString& ReportPath);
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+
+enum class ESuperManagerTextureIssues : uint8
+{
+	None = 0,
+	// 最长边超过所在目录的预算
+	OverBudget = 1 << 0,
+	// 非2的幂，不能生成mip也不能流送
+	NonPowerOfTwo = 1 << 1,
+	// 关闭了mip生成
+	NoMips = 1 << 2,
+	// 使用了未压缩(或浮点)的压缩设置
+	Uncompressed = 1 << 3,
+};
+ENUM_CLASS_FLAGS(ESuperManagerTextureIssues);
+
+struct FSuperManagerTextureAuditEntry
+{
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 MaxDimension = 0;
+	FString CompressionSettings;
+	ESuperManagerTextureIssues Issues = ESuperManagerTextureIssues::None;
+	// 按压缩设置估算的显存占用，以及缩到预算内、改用压缩格式后能省下的部分
+	int64 EstimatedBytes = 0;
+	int64 SavableBytes = 0;
+};
+
+/**
+ * 贴图预算检查，只读取注册表标签(尺寸、压缩设置、LOD组、mip设置)，不加载任何贴图
+ * 预算按目录配置，路径越深的规则优先级越高
+ */
+class SUPERMANAGER_API FSuperManagerTextureBudgetAudit
+{
+public:
+	// (PackageName, 检查结果)
+	using FResults = TArray<TPair<FName, FSuperManagerTextureAuditEntry>>;
+
+	// 构造时从设置中取出预算规则，之后可以在任意线程使用
+	FSuperManagerTextureBudgetAudit();
+
+	// 不是 Texture2D 或者缺少尺寸标签时返回false
+	bool Evaluate(const FAssetData& AssetData, FSuperManagerTextureAuditEntry& OutEntry) const;
+
+	// 一次并行遍历，只输出有问题的贴图，按可节省的大小从大到小排序
+	void Run(const TArray<TSharedPtr<FAssetData>>& Assets, FResults& OutResults) const;
+
+	int32 GetMaxDimension(FName PackageName) const;
+
+	// 例如 "4096x4096 > 2048, 无Mip, 未压缩(TC_HDR), 可节省 96 MiB"
+	static FString Describe(const FSuperManagerTextureAuditEntry& Entry);
+
+private:
+	int32 DefaultMaxDimension = 0;
+	// (目录, 最长边上限)，按路径长度从长到短排列
+	TArray<TPair<FString, int32>> FolderBudgets;
+};
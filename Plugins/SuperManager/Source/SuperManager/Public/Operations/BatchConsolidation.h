@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+class FSuperManagerStringReferenceScanner;
+
+// 一组重复资产：Duplicates 的所有引用都改指向 Keeper，然后删除 Duplicates
+struct FSuperManagerConsolidationGroup
+{
+	FAssetData Keeper;
+	TArray<FAssetData> Duplicates;
+};
+
+struct FSuperManagerConsolidationReport
+{
+	int32 NumGroups = 0;
+	int32 NumReferencerPackages = 0;
+	int32 NumPackagesSaved = 0;
+	int32 NumDuplicatesDeleted = 0;
+	// 有引用包加载或保存失败的组，这些组的重复资产不会删除(以保留项的包名表示)
+	TArray<FName> FailedGroups;
+	// 被配置或代码里写死的路径引用的重复资产，引用改不到，保留不删
+	TArray<FName> StringReferencedDuplicates;
+
+	// 每个阶段从开始到结束经过的时间(秒)，游戏线程阶段会跨多帧
+	double GatherSeconds = 0.0;
+	double LoadSeconds = 0.0;
+	double ReplaceSeconds = 0.0;
+	double SaveSeconds = 0.0;
+	double DeleteSeconds = 0.0;
+
+	FString ToString() const;
+};
+
+DECLARE_DELEGATE_OneParam(FOnConsolidationFinished, const FSuperManagerConsolidationReport&);
+
+/**
+ * 批量合并重复资产
+ * 先求出所有重复资产引用者的并集，每个引用包只加载一次，一次遍历替换全部硬引用和软引用
+ * 然后批量保存，最后不弹对话框地删除重复资产；某组有引用包加载或保存失败时，该组的重复资产保留
+ * 被文本文件引用的重复资产在开始前就剔除，既不改写它的引用也不删除
+ */
+namespace SuperManagerBatchConsolidation
+{
+	SUPERMANAGER_API void Run(FSuperManagerTaskScheduler& TaskScheduler, const TArray<FSuperManagerConsolidationGroup>& Groups,
+	                          const TSharedRef<const FSuperManagerStringReferenceScanner>& StringReferenceScanner,
+	                          const FSuperManagerCancellationTokenRef& Token, FOnConsolidationFinished OnFinished);
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+enum class ESuperManagerExportFormat : uint8
+{
+	Csv,
+	Json
+};
+
+struct FSuperManagerListingExportRequest
+{
+	FString FilePath;
+	ESuperManagerExportFormat Format = ESuperManagerExportFormat::Csv;
+	// 导出期间由工作线程持有，只读
+	TArray<TSharedPtr<FAssetData>> Assets;
+	// 对象路径 -> 组序号，相似/重复条件
+	TMap<FSoftObjectPath, int32> AssetGroups;
+	// 同名条件没有组序号，按资产名分组
+	bool bGroupBySameName = false;
+	// 有进度文件且列表与上次相同时从中断处继续，否则从头导出
+	bool bResume = true;
+};
+
+struct FSuperManagerListingExportResult
+{
+	bool bSucceeded = false;
+	// 被取消时进度文件保留，下次导出同一列表可以续传
+	bool bCancelled = false;
+	// 续传时从第几行开始
+	int32 FirstRow = 0;
+	// 文件中已写入的总行数
+	int32 NumRowsWritten = 0;
+	FString FilePath;
+	FString Error;
+
+	FString ToString() const;
+};
+
+DECLARE_DELEGATE_OneParam(FOnListingExportFinished, const FSuperManagerListingExportResult&);
+
+/**
+ * 把资产列表流式导出为 CSV/JSON：路径、类、磁盘大小、引用者数量、组序号
+ * 每次只格式化固定行数，写入并刷新后记录进度(行号和文件长度)，内存占用与总行数无关
+ */
+namespace SuperManagerListingExport
+{
+	constexpr int32 RowsPerChunk = 1024;
+
+	// 工作线程上导出，结束(包括取消)后在游戏线程回调
+	SUPERMANAGER_API void Run(FSuperManagerTaskScheduler& TaskScheduler, FSuperManagerListingExportRequest&& Request,
+	                          const FSuperManagerCancellationTokenRef& Token, FOnListingExportFinished OnFinished);
+
+	// 阻塞版本，供命令行使用；可以在任意线程调用
+	SUPERMANAGER_API FSuperManagerListingExportResult RunBlocking(const FSuperManagerListingExportRequest& Request,
+	                                                              const FSuperManagerCancellationToken* Token = nullptr);
+
+	// 该文件是否有上次没完成的导出
+	SUPERMANAGER_API bool HasResumableProgress(const FString& FilePath);
+}
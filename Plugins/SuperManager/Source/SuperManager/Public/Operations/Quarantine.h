@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+#include "Containers/Ticker.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+class FJsonObject;
+class FSuperManagerStringReferenceScanner;
+
+struct FSuperManagerQuarantineEntry
+{
+	FName OriginalPackage;
+	FName QuarantinedPackage;
+	int64 DiskSize = 0;
+};
+
+// 一次软删除移入隔离区的包，清单保存在 Saved/SuperManager/Quarantine/<Id>.json
+struct FSuperManagerQuarantineBatch
+{
+	FString Id;
+	FDateTime CreatedUtc;
+	TArray<FSuperManagerQuarantineEntry> Entries;
+
+	// 隔离区中这个批次的目录，原包名(带挂载点)挂在它下面
+	FString GetFolder() const;
+	FString GetManifestPath() const;
+
+	TSharedRef<FJsonObject> ToJson() const;
+	bool FromJson(const TSharedPtr<FJsonObject>& JsonObject);
+};
+
+enum class ESuperManagerQuarantineOperation : uint8
+{
+	Quarantine,
+	Restore,
+	Purge
+};
+
+struct FSuperManagerQuarantineReport
+{
+	ESuperManagerQuarantineOperation Operation = ESuperManagerQuarantineOperation::Quarantine;
+	FString BatchId;
+	int32 NumPackages = 0;
+	// 处理成功的包(移入时为原包名)，调用方据此更新列表
+	TArray<FName> Packages;
+	// 其中没有加载、直接移动(删除)文件的包
+	int32 NumFileOperations = 0;
+	int64 Bytes = 0;
+	// 从发起到完成经过的时间，游戏线程阶段会跨多帧
+	double Seconds = 0.0;
+	// 没有处理的包及原因
+	TArray<TPair<FName, FString>> Skipped;
+
+	FString ToString() const;
+};
+
+DECLARE_DELEGATE_OneParam(FOnQuarantineFinished, const FSuperManagerQuarantineReport&);
+
+// 启动以来每种操作的累计量，用来看吞吐
+struct FSuperManagerQuarantineStats
+{
+	int64 NumPackages[3] = {};
+	int64 Bytes[3] = {};
+	double Seconds[3] = {};
+};
+
+/**
+ * 隔离区(软删除)
+ * 删除时把资产整批移到隔离目录，立即返回；可以按批次一次恢复，超过保留期后在后台按帧清理
+ * 没有加载、没有引用者、和同批其他包没有依赖关系的包直接在工作线程上移动文件，不加载资产
+ * 其余的包(已加载、关卡、同批互相引用)按帧逐个加载后交给 AssetTools 一次重命名，不留重定向器
+ * 被批次之外的包(或文本文件)引用的资产不会移入隔离区
+ */
+class SUPERMANAGER_API FSuperManagerQuarantine : public TSharedFromThis<FSuperManagerQuarantine>
+{
+public:
+	FSuperManagerQuarantine(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler,
+	                        const TSharedRef<const FSuperManagerStringReferenceScanner>& InStringReferenceScanner);
+
+	// 读取已有批次的清单，开始定期清理
+	void Initialize();
+	void Shutdown();
+
+	// 隔离目录，取项目设置
+	static FString GetRoot();
+
+	// 只能在游戏线程调用，立即返回；完成后在游戏线程回调
+	void QuarantineAssets(const TArray<FAssetData>& Assets, FOnQuarantineFinished OnFinished = FOnQuarantineFinished());
+	// 整个批次移回原位置，原位置已被占用的包留在隔离区；批次不存在或正在处理时返回false
+	bool RestoreBatch(const FString& BatchId, FOnQuarantineFinished OnFinished = FOnQuarantineFinished());
+	// 以最低优先级清理超过保留期的批次，bIgnoreRetention 为真时清理全部
+	void PurgeExpired(bool bIgnoreRetention = false);
+
+	TArray<FSuperManagerQuarantineBatch> GetBatches() const;
+	// Path 为某个批次目录或其子目录时返回批次Id，否则返回空
+	FString FindBatchIdForPath(const FString& Path) const;
+
+	const FSuperManagerQuarantineStats& GetStats() const { return Stats; }
+
+private:
+	struct FOperation;
+
+	void Run(const TSharedRef<FOperation>& Operation);
+	void Finish(FOperation& Operation);
+
+	FString MakeBatchId() const;
+	bool Tick(float DeltaTime);
+
+	TSharedRef<FSuperManagerTaskScheduler> TaskScheduler;
+	TSharedRef<const FSuperManagerStringReferenceScanner> StringReferenceScanner;
+	FSuperManagerCancellationTokenRef Token = FSuperManagerTaskScheduler::MakeToken();
+
+	// 以下只在游戏线程访问
+	TMap<FString, FSuperManagerQuarantineBatch> Batches;
+	// 正在移入、恢复或清理的批次，同一批次同时只有一个操作
+	TSet<FString> BusyBatches;
+	FSuperManagerQuarantineStats Stats;
+	FTSTicker::FDelegateHandle TickerHandle;
+};
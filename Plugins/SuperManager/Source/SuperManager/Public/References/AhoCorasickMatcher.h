@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 多模式串匹配(Aho-Corasick)，一次扫描文本就能找出所有出现的模式串
+ * 不区分大小写，耗时只与文本长度和命中次数有关，与模式串数量无关
+ */
+class SUPERMANAGER_API FSuperManagerAhoCorasickMatcher
+{
+public:
+	// 返回模式串序号，按添加顺序从0开始，重复(不区分大小写)的模式串返回已有的序号，空串返回 INDEX_NONE
+	int32 AddPattern(FStringView Pattern);
+
+	// 添加完所有模式串后调用一次，之后只读，可以在多个线程同时扫描
+	void Build();
+
+	// OnMatch(模式串序号, 匹配结束位置的下一个下标)
+	void Scan(FStringView Text, TFunctionRef<void(int32 PatternIndex, int32 EndIndex)> OnMatch) const;
+
+	int32 NumPatterns() const { return PatternCount; }
+
+private:
+	struct FNode
+	{
+		int32 FirstEdge = 0;
+		int32 NumEdges = 0;
+		// 当前路径的最长真后缀所在节点
+		int32 Fail = 0;
+		// 以该节点结尾的模式串
+		int32 Pattern = INDEX_NONE;
+		// 沿失败链接能到达的下一个模式串结尾节点，命中时顺着它报告所有更短的模式串
+		int32 NextOutput = INDEX_NONE;
+	};
+
+	int32 FindChild(int32 NodeIndex, TCHAR Char) const;
+
+	TArray<FNode> Nodes;
+	// 按节点拉平、节点内按字符排序的边
+	TArray<TPair<TCHAR, int32>> Edges;
+	// 仅构建期间使用
+	TArray<TArray<TPair<TCHAR, int32>, TInlineAllocator<1>>> BuildChildren;
+	int32 PatternCount = 0;
+	bool bBuilt = false;
+};
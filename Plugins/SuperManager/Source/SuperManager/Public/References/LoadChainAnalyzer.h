@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 硬引用闭包中的一条边，改成软引用后闭包会少掉 RetainedBytes
+struct FSuperManagerLoadChainEdge
+{
+	FName Referencer;
+	FName Dependency;
+	int64 RetainedBytes = 0;
+	int32 RetainedPackages = 0;
+};
+
+struct FSuperManagerLoadChainResult
+{
+	FName RootPackage;
+	int32 NumPackages = 0;
+	int64 TotalBytes = 0;
+	double AnalysisSeconds = 0.0;
+
+	// 按 RetainedBytes 从大到小排列
+	TArray<FSuperManagerLoadChainEdge> Edges;
+
+	// 包 -> 直接支配者(从根出发到它的每条路径都经过的最近的包)
+	TMap<FName, FName> ImmediateDominators;
+
+	// 根到该包的支配者链，包含两端
+	TArray<FName> GetDominatorChain(FName PackageName) const;
+};
+
+/**
+ * 打开某个资产时会被一起加载的硬引用闭包分析
+ * 直接使用注册表里缓存的依赖图，不加载任何资产，可以在工作线程上执行
+ * 在闭包上求支配树：一条边 (U, V) 断开后 V 不再可达，当且仅当 V 的其他引用者都被 V 支配，
+ * 此时闭包会少掉 V 在支配树中的整个子树，据此给每条边排序
+ */
+class SUPERMANAGER_API FSuperManagerLoadChainAnalyzer
+{
+public:
+	// 只保留能单独省下内容的前 MaxEdges 条边
+	static TSharedRef<FSuperManagerLoadChainResult> Analyze(FName RootPackage, int32 MaxEdges = 200);
+};
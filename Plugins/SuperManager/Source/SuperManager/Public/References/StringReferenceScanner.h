@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+class FSuperManagerAhoCorasickMatcher;
+
+// 扫描后引用状态发生变化(新出现或不再出现)的包
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnStringReferencesChanged, const TArray<FName>& /*ChangedPackages*/);
+
+/**
+ * 在 Config/Source/Plugins 等文本文件中查找以路径形式写死的包名(ini、ConstructorHelpers、导出的表格等)
+ * 注册表看不到这些引用，未使用判定需要额外参考这里的结果
+ * 每个文件的命中结果按文件时间戳缓存，重扫时只读取修改过的文件，未修改的文件只补扫新出现的包名
+ */
+class SUPERMANAGER_API FSuperManagerStringReferenceScanner : public TSharedFromThis<FSuperManagerStringReferenceScanner>
+{
+public:
+	explicit FSuperManagerStringReferenceScanner(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler);
+
+	void Initialize();
+	void Shutdown();
+
+	// 线程安全，OutFiles 为出现该包名的文件
+	bool IsReferenced(FName PackageName, TArray<FString>* OutFiles = nullptr) const;
+
+	// 工作线程上重扫，完成后在游戏线程广播变化并回调；取消的请求不会回调
+	void RequestScan(const FSuperManagerCancellationTokenRef& Token, TFunction<void()>&& OnFinished,
+	                 ESuperManagerTaskPriority Priority = ESuperManagerTaskPriority::High);
+	// 游戏线程同步重扫
+	void ScanBlocking();
+
+	FOnStringReferencesChanged& OnReferencesChanged() { return ReferencesChangedEvent; }
+
+private:
+	// 在游戏线程上从设置和插件管理器取好，工作线程不再访问它们
+	struct FScanOptions
+	{
+		TArray<FString> ContentRoots;
+		TArray<FString> Directories;
+		TSet<FString> Extensions;
+	};
+
+	struct FFileEntry
+	{
+		FDateTime Timestamp;
+		TArray<FName> Packages;
+	};
+
+	static FScanOptions MakeScanOptions();
+	static void GatherFiles(const FScanOptions& Options, TArray<TPair<FString, FDateTime>>& OutFiles);
+	static void ScanFile(const FString& FilePath, const FSuperManagerAhoCorasickMatcher& Matcher, const TArray<FName>& PatternNames,
+	                     TArray<FName>& OutPackages);
+
+	// 同一时间只有一次扫描，返回引用状态变化的包
+	TArray<FName> Scan(const FScanOptions& Options);
+
+	void LoadCache();
+	void SaveCache();
+	void ScanAfterFilesLoaded();
+
+	TSharedRef<FSuperManagerTaskScheduler> TaskScheduler;
+
+	// 以下三项只在持有 ScanCS 时访问
+	TMap<FString, FFileEntry> FileEntries;
+	// 缓存的命中结果是针对这些包名扫出来的，不在其中的包名需要补扫
+	TSet<FName> ScannedPackages;
+	bool bCacheDirty = false;
+	mutable FCriticalSection ScanCS;
+
+	// 包名 -> 出现它的文件
+	TMap<FName, TArray<FString>> References;
+	mutable FRWLock ReferencesLock;
+
+	FOnStringReferencesChanged ReferencesChangedEvent;
+	FDelegateHandle FilesLoadedHandle;
+};
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SuperManagerScriptLibrary.generated.h"
+
+UENUM(BlueprintType)
+enum class ESuperManagerScriptDuplicateKind : uint8
+{
+	// 资产名相同
+	SameName,
+	// 感知哈希相近的贴图，阈值取项目设置
+	SimilarTextures,
+	// 几何相同的静态网格
+	Meshes,
+	// 功能相同的材质实例
+	MaterialInstances
+};
+
+USTRUCT(BlueprintType)
+struct FSuperManagerScriptAssetGroup
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "SuperManager")
+	TArray<FString> PackagePaths;
+};
+
+USTRUCT(BlueprintType)
+struct FSuperManagerScriptSkippedAsset
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "SuperManager")
+	FString PackagePath;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SuperManager")
+	FString Reason;
+};
+
+USTRUCT(BlueprintType)
+struct FSuperManagerScriptResult
+{
+	GENERATED_BODY()
+
+	// 查询得到的包，或操作成功后的包(重命名、复制为新的包名)
+	UPROPERTY(BlueprintReadOnly, Category = "SuperManager")
+	TArray<FString> PackagePaths;
+
+	// 查重得到的分组，每组至少两个成员
+	UPROPERTY(BlueprintReadOnly, Category = "SuperManager")
+	TArray<FSuperManagerScriptAssetGroup> Groups;
+
+	// 没有处理的输入(不存在、不适用或失败)及原因
+	UPROPERTY(BlueprintReadOnly, Category = "SuperManager")
+	TArray<FSuperManagerScriptSkippedAsset> Skipped;
+};
+
+// Async 调用返回的句柄，交给 CancelAsync 取消
+USTRUCT(BlueprintType)
+struct FSuperManagerScriptHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "SuperManager")
+	int64 Id = 0;
+};
+
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnSuperManagerScriptFinished, const FSuperManagerScriptResult&, Result);
+
+/**
+ * 供蓝图和 Python(unreal.SuperManagerScriptLibrary)调用的批量接口
+ * 输入为包名数组(/Game/Folder/Asset，对象路径也可以)，每次调用只查询一次注册表，不弹任何对话框
+ * 查询类接口按包处理；删除、添加前缀、复制会处理包里的每一个资产
+ * 同步版本只能在游戏线程调用；Async 版本交给调度器按帧执行，完成后在游戏线程回调，返回的句柄可以用来取消
+ */
+UCLASS()
+class SUPERMANAGER_API USuperManagerScriptLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	// bTransitive 为真时，只被同一批中未使用的包引用的包也算未使用(例如只被无用材质引用的贴图)
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptResult ListUnusedAssets(const TArray<FString>& PackagePaths, bool bTransitive);
+
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptHandle ListUnusedAssetsAsync(const TArray<FString>& PackagePaths, bool bTransitive, const FOnSuperManagerScriptFinished& OnFinished);
+
+	// 指纹类的查重会加载缓存未命中的资产
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptResult FindDuplicateGroups(const TArray<FString>& PackagePaths, ESuperManagerScriptDuplicateKind Kind);
+
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptHandle FindDuplicateGroupsAsync(const TArray<FString>& PackagePaths, ESuperManagerScriptDuplicateKind Kind,
+	                                     const FOnSuperManagerScriptFinished& OnFinished);
+
+	// 按类补上命名前缀，所有重命名合并为一次，引用只修复一遍
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptResult AddPrefixes(const TArray<FString>& PackagePaths);
+
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptHandle AddPrefixesAsync(const TArray<FString>& PackagePaths, const FOnSuperManagerScriptFinished& OnFinished);
+
+	// 每个资产复制 NumOfDuplicates 份并保存，命名规则与右键菜单的复制相同
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptResult DuplicateAssets(const TArray<FString>& PackagePaths, int32 NumOfDuplicates);
+
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptHandle DuplicateAssetsAsync(const TArray<FString>& PackagePaths, int32 NumOfDuplicates, const FOnSuperManagerScriptFinished& OnFinished);
+
+	// 只删除没有被这一批之外引用的包，其余的记入 Skipped
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptResult DeleteAssets(const TArray<FString>& PackagePaths);
+
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptHandle DeleteAssetsAsync(const TArray<FString>& PackagePaths, const FOnSuperManagerScriptFinished& OnFinished);
+
+	// 修复输入中的重定向器并删除它们，不是重定向器的包记入 Skipped
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptResult FixUpRedirectors(const TArray<FString>& PackagePaths);
+
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static FSuperManagerScriptHandle FixUpRedirectorsAsync(const TArray<FString>& PackagePaths, const FOnSuperManagerScriptFinished& OnFinished);
+
+	// 取消还没完成的 Async 调用，之后不会再回调；已经完成或取消过的句柄返回false
+	// 删除、添加前缀、修复重定向器在最后一个阶段里一次应用，在这之前取消不会改动任何资产；复制逐份进行，已完成的不会撤销
+	UFUNCTION(BlueprintCallable, Category = "SuperManager|Scripting")
+	static bool CancelAsync(const FSuperManagerScriptHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SuperManager|Scripting")
+	static bool IsAsyncRunning(const FSuperManagerScriptHandle& Handle);
+};
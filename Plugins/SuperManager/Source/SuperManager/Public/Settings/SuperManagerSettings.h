@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "SuperManagerSettings.generated.h"
+
+// 某个目录(包含子目录)下贴图最长边的上限
+USTRUCT()
+struct FSuperManagerTextureBudget
+{
+	GENERATED_BODY()
+
+	// 例如 /Game/UI
+	UPROPERTY(EditAnywhere, Category = "Texture Budget")
+	FString Folder;
+
+	UPROPERTY(EditAnywhere, Category = "Texture Budget", meta = (ClampMin = "1"))
+	int32 MaxDimension = 2048;
+};
+
+/**
+ * SuperManager 的项目设置，位于 Project Settings -> Plugins -> Super Manager
+ */
+UCLASS(config = Editor, defaultconfig, meta = (DisplayName = "Super Manager"))
+class SUPERMANAGER_API USuperManagerSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	USuperManagerSettings();
+
+	virtual FName GetCategoryName() const override { return FName("Plugins"); }
+
+	static const USuperManagerSettings* Get() { return GetDefault<USuperManagerSettings>(); }
+
+	// 不参与检索的目录(包含子目录)，例如 /Game/Developers
+	UPROPERTY(config, EditAnywhere, Category = "Folders")
+	TArray<FString> ExcludedFolders;
+
+	// 在被排除的目录下重新纳入检索的子目录，路径越深的规则优先级越高
+	UPROPERTY(config, EditAnywhere, Category = "Folders")
+	TArray<FString> IncludedFolders;
+
+	// 每帧留给游戏线程阶段(重命名、复制、删除、保存等)的时间，超出的部分顺延到下一帧
+	UPROPERTY(config, EditAnywhere, Category = "Scheduler", meta = (ClampMin = "0.5", Units = "ms"))
+	float GameThreadBudgetMs = 4.f;
+
+	// 模块启动(StartupModule 加上推迟注册的内容浏览器菜单扩展)允许占用的时间，超出时输出警告，审计命令行的 -CheckStartup 会因此失败；0 表示不检查
+	// 索引、缓存等子系统不计在内，它们在第一次使用或编辑器空闲时才初始化
+	UPROPERTY(config, EditAnywhere, Category = "Scheduler", meta = (ClampMin = "0.0", Units = "ms"))
+	float StartupBudgetMs = 10.f;
+
+	// 注册表事件停止这么久之后才合并成一批更新未使用资产计数
+	UPROPERTY(config, EditAnywhere, Category = "Unused Asset Counter", meta = (ClampMin = "0.0", Units = "s"))
+	float CounterDebounceSeconds = 0.5f;
+
+	// 事件一直不停时，最多积攒这么久也要更新一次
+	UPROPERTY(config, EditAnywhere, Category = "Unused Asset Counter", meta = (ClampMin = "0.0", Units = "s"))
+	float CounterMaxBatchDelaySeconds = 3.f;
+
+	// 两张贴图64位感知哈希的汉明距离不超过该值时视为近似重复，越大越宽松
+	UPROPERTY(config, EditAnywhere, Category = "Similarity", meta = (ClampMin = "0", ClampMax = "32"))
+	int32 SimilarTextureMaxDistance = 6;
+
+	// 在 Config/Source/Plugins 的文本文件中查找写死的资产路径，被找到的资产不算未使用
+	UPROPERTY(config, EditAnywhere, Category = "String References")
+	bool bScanStringReferences = true;
+
+	// 需要扫描的文本文件扩展名
+	UPROPERTY(config, EditAnywhere, Category = "String References", meta = (EditCondition = "bScanStringReferences"))
+	TArray<FString> StringReferenceExtensions;
+
+	// 额外扫描的目录(相对项目目录)，例如导出成 CSV/JSON 的数据表
+	UPROPERTY(config, EditAnywhere, Category = "String References", meta = (EditCondition = "bScanStringReferences"))
+	TArray<FString> AdditionalStringReferenceDirectories;
+
+	// 没有匹配到目录预算的贴图，最长边不应超过该值
+	UPROPERTY(config, EditAnywhere, Category = "Texture Budget", meta = (ClampMin = "1"))
+	int32 DefaultTextureMaxDimension = 2048;
+
+	// 按目录覆盖贴图预算，路径越深的规则优先级越高
+	UPROPERTY(config, EditAnywhere, Category = "Texture Budget")
+	TArray<FSuperManagerTextureBudget> TextureBudgets;
+
+	// 隔离模式：删除时先移入隔离目录(软删除)，可以按批次恢复，超过保留期后在后台清理
+	// 被其他资产引用的资产不会移入隔离区，也不会像普通删除那样提示替换引用
+	UPROPERTY(config, EditAnywhere, Category = "Quarantine")
+	bool bDeleteToQuarantine = false;
+
+	// 隔离目录，不参与检索；每批放在以批次Id命名的子目录下
+	UPROPERTY(config, EditAnywhere, Category = "Quarantine")
+	FString QuarantineRoot = TEXT("/Game/_Quarantine");
+
+	// 移入隔离区超过这么多天的批次会被彻底删除
+	UPROPERTY(config, EditAnywhere, Category = "Quarantine", meta = (ClampMin = "0.0", Units = "Days"))
+	float QuarantineRetentionDays = 7.f;
+
+	// 在资产列表的每一行显示缩略图，只读取包里保存的缩略图，不加载资产
+	UPROPERTY(config, EditAnywhere, Category = "Thumbnails")
+	bool bShowThumbnails = true;
+
+	// 解码后的缩略图最多占用的内存，超出时淘汰最久没有显示过的
+	UPROPERTY(config, EditAnywhere, Category = "Thumbnails", meta = (EditCondition = "bShowThumbnails", ClampMin = "1", Units = "MB"))
+	int32 ThumbnailCacheBudgetMB = 64;
+};
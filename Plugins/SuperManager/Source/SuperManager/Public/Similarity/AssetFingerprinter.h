@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetIndex/PackageTimestampCache.h"
+#include "AssetRegistry/AssetData.h"
+#include "Async/ParallelFor.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+/**
+ * 需要加载资产才能算出的指纹(感知哈希、几何哈希等)的公共流程
+ * 1. 工作线程：筛选候选资产，按包时间戳查缓存
+ * 2. 游戏线程阶段：每次加载一个未命中的资产，拷贝出计算需要的数据(PayloadType)
+ * 3. 工作线程：由拷贝出的数据计算指纹(ValueType)并写入缓存
+ * 子类只需要实现筛选、拷贝和计算三个步骤，必要时可以用注册表标签在加载前进一步缩小范围
+ */
+template <typename PayloadType, typename ValueType>
+class TSuperManagerAssetFingerprinter : public TSharedFromThis<TSuperManagerAssetFingerprinter<PayloadType, ValueType>>
+{
+public:
+	// (PackageName, 指纹)
+	using FResults = TArray<TPair<FName, ValueType>>;
+	using FOnResultsReady = TFunction<void(const TSharedRef<const FResults>&)>;
+
+	TSuperManagerAssetFingerprinter(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler, const TCHAR* CacheFileName, uint32 CacheVersion)
+		: TaskScheduler(InTaskScheduler)
+		, Cache(CacheFileName, CacheVersion)
+	{
+	}
+
+	virtual ~TSuperManagerAssetFingerprinter() = default;
+
+	void Initialize() { Cache.Load(); }
+	void Shutdown() { Cache.Save(); }
+
+	// 完成后在游戏线程回调，取消的请求不会回调
+	void Request(const TArray<TSharedPtr<FAssetData>>& Assets, const FSuperManagerCancellationTokenRef& Token, FOnResultsReady&& OnReady)
+	{
+		const TSharedRef<FRequestState> State = MakeShared<FRequestState>();
+		State->OnReady = MoveTemp(OnReady);
+		TWeakPtr<TSuperManagerAssetFingerprinter> WeakThis = this->AsShared();
+
+		TaskScheduler->LaunchWorker(TEXT("SuperManager.PartitionFingerprints"), [WeakThis, Assets, State, Token](const FSuperManagerCancellationToken&)
+		{
+			const TSharedPtr<TSuperManagerAssetFingerprinter> This = WeakThis.Pin();
+			if (!This.IsValid())
+			{
+				return;
+			}
+			This->PartitionByCache(Assets, State->Results, State->Pending);
+
+			// 每次调用只加载一个资产，拷贝出数据后立刻交给工作线程计算
+			This->TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.LoadFingerprintPayloads"), [WeakThis, State, Token]()
+			{
+				const TSharedPtr<TSuperManagerAssetFingerprinter> This = WeakThis.Pin();
+				if (!This.IsValid())
+				{
+					return true;
+				}
+
+				if (State->NextPendingIndex < State->Pending.Num())
+				{
+					const FPendingAsset& Pending = State->Pending[State->NextPendingIndex++];
+					PayloadType Payload;
+					if (This->LoadPayload(Pending.AssetData, Payload))
+					{
+						++State->Outstanding;
+						This->TaskScheduler->LaunchWorker(TEXT("SuperManager.ComputeFingerprint"),
+							[WeakThis, State, Token, Pending, Payload = MoveTemp(Payload)](const FSuperManagerCancellationToken&)
+							{
+								const TSharedPtr<TSuperManagerAssetFingerprinter> This = WeakThis.Pin();
+								ValueType Value;
+								if (This.IsValid() && This->ComputeValue(Pending.AssetData, Payload, Value))
+								{
+									This->Cache.Add(Pending.AssetData.PackageName, Pending.Timestamp, Value);
+									FScopeLock ScopeLock(&State->ResultsCS);
+									State->Results.Emplace(Pending.AssetData.PackageName, MoveTemp(Value));
+								}
+								if (--State->Outstanding == 0)
+								{
+									FinishRequest(WeakThis, State, Token);
+								}
+							}, Token, ESuperManagerTaskPriority::Background);
+					}
+					if (State->NextPendingIndex < State->Pending.Num())
+					{
+						return false;
+					}
+				}
+
+				if (--State->Outstanding == 0)
+				{
+					FinishRequest(WeakThis, State, Token);
+				}
+				return true;
+			}, Token);
+		}, Token);
+	}
+
+	// 同步版本，只能在游戏线程调用，供命令行和脚本使用
+	void ComputeBlocking(const TArray<TSharedPtr<FAssetData>>& Assets, FResults& OutResults)
+	{
+		check(IsInGameThread());
+
+		TArray<FPendingAsset> Pending;
+		PartitionByCache(Assets, OutResults, Pending);
+
+		// 分批加载，限制同时驻留的数据量
+		constexpr int32 BatchSize = 64;
+		for (int32 BatchStart = 0; BatchStart < Pending.Num(); BatchStart += BatchSize)
+		{
+			const int32 BatchNum = FMath::Min(BatchSize, Pending.Num() - BatchStart);
+			TArray<PayloadType> Payloads;
+			Payloads.SetNum(BatchNum);
+			TArray<bool> Succeeded;
+			Succeeded.SetNumZeroed(BatchNum);
+			for (int32 Index = 0; Index < BatchNum; ++Index)
+			{
+				Succeeded[Index] = LoadPayload(Pending[BatchStart + Index].AssetData, Payloads[Index]);
+			}
+
+			TArray<ValueType> Values;
+			Values.SetNum(BatchNum);
+			ParallelFor(BatchNum, [this, &Pending, BatchStart, &Payloads, &Succeeded, &Values](int32 Index)
+			{
+				Succeeded[Index] = Succeeded[Index] && ComputeValue(Pending[BatchStart + Index].AssetData, Payloads[Index], Values[Index]);
+			});
+
+			for (int32 Index = 0; Index < BatchNum; ++Index)
+			{
+				if (Succeeded[Index])
+				{
+					const FPendingAsset& Asset = Pending[BatchStart + Index];
+					Cache.Add(Asset.AssetData.PackageName, Asset.Timestamp, Values[Index]);
+					OutResults.Emplace(Asset.AssetData.PackageName, MoveTemp(Values[Index]));
+				}
+			}
+		}
+		Cache.Save();
+	}
+
+protected:
+	// 工作线程：是否需要为该资产计算指纹
+	virtual bool IsCandidate(const FAssetData& AssetData) const = 0;
+
+	// 工作线程：查缓存之前整体过滤一次候选，例如按注册表标签排除不可能重复的资产
+	virtual void FilterCandidates(TArray<const FAssetData*>& InOutCandidates) const {}
+
+	// 游戏线程：加载资产并拷贝出计算需要的数据，失败返回false
+	virtual bool LoadPayload(const FAssetData& AssetData, PayloadType& OutPayload) = 0;
+
+	// 工作线程：只能访问 Payload 和线程安全的接口(如资产注册表)
+	virtual bool ComputeValue(const FAssetData& AssetData, const PayloadType& Payload, ValueType& OutValue) const = 0;
+
+	TSharedRef<FSuperManagerTaskScheduler> TaskScheduler;
+
+private:
+	struct FPendingAsset
+	{
+		FAssetData AssetData;
+		FDateTime Timestamp;
+	};
+
+	struct FRequestState
+	{
+		FCriticalSection ResultsCS;
+		FResults Results;
+		TArray<FPendingAsset> Pending;
+		int32 NextPendingIndex = 0;
+		// 还没结束的计算任务数，加上加载阶段本身占的1
+		std::atomic<int32> Outstanding = 1;
+		FOnResultsReady OnReady;
+	};
+
+	// 最后一个计算任务结束后在游戏线程保存缓存并回调
+	static void FinishRequest(const TWeakPtr<TSuperManagerAssetFingerprinter>& WeakThis, const TSharedRef<FRequestState>& State,
+	                          const FSuperManagerCancellationTokenRef& Token)
+	{
+		const TSharedPtr<TSuperManagerAssetFingerprinter> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			return;
+		}
+		This->TaskScheduler->EnqueueGameThreadStage(TEXT("SuperManager.FingerprintsReady"), [WeakThis, State]()
+		{
+			if (const TSharedPtr<TSuperManagerAssetFingerprinter> This = WeakThis.Pin())
+			{
+				This->Cache.Save();
+			}
+			State->OnReady(MakeShared<const FResults>(MoveTemp(State->Results)));
+			return true;
+		}, Token, ESuperManagerTaskPriority::High);
+	}
+
+	void PartitionByCache(const TArray<TSharedPtr<FAssetData>>& Assets, FResults& OutCached, TArray<FPendingAsset>& OutPending) const
+	{
+		TArray<const FAssetData*> Candidates;
+		for (const TSharedPtr<FAssetData>& AssetData : Assets)
+		{
+			if (IsCandidate(*AssetData))
+			{
+				Candidates.Add(AssetData.Get());
+			}
+		}
+		FilterCandidates(Candidates);
+
+		// 查时间戳要访问磁盘，并行处理
+		TArray<FDateTime> Timestamps;
+		Timestamps.SetNum(Candidates.Num());
+		TArray<ValueType> CachedValues;
+		CachedValues.SetNum(Candidates.Num());
+		TArray<bool> CacheHits;
+		CacheHits.SetNumZeroed(Candidates.Num());
+		ParallelFor(Candidates.Num(), [this, &Candidates, &Timestamps, &CachedValues, &CacheHits](int32 Index)
+		{
+			Timestamps[Index] = TSuperManagerPackageTimestampCache<ValueType>::GetPackageTimestamp(Candidates[Index]->PackageName);
+			CacheHits[Index] = Cache.Find(Candidates[Index]->PackageName, Timestamps[Index], CachedValues[Index]);
+		});
+
+		for (int32 Index = 0; Index < Candidates.Num(); ++Index)
+		{
+			if (CacheHits[Index])
+			{
+				OutCached.Emplace(Candidates[Index]->PackageName, MoveTemp(CachedValues[Index]));
+			}
+			else
+			{
+				OutPending.Add({*Candidates[Index], Timestamps[Index]});
+			}
+		}
+	}
+
+	TSuperManagerPackageTimestampCache<ValueType> Cache;
+};
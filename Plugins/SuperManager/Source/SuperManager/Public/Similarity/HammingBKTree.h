@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 以汉明距离为度量的BK树，用于查找距离不超过阈值的64位感知哈希
+ * 相同的哈希共用一个节点，查询只访问满足三角不等式的子树
+ */
+class SUPERMANAGER_API FSuperManagerHammingBKTree
+{
+public:
+	static int32 Distance(uint64 A, uint64 B) { return static_cast<int32>(FMath::CountBits(A ^ B)); }
+
+	// 返回哈希所在的节点序号
+	int32 Insert(uint64 Hash);
+
+	// 构建完成后只读，可以在多个线程同时查询
+	void Query(uint64 Hash, int32 MaxDistance, TArray<int32>& OutNodes) const;
+
+	uint64 GetHash(int32 NodeIndex) const { return Nodes[NodeIndex].Hash; }
+	int32 Num() const { return Nodes.Num(); }
+
+private:
+	struct FNode
+	{
+		uint64 Hash = 0;
+		// (到父节点的距离, 子节点序号)，64位哈希最多65种距离，实际分支很少
+		TArray<TPair<uint8, int32>, TInlineAllocator<4>> Children;
+	};
+
+	TArray<FNode> Nodes;
+};
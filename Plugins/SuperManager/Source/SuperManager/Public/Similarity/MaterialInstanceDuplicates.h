@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Similarity/AssetFingerprinter.h"
+
+// 从材质实例拷贝出来的规范化参数集合，供工作线程计算哈希
+struct FSuperManagerMaterialParameterSet
+{
+	FString ParentPath;
+	// 每个覆盖的参数一条 "类型:参数名=值"，已排序
+	TArray<FString> Overrides;
+	bool bHasOwnPermutations = false;
+};
+
+struct FSuperManagerMaterialInstanceFingerprint
+{
+	uint64 ParameterHash = 0;
+	// 有静态参数(开关、通道遮罩、图层)或基础属性覆盖的实例会编译自己的一套着色器排列
+	bool bHasOwnPermutations = false;
+
+	friend FArchive& operator<<(FArchive& Ar, FSuperManagerMaterialInstanceFingerprint& Fingerprint)
+	{
+		Ar << Fingerprint.ParameterHash;
+		Ar << Fingerprint.bHasOwnPermutations;
+		return Ar;
+	}
+};
+
+/**
+ * 功能相同的材质实例查找
+ * (父材质, 静态参数, 材质图层, 基础属性覆盖, 标量/向量/贴图/字体/RVT参数覆盖) 相同的 UMaterialInstanceConstant 视为重复
+ * 先按注册表的 Parent 标签分组，只有父材质下有多个实例的才需要加载
+ */
+class SUPERMANAGER_API FSuperManagerMaterialInstanceDuplicates
+	: public TSuperManagerAssetFingerprinter<FSuperManagerMaterialParameterSet, FSuperManagerMaterialInstanceFingerprint>
+{
+public:
+	explicit FSuperManagerMaterialInstanceDuplicates(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler);
+
+	// 参数哈希相同的实例分为一组，只输出两个及以上成员的组，组内为 Fingerprints 的下标
+	static void GroupDuplicates(const FResults& Fingerprints, TArray<TArray<int32>>& OutGroups);
+
+	// 线程安全：按整个资产注册表统计每个父材质(Parent 标签)下的实例数
+	static void CountInstancesPerParent(TMap<FString, int32>& OutNumInstancesPerParent);
+
+protected:
+	virtual bool IsCandidate(const FAssetData& AssetData) const override;
+	virtual void FilterCandidates(TArray<const FAssetData*>& InOutCandidates) const override;
+	virtual bool LoadPayload(const FAssetData& AssetData, FSuperManagerMaterialParameterSet& OutParameters) override;
+	virtual bool ComputeValue(const FAssetData& AssetData, const FSuperManagerMaterialParameterSet& Parameters,
+	                          FSuperManagerMaterialInstanceFingerprint& OutFingerprint) const override;
+};
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Similarity/AssetFingerprinter.h"
+
+// 从网格描述拷贝出来的几何数据，供工作线程计算哈希
+struct FSuperManagerMeshGeometry
+{
+	TArray<FVector3f> Positions;
+	// 每三个为一个三角形，下标指向 Positions
+	TArray<int32> TriangleVertices;
+	// 每个三角形所属的材质槽(多边形组)序号
+	TArray<int32> TriangleSections;
+};
+
+// LOD0 每个多边形组对应的渲染分段设置
+struct FSuperManagerMeshSectionSetup
+{
+	int32 MaterialIndex = INDEX_NONE;
+	bool bEnableCollision = true;
+	bool bCastShadow = true;
+};
+
+struct FSuperManagerMeshPayload
+{
+	FSuperManagerMeshGeometry Geometry;
+	// 与 Geometry.TriangleSections 的序号一一对应
+	TArray<FSuperManagerMeshSectionSetup> Sections;
+	// 材质槽(名字和默认材质)、碰撞、LOD设置导出的文本
+	FString SetupText;
+	// LOD1 及以上手动导入(不是自动减面生成)的几何
+	TArray<FSuperManagerMeshGeometry> ImportedLODs;
+};
+
+struct FSuperManagerMeshFingerprint
+{
+	uint64 GeometryHash = 0;
+	// 几何之外影响渲染和碰撞的设置，只有几何和设置都相同的网格才能互相替换
+	uint64 SetupHash = 0;
+	int32 NumVertices = 0;
+	int32 NumTriangles = 0;
+	int64 DiskSize = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FSuperManagerMeshFingerprint& Fingerprint)
+	{
+		Ar << Fingerprint.GeometryHash;
+		Ar << Fingerprint.SetupHash;
+		Ar << Fingerprint.NumVertices;
+		Ar << Fingerprint.NumTriangles;
+		Ar << Fingerprint.DiskSize;
+		return Ar;
+	}
+};
+
+/**
+ * 重复静态网格查找
+ * 顶点位置量化后排序去重，三角形按顶点旋转和排序规整，材质槽按首次出现的顺序重新编号
+ * 因此顶点顺序、三角形顺序、材质槽名字不同但几何相同的网格哈希相同
+ * 比较的是量化之后的精确相等，不是容差匹配：两个网格的对应顶点必须落在同一个量化格里，
+ * 相差远小于一个步长、但正好跨在格子边界两侧的顶点也会让哈希不同(漏报，不会误报)
+ * 重新导入、导出再导入的同一网格通常逐位相同，不受影响；偏移、缩放过的副本不会被找出来
+ * 分组只看几何；材质槽分配、碰撞和LOD设置单独哈希，设置不同的网格合并后渲染或碰撞会变，不能合并
+ */
+class SUPERMANAGER_API FSuperManagerMeshDuplicates : public TSuperManagerAssetFingerprinter<FSuperManagerMeshPayload, FSuperManagerMeshFingerprint>
+{
+public:
+	// 顶点位置的量化步长(厘米)，四舍五入到同一个格点的顶点视为同一位置
+	static constexpr float QuantizationStep = 0.01f;
+
+	explicit FSuperManagerMeshDuplicates(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler);
+
+	// OutSectionOrder 按规整后的编号给出原始的多边形组序号
+	static uint64 ComputeGeometryHash(const FSuperManagerMeshGeometry& Geometry, int32& OutNumUniqueVertices,
+	                                  TArray<int32>* OutSectionOrder = nullptr);
+	static uint64 ComputeSetupHash(const FSuperManagerMeshPayload& Payload, const TArray<int32>& SectionOrder);
+
+	// 几何哈希相同的网格分为一组，只输出两个及以上成员的组，组内为 Fingerprints 的下标
+	// 组内按设置哈希排序，设置相同(可以合并)的成员相邻
+	static void GroupDuplicates(const FResults& Fingerprints, TArray<TArray<int32>>& OutGroups);
+
+protected:
+	virtual bool IsCandidate(const FAssetData& AssetData) const override;
+	virtual bool LoadPayload(const FAssetData& AssetData, FSuperManagerMeshPayload& OutPayload) override;
+	virtual bool ComputeValue(const FAssetData& AssetData, const FSuperManagerMeshPayload& Payload,
+	                          FSuperManagerMeshFingerprint& OutFingerprint) const override;
+};
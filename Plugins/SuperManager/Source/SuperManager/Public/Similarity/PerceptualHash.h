@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FImage;
+
+/**
+ * 64位DCT感知哈希(pHash)
+ * 图像缩到32x32灰度，取DCT左上角8x8低频系数，大于中位数(不含直流分量)的位置为1
+ * 压缩格式、尺寸不同的同一张图得到的哈希汉明距离很小
+ */
+struct SUPERMANAGER_API FSuperManagerPerceptualHash
+{
+	static constexpr int32 SampleSize = 32;
+	static constexpr int32 HashSize = 8;
+
+	// Luminance 为 SampleSize*SampleSize 个行优先的灰度值
+	static uint64 ComputeFromLuminance(const float* Luminance);
+
+	// 工作线程安全，图像为空时返回false
+	static bool ComputeFromImage(const FImage& Image, uint64& OutHash);
+};
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageCore.h"
+#include "Similarity/AssetFingerprinter.h"
+
+/**
+ * 近似重复贴图查找
+ * 贴图的感知哈希按包时间戳缓存，只有新增或修改过的贴图需要加载源数据
+ * 为计算而加载的贴图不保留引用，每加载一批回收一次，大项目里内存不会随贴图数增长
+ * 分组用BK树按汉明距离查询，不做两两比较
+ */
+class SUPERMANAGER_API FSuperManagerTextureSimilarity : public TSuperManagerAssetFingerprinter<FImage, uint64>
+{
+public:
+	explicit FSuperManagerTextureSimilarity(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler);
+
+	// 把 Hashes 按汉明距离不超过 MaxDistance 分组(传递闭包)，只输出两个及以上成员的组，组内为 Hashes 的下标
+	static void GroupNearDuplicates(const FResults& Hashes, int32 MaxDistance, TArray<TArray<int32>>& OutGroups);
+
+protected:
+	virtual bool IsCandidate(const FAssetData& AssetData) const override;
+	// 拷贝仍不小于采样尺寸的最小一级源mip，新加载的贴图定期回收
+	virtual bool LoadPayload(const FAssetData& AssetData, FImage& OutImage) override;
+	virtual bool ComputeValue(const FAssetData& AssetData, const FImage& Image, uint64& OutHash) const override;
+
+private:
+	// 只在游戏线程访问
+	int32 NumTexturesLoadedSinceGarbageCollection = 0;
+};
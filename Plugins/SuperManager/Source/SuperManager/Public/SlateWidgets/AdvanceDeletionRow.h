@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/Views/STableRow.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+// 列表项的显示数据，每个资产第一次显示时生成一次，之后行只绑定不再转换字符串
+struct FSuperManagerAssetRowViewModel
+{
+	TSharedPtr<FAssetData> AssetData;
+	// 同一类的资产共用同一份文本和图标
+	FText ClassText;
+	const FSlateBrush* ClassIcon = nullptr;
+	FText NameText;
+	// 所属根目录，相似/重复条件下还有组序号和详情
+	FText DetailText;
+};
+
+DECLARE_DELEGATE_RetVal_OneParam(bool, FOnIsAssetRowChecked, const TSharedPtr<FAssetData>&);
+DECLARE_DELEGATE_TwoParams(FOnAssetRowCheckStateChanged, ECheckBoxState, TSharedPtr<FAssetData>);
+DECLARE_DELEGATE_RetVal_OneParam(FReply, FOnAssetRowDeleteClicked, TSharedPtr<FAssetData>);
+
+/**
+ * Advance Deletion 列表的行，滚出可见区域后回到面板的行池里，下次显示别的资产时重新绑定
+ * 子控件只在构造时创建一次，勾选状态从面板读取，不保存在行里
+ */
+class SAdvanceDeletionRow : public STableRow<TSharedPtr<FAssetData>>
+{
+public:
+	SLATE_BEGIN_ARGS(SAdvanceDeletionRow)
+		{
+		}
+
+		SLATE_ARGUMENT(FSlateFontInfo, ClassFont)
+		SLATE_ARGUMENT(FSlateFontInfo, NameFont)
+		SLATE_EVENT(FOnIsAssetRowChecked, OnIsChecked)
+		SLATE_EVENT(FOnAssetRowCheckStateChanged, OnCheckStateChanged)
+		SLATE_EVENT(FOnAssetRowDeleteClicked, OnDeleteClicked)
+
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& InOwnerTable);
+	virtual ~SAdvanceDeletionRow() override;
+
+	// 替换显示内容并请求缩略图
+	void Bind(const TSharedRef<const FSuperManagerAssetRowViewModel>& InViewModel);
+	// 放回行池之前调用，取消还没完成的缩略图请求
+	void Unbind();
+
+private:
+	void RequestThumbnail();
+
+	ECheckBoxState GetCheckState() const;
+	void OnCheckBoxStateChanged(ECheckBoxState NewState);
+	FReply OnDeleteButtonClicked();
+
+	TSharedPtr<const FSuperManagerAssetRowViewModel> ViewModel;
+
+	TSharedPtr<SImage> ThumbnailImage;
+	TSharedPtr<STextBlock> ClassTextBlock;
+	TSharedPtr<STextBlock> NameTextBlock;
+	TSharedPtr<STextBlock> DetailTextBlock;
+
+	// SImage 只保存裸指针，由行持有画刷，缓存淘汰后仍然有效
+	TSharedPtr<FSlateBrush> ThumbnailBrush;
+	TSharedPtr<FSuperManagerCancellationToken> ThumbnailToken;
+
+	FOnIsAssetRowChecked OnIsChecked;
+	FOnAssetRowCheckStateChanged OnCheckStateChanged;
+	FOnAssetRowDeleteClicked OnDeleteClicked;
+};
@@ -4,6 +4,11 @@
 
 #include "Widgets/SCompoundWidget.h"
 #include "CoreMinimal.h"
+#include "AssetIndex/AssetListCache.h"
+#include "Operations/ListingExport.h"
+#include "Operations/Quarantine.h"
+#include "SlateWidgets/AdvanceDeletionRow.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
 
 class SAdvanceDeletionTab : public SCompoundWidget
 {
@@ -11,19 +16,41 @@ class SAdvanceDeletionTab : public SCompoundWidget
 		{
 		}
 
-		SLATE_ARGUMENT(TArray<TSharedPtr<FAssetData>>, AssetDataToStore);
-		SLATE_ARGUMENT(FString, CurrentSelectedFolder);
+		SLATE_ARGUMENT(TArray<FString>, SelectedFolders);
 
 	SLATE_END_ARGS()
 
 public:
 	void Construct(const FArguments& InArgs);
+	virtual ~SAdvanceDeletionTab() override;
 
 private:
 	TArray<TSharedPtr<FAssetData>> StoredAssetsData;
 	TArray<TSharedPtr<FAssetData>> DisplayAssetsData;
-	TArray<TSharedPtr<FAssetData>> AssetDataToDeleteArray;
-	TArray<TSharedRef<SCheckBox>> CheckBoxesArray;
+	// 勾选状态保存在面板里，行被回收后重新显示时仍然正确
+	TSet<TSharedPtr<FAssetData>> AssetDataToDeleteSet;
+	// 对象路径 -> 该资产所属的选中根目录
+	TMap<FSoftObjectPath, FString> AssetRoots;
+	// 仅相似/重复条件：对象路径 -> 组序号
+	TMap<FSoftObjectPath, int32> AssetGroups;
+	TMap<FSoftObjectPath, FString> AssetDetails;
+	FString Summary;
+	TArray<FString> SelectedFolders;
+
+	// 列表由调度器异步计算，面板关闭或切换条件时取消上一次请求
+	TSharedPtr<FSuperManagerCancellationToken> PendingRequestToken;
+	bool bIsLoading = false;
+	ESuperManagerListCondition CurrentCondition = ESuperManagerListCondition::All;
+	void RequestAssetList(ESuperManagerListCondition Condition);
+	EVisibility GetLoadingTextVisibility() const { return bIsLoading ? EVisibility::Visible : EVisibility::Collapsed; }
+	FText GetSummaryText() const { return FText::FromString(Summary); }
+	EVisibility GetSummaryTextVisibility() const { return !bIsLoading && !Summary.IsEmpty() ? EVisibility::Visible : EVisibility::Collapsed; }
+
+	// 删除成功后把资产从列表中移除，按PackageName比较，缓存重算后的条目也能对上
+	void RemoveDeletedAssetFromLists(const TSharedPtr<FAssetData>& DeletedAssetData);
+	void RemoveDeletedPackageFromLists(FName DeletedPackageName);
+	// 隔离模式下删除是异步的，只移除真正移入隔离区的包
+	FOnQuarantineFinished MakeQuarantineCallback();
 
 	TSharedRef<SListView<TSharedPtr<FAssetData>>> ConstructAssetListView();
 	TSharedPtr<SListView<TSharedPtr<FAssetData>>> ConstructedAssetListView;
@@ -39,12 +66,28 @@ private:
 #pragma endregion
 
 #pragma region RowWidgetForAssetListView
+	// 从行池取一行绑定到该项的显示数据，行池为空时才创建新行
 	TSharedRef<ITableRow> OnGenerateRowForList(TSharedPtr<FAssetData> AssetDataToDisplay, const TSharedRef<STableViewBase>& OwnerTable);
+	// 行滚出可见区域时由列表释放，解除绑定后放回行池
+	void OnRowReleased(const TSharedRef<ITableRow>& ReleasedRow);
+	TArray<TSharedRef<SAdvanceDeletionRow>> RowPool;
+
+	// 列表项 -> 显示数据，换一次列表清空一次
+	TMap<TSharedPtr<FAssetData>, TSharedRef<const FSuperManagerAssetRowViewModel>> RowViewModels;
+	struct FClassDisplay
+	{
+		FText ClassText;
+		const FSlateBrush* ClassIcon = nullptr;
+	};
+	TMap<FTopLevelAssetPath, FClassDisplay> ClassDisplays;
+	TSharedRef<const FSuperManagerAssetRowViewModel> GetOrCreateRowViewModel(const TSharedPtr<FAssetData>& AssetDataToDisplay);
+
+	FSlateFontInfo AssetClassNameFont;
+	FSlateFontInfo AssetNameFont;
+
 	void OnRowWidgetMouseButtonClicked(TSharedPtr<FAssetData> ClickedData);
-	TSharedRef<SCheckBox> ConstructCheckBox(const TSharedPtr<FAssetData>& AssetDataToDisplay);
+	bool IsAssetChecked(const TSharedPtr<FAssetData>& AssetData) const { return AssetDataToDeleteSet.Contains(AssetData); }
 	void OnCheckBoxStateChanged(const ECheckBoxState NewState, TSharedPtr<FAssetData> AssetData);
-	TSharedRef<STextBlock> ConstructTextForRowWidget(const FString& TextContent, const FSlateFontInfo& FontInfo);
-	TSharedRef<SButton> ConstructButtonForWidget(const TSharedPtr<FAssetData>& AssetDataToDisplay);
 	FReply OnDeleteButtonClicked(TSharedPtr<FAssetData> ClickedAssetData);
 #pragma endregion
 
@@ -52,10 +95,20 @@ private:
 	TSharedRef<SButton> ConstructDeleteAllButton();
 	TSharedRef<SButton> ConstructSelectAllButton();
 	TSharedRef<SButton> ConstructDeselectAllButton();
+	TSharedRef<SButton> ConstructConsolidateButton();
+	TSharedRef<SButton> ConstructExportButton(ESuperManagerExportFormat Format);
 
 	FReply OnDeleteAllButtonClicked();
 	FReply OnSelectAllButtonClicked();
 	FReply OnDeselectAllButtonClicked();
+	// 当前列表按组合并：每组第一个保留，其余的引用改指向它后删除
+	FReply OnConsolidateButtonClicked();
+	// 只有完全相同的重复(网格、材质实例)可以合并，相似贴图只是感知上接近
+	bool CanConsolidate() const;
+	// 当前列表在后台流式导出到 Saved/SuperManager/Exports，导出中再次点击会暂停，之后可以续传
+	FReply OnExportButtonClicked(ESuperManagerExportFormat Format);
+	// 每种格式各自一个，两个导出可以同时进行，点一个按钮只暂停它自己的导出
+	TMap<ESuperManagerExportFormat, TSharedPtr<FSuperManagerCancellationToken>> PendingExportTokens;
 
 	TSharedRef<STextBlock> ConstructTextForTabButtons(const FString& TextContent);
 #pragma endregion
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Widgets/SCompoundWidget.h"
+#include "CoreMinimal.h"
+#include "References/LoadChainAnalyzer.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+// 显示某个资产的硬引用闭包大小，以及改成软引用后收益最大的边
+class SLoadChainTab : public SCompoundWidget
+{
+	SLATE_BEGIN_ARGS(SLoadChainTab)
+		{
+		}
+
+		SLATE_ARGUMENT(FName, RootPackage);
+
+	SLATE_END_ARGS()
+
+public:
+	void Construct(const FArguments& InArgs);
+	virtual ~SLoadChainTab() override;
+
+	// 面板已打开时换一个资产分析
+	void AnalyzePackage(FName RootPackage);
+
+private:
+	TSharedPtr<const FSuperManagerLoadChainResult> Result;
+	TArray<TSharedPtr<FSuperManagerLoadChainEdge>> DisplayEdges;
+
+	TSharedPtr<FSuperManagerCancellationToken> PendingRequestToken;
+	bool bIsLoading = false;
+
+	FText GetSummaryText() const;
+
+	TSharedPtr<SListView<TSharedPtr<FSuperManagerLoadChainEdge>>> ConstructedEdgeListView;
+	TSharedRef<ITableRow> OnGenerateRowForEdge(TSharedPtr<FSuperManagerLoadChainEdge> Edge, const TSharedRef<STableViewBase>& OwnerTable);
+	void OnEdgeClicked(TSharedPtr<FSuperManagerLoadChainEdge> ClickedEdge);
+
+	FSlateFontInfo GetEmboseedTextFont() const { return FCoreStyle::Get().GetFontStyle(FName("EmbossedText")); }
+};
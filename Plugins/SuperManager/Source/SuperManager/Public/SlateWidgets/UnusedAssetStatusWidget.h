@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Widgets/SCompoundWidget.h"
+#include "CoreMinimal.h"
+
+class FSuperManagerUnusedAssetTracker;
+
+// 显示若干目录下未被引用资产数量与大小的小部件，数据来自实时计数，不触发扫描
+class SUnusedAssetStatusWidget : public SCompoundWidget
+{
+	SLATE_BEGIN_ARGS(SUnusedAssetStatusWidget)
+		{
+		}
+
+		SLATE_ARGUMENT(TArray<FString>, Folders);
+
+	SLATE_END_ARGS()
+
+public:
+	void Construct(const FArguments& InArgs);
+	virtual ~SUnusedAssetStatusWidget() override;
+
+	// 把多个目录(先去重叠)的统计合成一行文字，右键菜单也复用这段格式
+	static FText MakeStatusText(const FSuperManagerUnusedAssetTracker& Tracker, const TArray<FString>& Folders);
+
+private:
+	void UpdateStatusText();
+
+	TArray<FString> Folders;
+	TWeakPtr<FSuperManagerUnusedAssetTracker> TrackerWeakPtr;
+	TSharedPtr<STextBlock> StatusTextBlock;
+	FDelegateHandle StatsChangedHandle;
+};
@@ -4,6 +4,58 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "AssetIndex/AssetListCache.h"
+#include "Operations/BatchConsolidation.h"
+#include "Operations/Quarantine.h"
+#include "References/LoadChainAnalyzer.h"
+#include "Similarity/MaterialInstanceDuplicates.h"
+#include "Similarity/MeshDuplicates.h"
+#include "Similarity/TextureSimilarity.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+#include "Thumbnails/ThumbnailCache.h"
+#include <atomic>
+
+class FSuperManagerFolderTrie;
+class FSuperManagerStringReferenceScanner;
+class SLoadChainTab;
+class FSuperManagerUnusedAssetTracker;
+
+// 启动时只创建对象，加载缓存、订阅注册表事件、首次扫描等在第一次使用或编辑器空闲后才进行
+enum class ESuperManagerSubsystem : uint8
+{
+	FolderTrie,
+	AssetListCache,
+	StringReferences,
+	UnusedAssetTracker,
+	TextureSimilarity,
+	MeshDuplicates,
+	MaterialInstanceDuplicates,
+	ThumbnailCache,
+	Quarantine,
+
+	Num
+};
+
+SUPERMANAGER_API const TCHAR* LexToString(ESuperManagerSubsystem Subsystem);
+
+struct FSuperManagerStartupStats
+{
+	static constexpr int32 NumSubsystems = static_cast<int32>(ESuperManagerSubsystem::Num);
+
+	// StartupModule 本身的耗时
+	double StartupModuleMs = 0.0;
+	// 内容浏览器菜单扩展的耗时；内容浏览器晚于本模块加载时推迟到那时注册，不在 StartupModuleMs 里
+	double MenuExtensionMs = 0.0;
+	bool bMenuExtensionInitialized = false;
+	bool bMenuExtensionDeferred = false;
+	// 各子系统 Initialize 的耗时，依赖的子系统单独计
+	double SubsystemMs[NumSubsystems] = {};
+	// 只在游戏线程写入，工作线程只用来断言
+	std::atomic<bool> bSubsystemInitialized[NumSubsystems] = {};
+
+	// 计入启动预算的耗时：StartupModule 加上推迟注册的菜单扩展
+	double GetBudgetedMs() const { return StartupModuleMs + (bMenuExtensionDeferred ? MenuExtensionMs : 0.0); }
+};
 
 class FSuperManagerModule : public IModuleInterface
 {
@@ -12,10 +64,55 @@ public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 
+	// 以下取子系统的接口只能在游戏线程调用，子系统还没初始化时会先同步初始化
+	TSharedPtr<FSuperManagerFolderTrie> GetFolderTrie() const { EnsureSubsystem(ESuperManagerSubsystem::FolderTrie); return FolderTrie; }
+	TSharedPtr<FSuperManagerUnusedAssetTracker> GetUnusedAssetTracker() const { EnsureSubsystem(ESuperManagerSubsystem::UnusedAssetTracker); return UnusedAssetTracker; }
+	TSharedPtr<FSuperManagerTaskScheduler> GetTaskScheduler() const { return TaskScheduler; }
+	TSharedPtr<FSuperManagerStringReferenceScanner> GetStringReferenceScanner() const { EnsureSubsystem(ESuperManagerSubsystem::StringReferences); return StringReferenceScanner; }
+	TSharedPtr<FSuperManagerTextureSimilarity> GetTextureSimilarity() const { EnsureSubsystem(ESuperManagerSubsystem::TextureSimilarity); return TextureSimilarity; }
+	TSharedPtr<FSuperManagerMeshDuplicates> GetMeshDuplicates() const { EnsureSubsystem(ESuperManagerSubsystem::MeshDuplicates); return MeshDuplicates; }
+	TSharedPtr<FSuperManagerMaterialInstanceDuplicates> GetMaterialInstanceDuplicates() const { EnsureSubsystem(ESuperManagerSubsystem::MaterialInstanceDuplicates); return MaterialInstanceDuplicates; }
+	TSharedPtr<FSuperManagerThumbnailCache> GetThumbnailCache() const { EnsureSubsystem(ESuperManagerSubsystem::ThumbnailCache); return ThumbnailCache; }
+	TSharedPtr<FSuperManagerQuarantine> GetQuarantine() const { EnsureSubsystem(ESuperManagerSubsystem::Quarantine); return Quarantine; }
+
+	const FSuperManagerStartupStats& GetStartupStats() const { return StartupStats; }
+
+	// 只能在游戏线程调用，已初始化时直接返回
+	void EnsureSubsystem(ESuperManagerSubsystem Subsystem) const;
+	// 任意线程：工作线程不能初始化子系统，发起方要先在游戏线程 EnsureSubsystem
+	bool IsSubsystemInitialized(ESuperManagerSubsystem Subsystem) const { return StartupStats.bSubsystemInitialized[static_cast<int32>(Subsystem)]; }
+
 private:
+	TSharedPtr<FSuperManagerTaskScheduler> TaskScheduler;
+	TSharedPtr<FSuperManagerFolderTrie> FolderTrie;
+	TSharedPtr<FSuperManagerAssetListCache> AssetListCache;
+	TSharedPtr<FSuperManagerStringReferenceScanner> StringReferenceScanner;
+	TSharedPtr<FSuperManagerUnusedAssetTracker> UnusedAssetTracker;
+	TSharedPtr<FSuperManagerTextureSimilarity> TextureSimilarity;
+	TSharedPtr<FSuperManagerMeshDuplicates> MeshDuplicates;
+	TSharedPtr<FSuperManagerMaterialInstanceDuplicates> MaterialInstanceDuplicates;
+	TSharedPtr<FSuperManagerThumbnailCache> ThumbnailCache;
+	TSharedPtr<FSuperManagerQuarantine> Quarantine;
+
+#pragma region 延迟初始化
+
+	// 注册表加载完之后以最低优先级排队，每帧最多初始化一个子系统
+	void EnqueueDeferredInitialization();
+	// 列表需要的子系统，相似/重复条件还需要对应的指纹
+	void EnsureSubsystemsForCondition(ESuperManagerListCondition Condition) const;
+
+	mutable FSuperManagerStartupStats StartupStats;
+	FDelegateHandle FilesLoadedHandle;
+	FSuperManagerCancellationTokenRef DeferredInitializationToken = FSuperManagerTaskScheduler::MakeToken();
+
+#pragma endregion
+
 #pragma region 内容浏览器拓展
 
+	// 不主动加载内容浏览器，它加载之后再注册右键菜单
 	void InitCBMenuExtention();
+	void OnModulesChanged(FName ModuleName, EModuleChangeReason Reason);
+	FDelegateHandle ModulesChangedHandle;
 
 	TArray<FString> FolderPathsSelected;
 
@@ -23,9 +120,37 @@ private:
 	void AddCBMenuEntry(FMenuBuilder& MenuBuilder);
 	void OnDeleteUnusedAssetButtonClicked();
 	void OnDeleteEmptyFolders();
+	// 选中的目录在某个隔离批次下时，整批恢复
+	void OnRestoreQuarantineBatchClicked();
 	void AdvanceDeletionButtonClicked();
 
+	// 资产右键菜单
+	FName AssetPackageSelected;
+	TSharedRef<FExtender> CustomCBAssetMenuExtender(const TArray<FAssetData>& SelectedAssets);
+	void AddCBAssetMenuEntry(FMenuBuilder& MenuBuilder);
+	void OnAnalyzeLoadChainButtonClicked();
+
 	void FixUpRedirectors();
+
+	// 需要加载资产才能得到的指纹，在进入 BuildAssetList 之前准备好
+	struct FListFingerprints
+	{
+		TSharedPtr<const FSuperManagerTextureSimilarity::FResults> TextureHashes;
+		TSharedPtr<const FSuperManagerMeshDuplicates::FResults> MeshFingerprints;
+		TSharedPtr<const FSuperManagerMaterialInstanceDuplicates::FResults> MaterialInstanceFingerprints;
+	};
+
+	// 工作线程安全：Condition为All时枚举目录，否则从AllList过滤，相似/重复条件还需要对应的指纹
+	TSharedRef<FSuperManagerAssetList> BuildAssetList(const TArray<FString>& Roots, ESuperManagerListCondition Condition,
+	                                                  const TSharedPtr<const FSuperManagerAssetList>& AllList,
+	                                                  const FListFingerprints& Fingerprints = FListFingerprints());
+	// 游戏线程：为相似/重复条件阻塞计算(或从缓存取)指纹，其他条件返回空
+	FListFingerprints ComputeFingerprintsBlocking(ESuperManagerListCondition Condition, const TSharedPtr<const FSuperManagerAssetList>& AllList);
+
+	bool IsAssetUnused(const FAssetData& AssetData, TArray<FName>* OutReferencers = nullptr) const;
+	bool IsPackageUnused(FName PackageName, TArray<FName>* OutReferencers = nullptr) const;
+
+	void OnStringReferencesChanged(const TArray<FName>& ChangedPackages);
 #pragma endregion
 
 #pragma region CustomEditorTab
@@ -34,18 +159,75 @@ private:
 
 	TSharedRef<SDockTab> OnSpawnAdvanceDeletionTab(const FSpawnTabArgs& SpawnTabArgs);
 
-	TArray<TSharedPtr<FAssetData>> GetAllAssetDataUnderSelectedFolder();
+	void RegisterLoadChainTab();
+	TSharedRef<SDockTab> OnSpawnLoadChainTab(const FSpawnTabArgs& SpawnTabArgs);
+	// 面板已打开时再次分析直接交给它
+	TWeakPtr<SLoadChainTab> LoadChainTab;
 
 #pragma endregion
 
 public:
 #pragma region ProcessDataForAssetList
 
-	bool DeleteSingleAssetForAssetList(const FAssetData& AssetDataToDelete);
-	bool DeleteMultipleAssetForAssetList(const TArray<FAssetData>& AssetsToDelete);
+	// 带缓存的列举入口，命中缓存时直接返回，未命中时才修复重定向器并重新计算
+	TSharedRef<const FSuperManagerAssetList> GetAssetListForFolders(const TArray<FString>& Folders, ESuperManagerListCondition Condition);
+	// 不修复重定向器、不读写缓存的阻塞列举，给不能改动包的场合(命令行导出、审计)用
+	TSharedRef<const FSuperManagerAssetList> BuildAssetListForFoldersBlocking(const TArray<FString>& Folders, ESuperManagerListCondition Condition);
+
+	// 异步版本：未命中缓存时修复重定向器(按帧切片)和计算(工作线程)都交给调度器，完成后在游戏线程回调
+	using FOnAssetListReady = TFunction<void(const TSharedRef<const FSuperManagerAssetList>&)>;
+	void RequestAssetListForFolders(const TArray<FString>& Folders, ESuperManagerListCondition Condition,
+	                                FOnAssetListReady&& OnReady, const FSuperManagerCancellationTokenRef& Token);
+
+	// 在工作线程上分析硬引用闭包，完成后在游戏线程回调
+	using FOnLoadChainReady = TFunction<void(const TSharedRef<const FSuperManagerLoadChainResult>&)>;
+	void RequestLoadChainForPackage(FName RootPackage, FOnLoadChainReady&& OnReady, const FSuperManagerCancellationTokenRef& Token);
+
+	// 按帧预算逐个加载重定向器，全部加载后统一修复，完成(或没有需要修复的)时调用OnFinished
+	void EnqueueFixUpRedirectors(const FSuperManagerCancellationTokenRef& Token, TFunction<void()>&& OnFinished);
+
+	// 并行收集多个目录子树下(跳过被排除目录)的资产，重叠的子树只统计一次，同一个包里的多个资产都会保留
+	// OutAssetRoots 记录每个资产(对象路径)来自哪个根目录
+	void GatherAssetsUnderFolders(const TArray<FString>& Folders, TArray<TSharedPtr<FAssetData>>& OutAssetData,
+	                              TMap<FSoftObjectPath, FString>& OutAssetRoots) const;
+
+	// 返回是否已经删除；开启隔离模式时只是排队移入隔离区并返回false，
+	// 完成后提示，并把真正移入的包(被批次之外引用的会留在原处)交给 OnQuarantined
+	bool DeleteSingleAssetForAssetList(const FAssetData& AssetDataToDelete, FOnQuarantineFinished OnQuarantined = FOnQuarantineFinished());
+	bool DeleteMultipleAssetForAssetList(const TArray<FAssetData>& AssetsToDelete, FOnQuarantineFinished OnQuarantined = FOnQuarantineFinished());
+	// 批量合并重复资产，每个引用包只加载、改写、保存一次，删除时不弹对话框
+	void ConsolidateDuplicatesForAssetList(const TArray<FSuperManagerConsolidationGroup>& Groups, FOnConsolidationFinished OnFinished);
 	void ListUnusedAssetsForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetDataToFilter,
-	                                  TArray<TSharedPtr<FAssetData>>& OutUnusedAssetData);
+	                                  TArray<TSharedPtr<FAssetData>>& OutUnusedAssetData,
+	                                  TSet<FName>* OutReferencerPackages = nullptr);
 	void ListSameNameAsssetsForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,TArray<TSharedPtr<FAssetData>>& OutSameNameAssetData);
+	// 按感知哈希把近似重复的贴图排在一起，OutAssetGroups 记录每个资产的组序号
+	void ListSimilarTexturesForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,
+	                                     const FSuperManagerTextureSimilarity::FResults& TextureHashes,
+	                                     TArray<TSharedPtr<FAssetData>>& OutSimilarAssetData,
+	                                     TMap<FSoftObjectPath, int32>& OutAssetGroups);
+	// 几何相同的静态网格排在一起，OutAssetDetails 记录每个冗余副本多占的顶点数和磁盘大小
+	void ListDuplicateMeshesForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,
+	                                     const FSuperManagerMeshDuplicates::FResults& MeshFingerprints,
+	                                     TArray<TSharedPtr<FAssetData>>& OutDuplicateAssetData,
+	                                     TMap<FSoftObjectPath, int32>& OutAssetGroups,
+	                                     TMap<FSoftObjectPath, FString>& OutAssetDetails);
+	// 功能相同的材质实例排在一起，OutAssetDetails 记录合并后能省掉的着色器排列
+	void ListDuplicateMaterialInstancesForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,
+	                                                const FSuperManagerMaterialInstanceDuplicates::FResults& MaterialInstanceFingerprints,
+	                                                TArray<TSharedPtr<FAssetData>>& OutDuplicateAssetData,
+	                                                TMap<FSoftObjectPath, int32>& OutAssetGroups,
+	                                                TMap<FSoftObjectPath, FString>& OutAssetDetails);
+	// 只读注册表标签检查贴图预算，OutSummary 为全部处理后预计可节省的显存
+	void ListTextureBudgetIssuesForAssetList(const TArray<TSharedPtr<FAssetData>>& AssetsToFilter,
+	                                         TArray<TSharedPtr<FAssetData>>& OutFlaggedAssetData,
+	                                         TMap<FSoftObjectPath, FString>& OutAssetDetails,
+	                                         FString& OutSummary);
 	void SyncCBToClickedAssetForAssetList(const FString& AssetPathToSync);
 #pragma endregion
+
+private:
+	// RequestAssetListForFolders 在文本引用扫描完成(或不需要扫描)之后的部分
+	void RequestAssetListForRoots(const TArray<FString>& Folders, ESuperManagerListCondition Condition,
+	                              FOnAssetListReady&& OnReady, const FSuperManagerCancellationTokenRef& Token);
 };
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "Stats/Stats.h"
+
+// 控制台输入 stat SuperManager 查看插件的运行统计
+DECLARE_STATS_GROUP(TEXT("SuperManager"), STATGROUP_SuperManager, STATCAT_Advanced);
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Tasks/Task.h"
+#include <atomic>
+
+enum class ESuperManagerTaskPriority : uint8
+{
+	High,
+	Normal,
+	Background,
+
+	Num
+};
+
+// 由发起方持有，Cancel后排队中的任务不再执行，执行中的任务应自行轮询IsCancelled
+class SUPERMANAGER_API FSuperManagerCancellationToken
+{
+public:
+	void Cancel() { bCancelled.store(true, std::memory_order_relaxed); }
+	bool IsCancelled() const { return bCancelled.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<bool> bCancelled = false;
+};
+
+using FSuperManagerCancellationTokenRef = TSharedRef<FSuperManagerCancellationToken>;
+
+struct FSuperManagerSchedulerStats
+{
+	int32 PendingWorkerTasks = 0;
+	int32 PendingGameThreadStages = 0;
+	int64 CompletedWorkerTasks = 0;
+	int64 CompletedGameThreadStages = 0;
+	// 从入队到开始执行的平均/最大等待时间
+	double AverageWorkerLatencyMs = 0.0;
+	double AverageStageLatencyMs = 0.0;
+	double MaxStageLatencyMs = 0.0;
+	// 上一帧游戏线程阶段实际占用的时间
+	double LastFrameStageTimeMs = 0.0;
+};
+
+/**
+ * SuperManager 所有操作共用的任务调度器
+ * 纯数据工作(依赖查询、哈希、过滤、排序)放到工作线程执行
+ * UObject 的修改(重命名、复制、删除、保存)作为游戏线程阶段排队，每帧只在预算时间内执行
+ */
+class SUPERMANAGER_API FSuperManagerTaskScheduler : public TSharedFromThis<FSuperManagerTaskScheduler>
+{
+public:
+	using FWorkerFunction = TUniqueFunction<void(const FSuperManagerCancellationToken&)>;
+	// 返回true表示阶段已完成；返回false表示还有剩余工作，下次继续执行同一个阶段(用于时间切片)
+	using FStageFunction = TUniqueFunction<bool()>;
+
+	void Initialize();
+	void Shutdown();
+
+	static FSuperManagerCancellationTokenRef MakeToken() { return MakeShared<FSuperManagerCancellationToken>(); }
+
+	UE::Tasks::FTask LaunchWorker(const TCHAR* DebugName, FWorkerFunction&& Work,
+	                              const FSuperManagerCancellationTokenRef& Token,
+	                              ESuperManagerTaskPriority Priority = ESuperManagerTaskPriority::Normal);
+
+	// 可以从任意线程调用，同一优先级的阶段按入队顺序执行
+	void EnqueueGameThreadStage(const TCHAR* DebugName, FStageFunction&& Stage,
+	                            const FSuperManagerCancellationTokenRef& Token,
+	                            ESuperManagerTaskPriority Priority = ESuperManagerTaskPriority::Normal);
+
+	FSuperManagerSchedulerStats GetStats() const;
+
+private:
+	struct FGameThreadStage
+	{
+		const TCHAR* DebugName = nullptr;
+		FStageFunction Stage;
+		TSharedPtr<FSuperManagerCancellationToken> Token;
+		double EnqueueTime = 0.0;
+		bool bStarted = false;
+	};
+
+	struct FStageQueue
+	{
+		TArray<FGameThreadStage> Stages;
+		int32 Head = 0;
+
+		bool IsEmpty() const { return Head >= Stages.Num(); }
+		int32 Num() const { return Stages.Num() - Head; }
+	};
+
+	bool Tick(float DeltaTime);
+	void RecordWorkerLatency(double LatencySeconds);
+	void RecordStageLatency(double LatencySeconds);
+
+	FStageQueue StageQueues[static_cast<int32>(ESuperManagerTaskPriority::Num)];
+	mutable FCriticalSection StageQueuesCS;
+
+	TArray<UE::Tasks::FTask> InFlightWorkers;
+	FCriticalSection InFlightWorkersCS;
+
+	mutable FCriticalSection StatsCS;
+	FSuperManagerSchedulerStats Stats;
+	std::atomic<int32> PendingWorkerTasks = 0;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+	// 工作线程会在排队阶段时读取，入队时在 StageQueuesCS 内再检查一次，Shutdown 清空队列后不会再有新阶段
+	std::atomic<bool> bShuttingDown = false;
+};
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "Tasks/SuperManagerTaskScheduler.h"
+
+struct FSlateBrush;
+
+struct FSuperManagerThumbnailCacheStats
+{
+	int32 NumEntries = 0;
+	int64 MemoryBytes = 0;
+	int64 BudgetBytes = 0;
+	int32 PendingRequests = 0;
+	int64 Hits = 0;
+	int64 Misses = 0;
+
+	double GetHitRate() const { return Hits + Misses > 0 ? static_cast<double>(Hits) / static_cast<double>(Hits + Misses) : 0.0; }
+};
+
+/**
+ * 资产列表行使用的缩略图缓存
+ * 工作线程从包文件里读取保存时生成的缩略图并解码、缩小，不加载资产本身
+ * 解码后的像素按固定内存预算做LRU淘汰，画刷只在游戏线程创建和释放
+ */
+class SUPERMANAGER_API FSuperManagerThumbnailCache : public TSharedFromThis<FSuperManagerThumbnailCache>
+{
+public:
+	// 缓存中的缩略图最长边(像素)，行里显示的尺寸不会超过它
+	static constexpr int32 ThumbnailSize = 64;
+
+	// 没有缩略图(包里没存，或者读取失败)时 Brush 为空
+	using FOnThumbnailReady = TFunction<void(const TSharedPtr<FSlateBrush>& Brush)>;
+
+	explicit FSuperManagerThumbnailCache(const TSharedRef<FSuperManagerTaskScheduler>& InTaskScheduler);
+
+	void Initialize();
+	void Shutdown();
+
+	// 游戏线程：命中时返回true并刷新其LRU位置；已知没有缩略图的资产也算命中，OutBrush 为空
+	bool Find(const FAssetData& AssetData, TSharedPtr<FSlateBrush>& OutBrush);
+
+	// 游戏线程：未命中时在工作线程读取，完成后在游戏线程回调；取消的请求(行已滚出可见区域)不会回调
+	void Request(const FAssetData& AssetData, const FSuperManagerCancellationTokenRef& Token, FOnThumbnailReady&& OnReady);
+
+	FSuperManagerThumbnailCacheStats GetStats() const;
+
+private:
+	// Brush 为空的是负缓存：包里没有缩略图或解码失败，避免每次滚到这一行都重新读包
+	struct FEntry
+	{
+		TSharedPtr<FSlateBrush> Brush;
+		int64 Bytes = 0;
+	};
+
+	void Add(FName PackageName, const TSharedRef<FEntry>& Entry);
+	// 按当前设置的预算淘汰最久未使用的缩略图
+	void Trim();
+	void UpdateStats() const;
+
+	TSharedRef<FSuperManagerTaskScheduler> TaskScheduler;
+
+	// 条目数上限由内存预算决定，这里只用它维护使用顺序
+	TLruCache<FName, TSharedPtr<FEntry>> Entries;
+	int64 MemoryBytes = 0;
+	// 动态画刷按名字注册渲染资源，同一资产被淘汰后重新解码时不能与还在显示的旧画刷重名
+	uint32 NextBrushSerial = 0;
+	int64 Hits = 0;
+	int64 Misses = 0;
+	// 从发出请求到结束(行已取消或结果回到游戏线程)之间的请求数
+	std::atomic<int32> PendingRequests = 0;
+};
@@ -20,13 +20,14 @@ public class SuperManager : ModuleRules
 			new string[]
 			{
 				"Core", "Blutility", "Niagara", "UMG", "UnrealEd", "EditorScriptingUtilities", "AssetTools", "ContentBrowser" ,"AssetRegistry",
-				"InputCore"
+				"InputCore", "ImageCore"
 			});
 
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
 			{
-				"CoreUObject", "Engine", "Slate", "SlateCore"
+				"CoreUObject", "Engine", "Slate", "SlateCore", "DeveloperSettings", "MeshDescription", "StaticMeshDescription",
+				"Projects", "Json", "SourceControl"
 			});
 
 		DynamicallyLoadedModuleNames.AddRange(new string[] { });